@@ -3,7 +3,15 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory_resource>
+#include <vector>
+
+#include "matter/component/group_metadata.hpp"
 #include "matter/component/traits.hpp"
+#include "matter/entity/entity.hpp"
 #include "matter/id/typed_id.hpp"
 #include "matter/id/untyped_id.hpp"
 #include "matter/storage/erased_storage.hpp"
@@ -32,6 +40,10 @@ public:
                            const matter::erased_storage<id_type>,
                            matter::erased_storage<id_type>>;
     using erased_type_ref = erased_type&;
+    using metadata_type =
+        std::conditional_t<is_const,
+                           const matter::group_metadata<id_type>,
+                           matter::group_metadata<id_type>>;
 
 public:
     using size_type = typename matter::erased_storage<id_type>::size_type;
@@ -47,24 +59,32 @@ public:
 private:
     erased_type* ptr_;
     std::size_t  group_size_;
+    // when present, keeps track of the entity owning each row
+    metadata_type* metadata_{nullptr};
 
 public:
     constexpr any_group() noexcept = default;
 
-    constexpr any_group(erased_type* ptr, std::size_t group_size) noexcept
-        : ptr_{ptr}, group_size_{group_size}
+    constexpr any_group(erased_type*   ptr,
+                        std::size_t    group_size,
+                        metadata_type* metadata = nullptr) noexcept
+        : ptr_{ptr}, group_size_{group_size}, metadata_{metadata}
     {
         // when explicitly initialized group_size must be over 0
         assert(group_size > 0);
         assert(is_sorted());
     }
 
-    constexpr any_group(erased_type_ref ref, std::size_t size) noexcept
-        : any_group{std::addressof(ref), size}
+    constexpr any_group(erased_type_ref ref,
+                        std::size_t     size,
+                        metadata_type*  metadata = nullptr) noexcept
+        : any_group{std::addressof(ref), size, metadata}
     {}
 
     constexpr any_group(const any_group<id_type, false>& mutable_grp)
-        : any_group{mutable_grp.ptr_, mutable_grp.group_size()}
+        : any_group{mutable_grp.ptr_,
+                    mutable_grp.group_size(),
+                    mutable_grp.metadata_}
     {}
 
     iterator begin() noexcept
@@ -142,11 +162,208 @@ public:
         return data();
     }
 
+    /// erase the row at idx using swap and pop, when this group tracks
+    /// entities the handle of the moved row gets patched to its new row.
     constexpr void erase(size_type idx) noexcept
     {
+        auto moved_from = idx;
+
         std::for_each(begin(), end(), [&](auto&& erased_storage) {
-            erased_storage.erase(idx);
+            moved_from = erased_storage.erase(idx);
         });
+
+        if (metadata_)
+        {
+            metadata_->erase(idx, moved_from);
+        }
+    }
+
+    /// erase every row in the sorted range of unique rows [first, last). The
+    /// surviving rows at the back fill the holes left behind, this is the
+    /// same as erasing them one by one with swap and pop but every store gets
+    /// compacted with a single call.
+    template<typename ForwardIt>
+    void erase(ForwardIt first, ForwardIt last)
+    {
+        assert(std::is_sorted(first, last));
+        assert(std::adjacent_find(first, last) == last);
+
+        auto count = static_cast<size_type>(std::distance(first, last));
+
+        if (count == 0)
+        {
+            return;
+        }
+
+        assert(count <= size());
+        auto new_size = size() - count;
+
+        // erased rows below new_size are holes, the remaining rows past it
+        // get moved into those holes
+        auto tail = std::lower_bound(first, last, new_size);
+
+        // the buffers of the metadata are reused, only groups without
+        // metadata allocate on every call
+        std::pmr::vector<size_type> local_holes;
+        std::pmr::vector<size_type> local_sources;
+
+        auto& holes = metadata_ ? metadata_->scratch().holes : local_holes;
+        auto& sources =
+            metadata_ ? metadata_->scratch().sources : local_sources;
+
+        holes.assign(first, tail);
+        sources.clear();
+        sources.reserve(holes.size());
+
+        auto erased_it = tail;
+        for (auto row = new_size; sources.size() < holes.size(); ++row)
+        {
+            if (erased_it != last && *erased_it == row)
+            {
+                ++erased_it;
+            }
+            else
+            {
+                sources.push_back(row);
+            }
+        }
+
+        std::for_each(begin(), end(), [&](auto&& erased_storage) {
+            erased_storage.compact(
+                holes.data(), sources.data(), holes.size(), new_size);
+        });
+
+        if (metadata_)
+        {
+            metadata_->erase(first,
+                             last,
+                             holes.data(),
+                             sources.data(),
+                             holes.size(),
+                             new_size);
+        }
+    }
+
+    /// erase every row for which pred(row) returns true, returns the number
+    /// of erased rows.
+    template<typename Predicate>
+    size_type erase_if(Predicate pred)
+    {
+        std::pmr::vector<size_type> local_rows;
+
+        auto& rows = metadata_ ? metadata_->scratch().rows : local_rows;
+        rows.clear();
+
+        for (size_type row = 0; row < size(); ++row)
+        {
+            if (pred(row))
+            {
+                rows.push_back(row);
+            }
+        }
+
+        erase(rows.begin(), rows.end());
+        return rows.size();
+    }
+
+    /// swap the rows lhs and rhs in every store
+    constexpr void swap_rows(size_type lhs, size_type rhs) noexcept
+    {
+        std::for_each(begin(), end(), [&](auto&& erased_storage) {
+            erased_storage.swap(lhs, rhs);
+        });
+
+        if (metadata_)
+        {
+            metadata_->swap_rows(lhs, rhs);
+        }
+    }
+
+    /// move the last `count` rows to the back of dst. Every store present in
+    /// both groups is copied with a single call, stores only present in this
+    /// group get dropped. Stores only present in dst are not touched, these
+    /// must be filled with `count` elements by the caller afterwards, room
+    /// for them is reserved already. Both groups are left unchanged if
+    /// reserving throws.
+    void transfer_back(any_group dst, size_type count)
+    {
+        assert(dst.data() != data());
+        assert(count <= size());
+
+        // everything which may allocate happens before the first row moves
+        std::for_each(dst.begin(), dst.end(), [&](auto&& erased_storage) {
+            erased_storage.reserve_more(count);
+        });
+
+        if (metadata_)
+        {
+            assert(dst.metadata_);
+            dst.metadata_->reserve_more(count);
+        }
+
+        auto first = size() - count;
+
+        // both groups are ordered by id so a single pass finds all matches
+        auto src_it = begin();
+        for (auto& dst_store : dst)
+        {
+            while (src_it != end() && *src_it < dst_store.id())
+            {
+                ++src_it;
+            }
+
+            if (src_it != end() && *src_it == dst_store.id())
+            {
+                dst_store.append(*src_it, first, count);
+            }
+        }
+
+        std::for_each(begin(), end(), [&](auto&& erased_storage) {
+            erased_storage.pop_back(count);
+        });
+
+        if (metadata_)
+        {
+            metadata_->transfer_back(*dst.metadata_, count);
+        }
+    }
+
+    constexpr metadata_type* metadata() const noexcept
+    {
+        return metadata_;
+    }
+
+    /// the entity residing at the passed row, requires the group to be owned
+    /// by a `group_container`
+    matter::entity entity_at(size_type idx) const noexcept
+    {
+        assert(metadata_);
+        return metadata_->entity_at(idx);
+    }
+
+    /// the version the store of id last changed at, see `change_clock`.
+    /// Groups not owned by a `group_container` never change.
+    std::uint64_t version(const id_type& id) const noexcept
+    {
+        auto* store = find_id(id);
+        assert(store);
+
+        return metadata_ ? metadata_->version(
+                               static_cast<size_type>(store - ptr_))
+                         : 0;
+    }
+
+    /// mark the store of id as changed at version, does nothing if the group
+    /// doesn't contain id
+    void mark_changed(const id_type& id, std::uint64_t version) noexcept
+    {
+        auto* store = find_id(id);
+
+        if (store && metadata_)
+        {
+            metadata_->mark_changed(static_cast<size_type>(store - ptr_),
+                                    version);
+        }
     }
 
     /// get the object with the passed id at the passed index
@@ -661,7 +878,8 @@ public:
     {
         using std::swap;
         swap(lhs.ptr_, rhs.ptr_);
-        swap(lhs.size_, rhs.size_);
+        swap(lhs.group_size_, rhs.group_size_);
+        swap(lhs.metadata_, rhs.metadata_);
     }
 
     erased_type* find_id(const id_type& id) noexcept
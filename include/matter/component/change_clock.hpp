@@ -0,0 +1,55 @@
+#ifndef MATTER_COMPONENT_CHANGE_CLOCK_HPP
+#define MATTER_COMPONENT_CHANGE_CLOCK_HPP
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace matter
+{
+/// \brief hands out the versions columns get marked with when they change
+/// Processing a query which may write takes the next version with `advance`
+/// and marks the columns it hands out mutably with it. A query looking for
+/// changes remembers the version it was last processed with and skips columns
+/// which weren't marked with a newer one.
+/// Rows added to a group mark its columns with `pending`, the version the next
+/// query takes, so every query processed before sees them as changed.
+class change_clock {
+private:
+    std::atomic<std::uint64_t> version_{0};
+
+public:
+    change_clock() noexcept = default;
+
+    change_clock(const change_clock& other) noexcept
+        : version_{other.current()}
+    {}
+
+    change_clock& operator=(const change_clock& other) noexcept
+    {
+        version_.store(other.current(), std::memory_order_relaxed);
+        return *this;
+    }
+
+    /// the version taken last
+    std::uint64_t current() const noexcept
+    {
+        return version_.load(std::memory_order_relaxed);
+    }
+
+    /// the version the next call to advance returns
+    std::uint64_t pending() const noexcept
+    {
+        return current() + 1;
+    }
+
+    /// take the next version, queries processed concurrently get distinct ones
+    std::uint64_t advance() noexcept
+    {
+        return version_.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+};
+} // namespace matter
+
+#endif
@@ -0,0 +1,410 @@
+#ifndef MATTER_COMPONENT_COMMAND_BUFFER_HPP
+#define MATTER_COMPONENT_COMMAND_BUFFER_HPP
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <initializer_list>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "matter/component/insert_buffer.hpp"
+#include "matter/component/traits.hpp"
+#include "matter/id/identifier.hpp"
+
+namespace matter
+{
+/// \brief records structural changes to apply to a registry later on
+/// Creating and destroying entities or adding and removing components changes
+/// the groups of a registry, which jobs running concurrently must not do. They
+/// record the changes to a command buffer instead and `apply` performs them
+/// once no job runs anymore.
+/// Commands of the same kind are batched. Entities created with the same
+/// components go into a single `insert_buffer`, components of the same type
+/// are added and removed using the bulk functions of the registry, so every
+/// group is looked up once per batch rather than once per command.
+/// Applying goes by kind: creations first, then added and removed components
+/// and destroyed entities last. Batches of a kind apply in the order they were
+/// first used, commands in the order they were recorded. The buffer keeps its
+/// memory after applying, recording the same kinds of commands every frame
+/// doesn't allocate.
+template<typename Registry>
+class command_buffer {
+public:
+    using registry_type = Registry;
+    using id_type       = typename registry_type::id_type;
+    using entity_type   = typename registry_type::entity_type;
+
+private:
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+    struct batch
+    {
+        virtual void apply(registry_type& reg) = 0;
+        virtual void clear() noexcept          = 0;
+        // destroys and deallocates the batch
+        virtual void release(allocator_type alloc) noexcept = 0;
+
+    protected:
+        ~batch() = default;
+    };
+
+    template<typename... Cs>
+    struct create_batch final : batch
+    {
+        decltype(std::declval<const registry_type&>()
+                     .template create_buffer_for<Cs...>()) buffer;
+
+        explicit create_batch(const registry_type& reg)
+            : buffer{reg.template create_buffer_for<Cs...>()}
+        {}
+
+        void apply(registry_type& reg) override
+        {
+            reg.insert(buffer);
+        }
+
+        void clear() noexcept override
+        {
+            buffer.clear();
+        }
+
+        void release(allocator_type alloc) noexcept override
+        {
+            alloc.delete_object(this);
+        }
+    };
+
+    // every entity gets a copy of the first component then the recorded one
+    // is assigned, this migrates all entities of a group together. Shared
+    // components are added per run of equal values and set where they differ
+    // from the recorded one.
+    template<typename C>
+    struct add_batch final : batch
+    {
+        std::pmr::vector<entity_type> entities;
+        std::pmr::vector<C>           components;
+
+        explicit add_batch(const registry_type& reg)
+            : entities{reg.resource()}, components{reg.resource()}
+        {}
+
+        void apply(registry_type& reg) override
+        {
+            if (entities.empty())
+            {
+                return;
+            }
+
+            if constexpr (matter::is_component_shared_v<C>)
+            {
+                add_shared(reg);
+            }
+            else
+            {
+                reg.template add_component<C>(
+                    entities.begin(), entities.end(), components.front());
+
+                for (std::size_t i = 0; i < entities.size(); ++i)
+                {
+                    if (auto* comp = reg.template try_get<C>(entities[i]))
+                    {
+                        *comp = std::move(components[i]);
+                    }
+                }
+            }
+        }
+
+        void clear() noexcept override
+        {
+            entities.clear();
+            components.clear();
+        }
+
+        void release(allocator_type alloc) noexcept override
+        {
+            alloc.delete_object(this);
+        }
+
+    private:
+        // the value picks the group, so every run of equal values is added on
+        // its own. Entities which already had C or were recorded more than
+        // once then move to the group of their last recorded value.
+        void add_shared(registry_type& reg)
+        {
+            auto equal = [](const C& lhs, const C& rhs) {
+                return std::memcmp(std::addressof(lhs),
+                                   std::addressof(rhs),
+                                   sizeof(C)) == 0;
+            };
+
+            for (std::size_t first = 0; first < entities.size();)
+            {
+                auto last = first + 1;
+                while (last < entities.size() &&
+                       equal(components[first], components[last]))
+                {
+                    ++last;
+                }
+
+                reg.template add_component<C>(entities.begin() + first,
+                                              entities.begin() + last,
+                                              components[first]);
+                first = last;
+            }
+
+            for (std::size_t i = 0; i < entities.size(); ++i)
+            {
+                auto* comp = reg.template try_get<C>(entities[i]);
+                if (comp && !equal(*comp, components[i]))
+                {
+                    reg.set_shared(entities[i], components[i]);
+                }
+            }
+        }
+    };
+
+    template<typename C>
+    struct remove_batch final : batch
+    {
+        std::pmr::vector<entity_type> entities;
+
+        explicit remove_batch(const registry_type& reg)
+            : entities{reg.resource()}
+        {}
+
+        void apply(registry_type& reg) override
+        {
+            reg.template remove_component<C>(entities.begin(), entities.end());
+        }
+
+        void clear() noexcept override
+        {
+            entities.clear();
+        }
+
+        void release(allocator_type alloc) noexcept override
+        {
+            alloc.delete_object(this);
+        }
+    };
+
+    // hands out a dense index for every kind of batch
+    using batch_identifier = matter::identifier<std::size_t, command_buffer>;
+
+    registry_type* registry_;
+
+    // the batch of each index, nullptr if it wasn't used yet
+    std::pmr::vector<batch*> batches_;
+
+    // the batches of each kind in the order they were first used
+    std::pmr::vector<batch*> creates_;
+    std::pmr::vector<batch*> adds_;
+    std::pmr::vector<batch*> removes_;
+
+    std::pmr::vector<entity_type> destroyed_;
+
+public:
+    /// the buffer allocates from the resource of reg
+    explicit command_buffer(registry_type& reg)
+        : registry_{std::addressof(reg)}, batches_{reg.resource()},
+          creates_{reg.resource()}, adds_{reg.resource()},
+          removes_{reg.resource()}, destroyed_{reg.resource()}
+    {}
+
+    command_buffer(command_buffer&&) = default;
+    command_buffer& operator=(command_buffer&&) = delete;
+
+    ~command_buffer()
+    {
+        for (auto* b : batches_)
+        {
+            if (b)
+            {
+                b->release(allocator_type{registry_->resource()});
+            }
+        }
+    }
+
+    /// record the creation of an entity composed of Cs..., takes the same
+    /// arguments as `registry::create`
+    template<typename... Cs, typename... TupArgs>
+    void create(TupArgs&&... args)
+    {
+        batch_for<create_batch<Cs...>>(creates_).buffer.emplace_back(
+            std::forward<TupArgs>(args)...);
+    }
+
+    /// record the destruction of an entity
+    void destroy(const entity_type& ent)
+    {
+        destroyed_.push_back(ent);
+    }
+
+    /// record adding C constructed from args to an entity. If the entity has
+    /// C by the time it is applied the component gets assigned instead.
+    template<typename C, typename... Args>
+    void add_component(const entity_type& ent, Args&&... args)
+    {
+        auto& b = batch_for<add_batch<C>>(adds_);
+        b.entities.push_back(ent);
+        b.components.emplace_back(std::forward<Args>(args)...);
+    }
+
+    /// record removing C from an entity
+    template<typename C>
+    void remove_component(const entity_type& ent)
+    {
+        batch_for<remove_batch<C>>(removes_).entities.push_back(ent);
+    }
+
+    /// perform every recorded command and clear the buffer. Must not run
+    /// concurrently with anything accessing the registry.
+    void apply()
+    {
+        for (auto* kind : {&creates_, &adds_, &removes_})
+        {
+            for (auto* b : *kind)
+            {
+                b->apply(*registry_);
+                b->clear();
+            }
+        }
+
+        registry_->destroy(destroyed_.begin(), destroyed_.end());
+        destroyed_.clear();
+    }
+
+private:
+    template<typename Batch>
+    Batch& batch_for(std::pmr::vector<batch*>& kind)
+    {
+        auto index = batch_identifier::template get<Batch>();
+
+        if (index >= batches_.size())
+        {
+            batches_.resize(index + 1, nullptr);
+        }
+
+        auto*& b = batches_[index];
+        if (!b)
+        {
+            auto alloc = allocator_type{registry_->resource()};
+            b          = alloc.template new_object<Batch>(*registry_);
+            kind.push_back(b);
+        }
+
+        return static_cast<Batch&>(*b);
+    }
+};
+
+/// \brief a `command_buffer` for every thread recording commands
+/// Jobs running on different threads record to the buffer returned by
+/// `local()`, only the first call on each thread takes a lock. `apply`
+/// applies the buffers one after another in the order their threads first
+/// used them. The commands of one thread are applied in a deterministic
+/// order, which thread runs which job is up to the scheduler though, jobs
+/// relying on an order between each other should record to buffers of their
+/// own.
+template<typename Registry>
+class command_buffers {
+public:
+    using registry_type       = Registry;
+    using command_buffer_type = matter::command_buffer<registry_type>;
+
+private:
+    struct slot
+    {
+        std::thread::id     thread;
+        command_buffer_type buffer;
+    };
+
+    // the last buffer used by a thread, instances are told apart by a number
+    // unique to each of them as addresses may be reused
+    struct cache
+    {
+        std::uint64_t        owner{0};
+        command_buffer_type* buffer{nullptr};
+    };
+
+    static std::uint64_t next_instance() noexcept
+    {
+        static std::atomic<std::uint64_t> next{1};
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    registry_type* registry_;
+    std::uint64_t  instance_{next_instance()};
+
+    std::mutex mutex_;
+    // a deque keeps the buffers in place while others get added
+    std::pmr::deque<slot> slots_;
+
+public:
+    explicit command_buffers(registry_type& reg)
+        : registry_{std::addressof(reg)}, slots_{reg.resource()}
+    {}
+
+    command_buffers(const command_buffers&) = delete;
+    command_buffers& operator=(const command_buffers&) = delete;
+
+    /// the buffer of the calling thread
+    command_buffer_type& local()
+    {
+        thread_local cache last{};
+
+        if (last.owner != instance_)
+        {
+            last.owner  = instance_;
+            last.buffer = std::addressof(
+                find_or_add(std::this_thread::get_id()));
+        }
+
+        return *last.buffer;
+    }
+
+    /// the number of threads which recorded commands
+    std::size_t size() const noexcept
+    {
+        return slots_.size();
+    }
+
+    /// apply the buffer of every thread, see `command_buffer::apply`. Must not
+    /// run concurrently with anything accessing the registry or this.
+    void apply()
+    {
+        for (auto& s : slots_)
+        {
+            s.buffer.apply();
+        }
+    }
+
+private:
+    command_buffer_type& find_or_add(std::thread::id thread)
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+
+        for (auto& s : slots_)
+        {
+            if (s.thread == thread)
+            {
+                return s.buffer;
+            }
+        }
+
+        return slots_
+            .emplace_back(slot{thread, command_buffer_type{*registry_}})
+            .buffer;
+    }
+};
+} // namespace matter
+
+#endif
@@ -3,20 +3,27 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <functional>
 #include <iterator>
+#include <tuple>
+#include <type_traits>
 
 #include "matter/component/any_group.hpp"
 #include "matter/component/component_view.hpp"
+#include "matter/component/group_metadata.hpp"
 #include "matter/component/group_slice.hpp"
 #include "matter/component/insert_buffer.hpp"
 #include "matter/component/traits.hpp"
 #include "matter/id/typed_id.hpp"
+#include "matter/storage/aligned_vector.hpp"
+#include "matter/storage/chunks.hpp"
 #include "matter/storage/erased_storage.hpp"
 #include "matter/util/container.hpp"
 #include "matter/util/id_erased.hpp"
+#include "matter/util/meta.hpp"
 
 namespace matter
 {
@@ -25,45 +32,74 @@ class group : public matter::group_slice<Id, Cs...> {
     using base_ = matter::group_slice<Id, Cs...>;
 
 public:
-    using id_type = Id;
+    using id_type       = Id;
+    using metadata_type = matter::group_metadata<id_type>;
 
     using iterator = typename base_::iterator;
 
+    /// columns are always reserved to a multiple of this, which keeps the
+    /// padding of every aligned column in line with the others
+    static constexpr std::size_t lanes =
+        matter::common_storage_lanes_v<matter::component_storage_t<Cs>...>;
+
     template<typename _Id, typename... Ts>
     friend class group;
 
+private:
+    // null when the group is not owned by a group_container, in which case no
+    // entities are tracked
+    metadata_type* metadata_{nullptr};
+
 protected:
     explicit constexpr group(
+        metadata_type* metadata,
         matter::component_storage_t<Cs>&... stores) noexcept
-        : base_{stores...}
+        : base_{stores...}, metadata_{metadata}
     {}
 
 public:
     explicit constexpr group(
         matter::any_group<id_type>                         grp,
         const matter::unordered_typed_ids<id_type, Cs...>& ids) noexcept
-        : base_{grp, ids}
+        : base_{grp, ids}, metadata_{grp.metadata()}
     {}
 
     template<typename... Us>
     constexpr group(const matter::group<id_type, Us...>& other) noexcept
-        : base_{other}
+        : base_{other}, metadata_{other.metadata_}
     {}
 
     template<typename... Us>
     constexpr group&
     operator=(const matter::group<id_type, Us...>& other) noexcept
     {
-        *static_cast<base_>(this) = other;
+        static_cast<base_&>(*this) = other;
+        metadata_                  = other.metadata_;
         return *this;
     }
 
+    constexpr metadata_type* metadata() const noexcept
+    {
+        return metadata_;
+    }
+
+    /// the entity residing at the passed row, requires the group to be owned
+    /// by a `group_container`
+    matter::entity entity_at(std::size_t idx) const noexcept
+    {
+        assert(metadata_);
+        return metadata_->entity_at(idx);
+    }
+
     template<typename... Args>
-    constexpr matter::component_view<Cs...>
-    emplace_back(Args&&... args) noexcept
+    constexpr typename base_::view_type emplace_back(Args&&... args)
     {
         static_assert(sizeof...(Args) == sizeof...(Cs),
                       "Must pass one argument for each component");
+
+        // a failed allocation leaves the columns at the same size
+        reserve_back(1);
+
         std::apply(
             [&](auto&&... stores) {
                 (matter::detail::emplace_back_ambiguous(
@@ -72,35 +108,95 @@ public:
             },
             this->stores_);
 
+        if (metadata_)
+        {
+            metadata_->push_back();
+        }
+
         return this->back();
     }
 
-    void reserve(std::size_t new_capacity) noexcept
+    void reserve(std::size_t new_capacity)
     {
+        new_capacity = matter::detail::round_up(new_capacity, lanes);
+
         std::apply(
             [&](auto&&... stores) {
                 (stores.get().reserve(new_capacity), ...);
             },
             this->stores_);
+
+        if (metadata_)
+        {
+            metadata_->reserve(new_capacity);
+        }
     }
 
     template<typename... Ts>
     constexpr std::enable_if_t<(detail::type_in_list_v<Ts, Cs...> && ...),
                                iterator>
-    insert_back(const matter::insert_buffer<id_type, Ts...>& buffer) noexcept(
-        (std::is_nothrow_constructible_v<
-             Cs,
-             decltype(*std::make_move_iterator(buffer.template begin<Cs>()))> &&
-         ...))
+    insert_back(const matter::insert_buffer<id_type, Ts...>& buffer)
     {
         auto pos = this->size();
 
-        (this->template get<Cs>().insert(
-             this->template get<Cs>().end(),
-             std::make_move_iterator(buffer.template begin<Cs>()),
-             std::make_move_iterator(buffer.template end<Cs>())),
+        // grow all columns at once to the same padded capacity, the group is
+        // left unchanged if this throws and nothing allocates afterwards
+        reserve_back(buffer.size());
+
+        // trivially copyable columns are copied with memcpy
+        (matter::append_copy(this->template get<Cs>(),
+                             buffer.template data<Cs>(),
+                             buffer.size()),
          ...);
 
+        if (metadata_)
+        {
+            metadata_->push_back(buffer.size());
+        }
+
+        return iterator{pos, this->template get<Cs>()...};
+    }
+
+    /// append count rows holding copies of values, one for each of Cs...
+    /// Every column grows once and gets filled by a single resize, which is a
+    /// vectorized broadcast for trivially copyable components.
+    iterator fill_back(std::size_t count, const Cs&... values)
+    {
+        auto pos = this->size();
+
+        reserve_back(count);
+        (this->template get<Cs>().resize(pos + count, values), ...);
+
+        if (metadata_)
+        {
+            metadata_->push_back(count);
+        }
+
+        return iterator{pos, this->template get<Cs>()...};
+    }
+
+    /// append count rows, row i is constructed in place from gen(i). gen
+    /// returns a tuple with an element for each of Cs..., each being either
+    /// the component or a tuple of arguments to construct it from, a group of
+    /// a single component also takes the component itself. The columns grow
+    /// once, gen must not throw.
+    template<typename Generator>
+    iterator generate_back(std::size_t count, Generator&& gen)
+    {
+        auto pos = this->size();
+
+        reserve_back(count);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            emplace_row(std::invoke(gen, i));
+        }
+
+        if (metadata_)
+        {
+            metadata_->push_back(count);
+        }
+
         return iterator{pos, this->template get<Cs>()...};
     }
 
@@ -113,6 +209,52 @@ public:
     friend constexpr std::optional<matter::group<_Id, _Cs...>>
     make_group(matter::any_group<_Id>                          grp,
                const matter::unordered_typed_ids<_Id, _Cs...>& ids) noexcept;
+
+private:
+    // grow every column at once to hold count more rows, at least doubling
+    // the capacity so repeated appends stay amortized. The handles of the
+    // new rows are reserved as well.
+    void reserve_back(std::size_t count)
+    {
+        auto required = this->size() + count;
+        auto capacity = std::min({this->template capacity<Cs>()...});
+
+        if (required > capacity)
+        {
+            reserve(std::max(required, 2 * capacity));
+        }
+
+        if (metadata_)
+        {
+            metadata_->reserve_handles(count);
+        }
+    }
+
+    template<typename Row>
+    void emplace_row(Row&& row)
+    {
+        if constexpr (matter::meta::is_tuple_v<std::decay_t<Row>>)
+        {
+            static_assert(std::tuple_size_v<std::decay_t<Row>> ==
+                              sizeof...(Cs),
+                          "Must generate one element for each component");
+            std::apply(
+                [&](auto&&... elements) {
+                    (matter::detail::emplace_back_ambiguous(
+                         this->template get<Cs>(),
+                         std::forward<decltype(elements)>(elements)),
+                     ...);
+                },
+                std::forward<Row>(row));
+        }
+        else
+        {
+            static_assert(sizeof...(Cs) == 1,
+                          "Must generate a tuple for multiple components");
+            (this->template get<Cs>().emplace_back(std::forward<Row>(row)),
+             ...);
+        }
+    }
 };
 
 template<typename Id, typename... Cs>
@@ -130,7 +272,9 @@ make_group(matter::any_group<Id>                         grp,
     if (opt_stores)
     {
         return std::apply(
-            [](auto&... stores) { return matter::group<Id, Cs...>{stores...}; },
+            [&](auto&... stores) {
+                return matter::group<Id, Cs...>{grp.metadata(), stores...};
+            },
             *opt_stores);
     }
     else
@@ -3,15 +3,36 @@
 
 #pragma once
 
-#include <range/v3/view/all.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+#include <range/v3/view/transform.hpp>
 
 #include "matter/component/any_group.hpp"
+#include "matter/component/change_clock.hpp"
 #include "matter/component/group.hpp"
+#include "matter/component/group_metadata.hpp"
+#include "matter/container/span.hpp"
+#include "matter/entity/entity.hpp"
+#include "matter/entity/entity_table.hpp"
 #include "matter/id/typed_id.hpp"
+#include "matter/util/profiler.hpp"
 
 namespace matter
 {
-// a subset of the group_vector_container
+// all groups of a single size within the group_container
+// The range refers to the bucket of its group size by address and iterators
+// refer to groups by index within that bucket. Buckets are only ever appended
+// to, so iterators remain valid when new groups are created.
 template<typename Id>
 class sized_group_range {
     static_assert(matter::is_id_v<Id>);
@@ -19,36 +40,34 @@ class sized_group_range {
 public:
     using id_type = Id;
 
-    using erased_type = typename matter::any_group<id_type>::erased_type;
-    using underlying_iterator_type =
-        matter::iterator_t<std::vector<erased_type>>;
+    using erased_type   = typename matter::any_group<id_type>::erased_type;
+    using metadata_type = matter::group_metadata<id_type>;
+    using bucket_type   = std::pmr::vector<metadata_type*>;
 
     class sentinel;
 
     class iterator {
         friend class sentinel;
 
-        using underlying_iterator_type =
-            matter::iterator_t<std::vector<erased_type>>;
-
     public:
         using value_type        = matter::any_group<id_type>;
         using pointer           = void;
         using reference         = matter::any_group<id_type>;
-        using iterator_category = typename std::iterator_traits<
-            typename std::vector<erased_type>::iterator>::iterator_category;
-        using difference_type = typename std::iterator_traits<
-            typename std::vector<erased_type>::iterator>::difference_type;
+        using iterator_category = std::random_access_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
 
     private:
-        std::size_t              grp_size_{};
-        underlying_iterator_type it_;
+        std::size_t        grp_size_{};
+        const bucket_type* bucket_{nullptr};
+        std::size_t        idx_{0};
 
     public:
         constexpr iterator() noexcept = default;
 
-        constexpr iterator(underlying_iterator_type it, std::size_t grp_size)
-            : grp_size_{grp_size}, it_{it}
+        constexpr iterator(const bucket_type* bucket,
+                           std::size_t        idx,
+                           std::size_t        grp_size) noexcept
+            : grp_size_{grp_size}, bucket_{bucket}, idx_{idx}
         {}
 
         constexpr std::size_t group_size() const noexcept
@@ -56,26 +75,14 @@ public:
             return grp_size_;
         }
 
-        constexpr underlying_iterator_type base() const noexcept
-        {
-            return it_;
-        }
-
-        constexpr bool operator==(const underlying_iterator_type& it) const
-            noexcept
+        constexpr std::size_t index() const noexcept
         {
-            return it == it_;
-        }
-
-        constexpr bool operator!=(const underlying_iterator_type& it) const
-            noexcept
-        {
-            return !(*this == it);
+            return idx_;
         }
 
         constexpr bool operator==(const iterator& other) const noexcept
         {
-            return it_ == other.it_;
+            return bucket_ == other.bucket_ && idx_ == other.idx_;
         }
 
         constexpr bool operator!=(const iterator& other) const noexcept
@@ -85,13 +92,13 @@ public:
 
         constexpr iterator& operator++() noexcept
         {
-            it_ += group_size();
+            ++idx_;
             return *this;
         }
 
         constexpr iterator& operator--() noexcept
         {
-            it_ -= group_size();
+            --idx_;
             return *this;
         }
 
@@ -111,13 +118,13 @@ public:
 
         constexpr iterator& operator+=(difference_type movement) noexcept
         {
-            it_ += (group_size() * movement);
+            idx_ += movement;
             return *this;
         }
 
         constexpr iterator& operator-=(difference_type movement) noexcept
         {
-            it_ -= (group_size() * movement);
+            idx_ -= movement;
             return *this;
         }
 
@@ -137,44 +144,54 @@ public:
 
         difference_type operator-(const iterator& other) const noexcept
         {
-            return (it_ - other.it_) / group_size();
+            return static_cast<difference_type>(idx_) -
+                   static_cast<difference_type>(other.idx_);
+        }
+
+        reference operator*() const noexcept
+        {
+            assert(bucket_ && idx_ < bucket_->size());
+            auto* meta = (*bucket_)[idx_];
+            return matter::any_group<id_type>{
+                meta->stores(), group_size(), meta};
         }
 
-        reference operator*() noexcept
+    private:
+        constexpr bool at_end() const noexcept
         {
-            return matter::any_group<id_type>{std::addressof(*it_),
-                                              group_size()};
+            return !bucket_ || idx_ >= bucket_->size();
         }
     };
 
+    // compares equal to every iterator past the last group of the bucket,
+    // groups created after obtaining the sentinel are thus included.
     class sentinel {
-        using underlying_sentinel_type =
-            matter::const_sentinel_t<std::vector<erased_type>>;
-
     private:
-        underlying_sentinel_type sent_;
+        const bucket_type* bucket_{nullptr};
 
     public:
         constexpr sentinel() noexcept = default;
 
-        explicit constexpr sentinel(underlying_sentinel_type sent) : sent_{sent}
+        explicit constexpr sentinel(const bucket_type* bucket) noexcept
+            : bucket_{bucket}
         {}
 
         typename iterator::difference_type operator-(const iterator& it) const
             noexcept
         {
-            return (sent_ - it.it_) / it.group_size();
+            return static_cast<typename iterator::difference_type>(size()) -
+                   static_cast<typename iterator::difference_type>(it.idx_);
         }
 
         friend typename iterator::difference_type
         operator-(const iterator& it, const sentinel& sent) noexcept
         {
-            return (it.it_ - sent.sent_) / it.group_size();
+            return -(sent - it);
         }
 
         bool operator==(const iterator& other) const noexcept
         {
-            return sent_ == other.it_;
+            return other.at_end();
         }
 
         bool operator!=(const iterator& other) const noexcept
@@ -184,7 +201,7 @@ public:
 
         bool operator==(const sentinel& other) const noexcept
         {
-            return sent_ == other.sent_;
+            return bucket_ == other.bucket_;
         }
 
         bool operator!=(const sentinel& other) const noexcept
@@ -192,16 +209,6 @@ public:
             return !(*this == other);
         }
 
-        bool operator==(const underlying_sentinel_type& sent) const noexcept
-        {
-            return sent_ == sent;
-        }
-
-        bool operator!=(const underlying_sentinel_type& sent) const noexcept
-        {
-            return !(*this == sent);
-        }
-
         friend bool operator==(const iterator& it,
                                const sentinel& sent) noexcept
         {
@@ -214,48 +221,40 @@ public:
             return sent != it;
         }
 
-        friend bool operator==(const underlying_sentinel_type& sent,
-                               const iterator&                 it) noexcept
-        {
-            return it == sent;
-        }
-
-        friend bool operator!=(const underlying_sentinel_type& sent,
-                               const iterator&                 it) noexcept
+    private:
+        std::size_t size() const noexcept
         {
-            return it != sent;
+            return bucket_ ? bucket_->size() : 0;
         }
     };
 
 private:
-    std::size_t              grp_size_{0};
-    underlying_iterator_type begin_;
-    underlying_iterator_type end_;
+    std::size_t        grp_size_{0};
+    const bucket_type* bucket_{nullptr};
 
 public:
     constexpr sized_group_range() noexcept
     {}
 
-    constexpr sized_group_range(std::size_t              group_size,
-                                underlying_iterator_type beg,
-                                underlying_iterator_type end) noexcept
-        : grp_size_{group_size}, begin_{beg}, end_{end}
+    constexpr sized_group_range(std::size_t        group_size,
+                                const bucket_type* bucket) noexcept
+        : grp_size_{group_size}, bucket_{bucket}
     {}
 
-    constexpr iterator begin() noexcept
+    constexpr iterator begin() const noexcept
     {
-        return {begin_, grp_size_};
+        return {bucket_, 0, grp_size_};
     }
 
-    sentinel end() const noexcept
+    constexpr sentinel end() const noexcept
     {
-        return sentinel{end_};
+        return sentinel{bucket_};
     }
 
 private:
-    constexpr iterator iterator_end() noexcept
+    constexpr iterator iterator_end() const noexcept
     {
-        return {end_, grp_size_};
+        return {bucket_, bucket_ ? bucket_->size() : 0, grp_size_};
     }
 
 public:
@@ -266,153 +265,258 @@ public:
 
     std::size_t size() const noexcept
     {
-        return sentinel{end_} - iterator{begin_, grp_size_};
+        return end() - begin();
     }
 
     template<typename... Ts>
     constexpr iterator
-    find(const matter::ordered_typed_ids<id_type, Ts...>& ordered_ids) noexcept
+    find(const matter::ordered_typed_ids<id_type, Ts...>& ordered_ids) const
+        noexcept
+    {
+        return find(matter::ordered_untyped_ids<id_type>{ordered_ids});
+    }
+
+    /// linear search through the groups of this size, prefer
+    /// `group_container::find` which uses the container's index.
+    constexpr iterator
+    find(const matter::ordered_untyped_ids<id_type> ordered_ids) const noexcept
     {
         assert(group_size() == ordered_ids.size());
-        auto it = lower_bound(ordered_ids);
 
-        if (it == end() || *it != ordered_ids)
+        auto it = begin();
+        for (; it != end(); ++it)
         {
-            // return the end in iterator form
-            return iterator_end();
+            if (*it == ordered_ids)
+            {
+                return it;
+            }
         }
 
-        // we found it!
-        return it;
+        // return the end in iterator form
+        return iterator_end();
     }
+};
 
-    constexpr iterator
-    find(const matter::ordered_untyped_ids<id_type> ordered_ids) noexcept
+/// \brief owns all groups and indexes them by their ids
+/// The stores of every group are owned by the group's metadata and never move
+/// once created, this keeps every `any_group`, `group` and `sized_group_range`
+/// iterator valid while new groups get created. Creating a group is O(group
+/// size) and looking one up by its ids a single hash lookup.
+/// Groups with shared components are keyed on their ids together with the
+/// values of their shared components, there is a group for every distinct
+/// combination of values. Looking up a group by its ids alone only finds the
+/// group without shared components.
+/// All memory of the container, including the component storages, is
+/// allocated from the memory resource passed upon construction. Like the pmr
+/// containers the resource doesn't propagate on move assignment.
+template<typename Id>
+class group_container {
+    static_assert(matter::is_id_v<Id>);
+
+public:
+    using id_type           = Id;
+    using erased_type       = typename matter::any_group<id_type>::erased_type;
+    using metadata_type     = matter::group_metadata<id_type>;
+    using entity_table_type = typename metadata_type::table_type;
+    using iterator          = typename sized_group_range<id_type>::iterator;
+
+private:
+    using bucket_type = typename sized_group_range<id_type>::bucket_type;
+
+    struct index_entry
     {
-        assert(group_size() == ordered_ids.size());
-        auto it = lower_bound(ordered_ids);
+        metadata_type* metadata;
+        // position of the group within the bucket of its size
+        std::size_t position;
+    };
 
-        if (it == end() || *it != ordered_ids)
+    // the ids of a group and the values of its shared components, the keys
+    // of the index view both owned by the metadata they map to
+    struct index_key
+    {
+        matter::ordered_untyped_ids<id_type> ids;
+        matter::span<const std::byte>        shared;
+
+        bool operator==(const index_key& other) const noexcept
         {
-            return iterator_end();
+            return ids == other.ids && std::equal(shared.begin(),
+                                                  shared.end(),
+                                                  other.shared.begin(),
+                                                  other.shared.end());
         }
+    };
 
-        return it;
-    }
+    struct index_key_hash
+    {
+        std::size_t operator()(const index_key& key) const noexcept
+        {
+            auto hash = matter::ordered_untyped_ids_hash<id_type>{}(key.ids);
 
-    // basically a binary search
-    template<typename... Ts>
-    constexpr iterator lower_bound(
-        const matter::ordered_typed_ids<id_type, Ts...>& ordered_ids) noexcept
+            // continue the FNV-1a of the ids over the shared values
+            for (auto byte : key.shared)
+            {
+                hash ^= static_cast<std::size_t>(byte);
+                hash *= 1099511628211ull;
+            }
+
+            return hash;
+        }
+    };
+
+    using index_type =
+        std::pmr::unordered_map<index_key, index_entry, index_key_hash>;
+
+    // returns the metadata to the resource it was allocated from
+    struct metadata_deleter
     {
-        assert(ordered_ids.size() == group_size());
-        return matter::lower_bound(begin(), end(), ordered_ids);
-    }
+        std::pmr::memory_resource* resource;
 
-    constexpr iterator
-    lower_bound(const matter::ordered_untyped_ids<id_type> ordered_ids) noexcept
+        void operator()(metadata_type* meta) const noexcept
+        {
+            meta->~metadata_type();
+            resource->deallocate(
+                meta, sizeof(metadata_type), alignof(metadata_type));
+        }
+    };
+
+    using metadata_pointer = std::unique_ptr<metadata_type, metadata_deleter>;
+
+    static std::uint64_t next_instance() noexcept
     {
-        assert(group_size() == ordered_ids.size());
-        return matter::lower_bound(begin(), end(), ordered_ids);
+        static std::atomic<std::uint64_t> next{1};
+        return next.fetch_add(1, std::memory_order_relaxed);
     }
-};
 
-template<typename Id>
-class group_container {
-    static_assert(matter::is_id_v<Id>);
+private:
+    std::pmr::memory_resource* resource_{std::pmr::get_default_resource()};
 
-public:
-    using id_type     = Id;
-    using erased_type = typename matter::any_group<id_type>::erased_type;
+    // metadata of each group in order of creation, the metadata is allocated
+    // separately so entity locations and group handles can refer to it.
+    // Iterating this allows efficient iteration over all groups in the
+    // container without conditional checks for a changing group size.
+    std::pmr::vector<metadata_pointer> metadata_{resource_};
+    // location of every entity living in one of our groups
+    entity_table_type entities_{resource_};
 
-    using iterator       = matter::iterator_t<std::vector<erased_type>>;
-    using const_iterator = matter::const_iterator_t<std::vector<erased_type>>;
+    // the groups of each size in order of creation, the group size 1 is stored
+    // at index 0. A deque is used so ranges can refer to a bucket while
+    // buckets for larger group sizes get added.
+    std::pmr::deque<bucket_type> buckets_{resource_};
 
-private:
-    // groups are made from erased_storage so we store those
-    std::vector<erased_type> stores_;
-    // this buffer is used to construct stores using untyped_ids, usually an
-    // array is used but with untyped_ids the size isn't known at compile time
-    // so we need dynamic storage. To not constantly allocate new storage we
-    // have a central buffer for this. No mutating operations involving creating
-    // groups can happen in parallel so this vector does not need to be thread
-    // safe.
-    std::vector<erased_type> stores_buffer_;
-
-    // stores the begin index of each group size, inevitably to remain
-    // consistent the start of group_size 1 which is always 0 will still be
-    // stored in index = 0.
-    std::vector<std::size_t> begin_indices_;
-
-    // stores views to all groups managed by this group_container.
-    // This cache is required to allow efficient iteration over all groups in
-    // the container. Iterating otherwise would require conditional checks on
-    // each increment of the iterator because we don't know when the group_size
-    // might change.
-    std::vector<matter::any_group<id_type>> view_cache_;
+    // maps the ordered ids of every group to its metadata, this turns looking
+    // up an existing group into a single hash lookup.
+    index_type index_{resource_};
+
+    // total number of stores over all groups
+    std::size_t store_count_{0};
+
+    // the versions columns of our groups get marked with
+    matter::change_clock clock_;
+
+    // scratch space for the ids of a group reached by an edge the first time
+    std::pmr::vector<id_type> ids_buffer_{resource_};
+
+    // scratch space for the shared values of a group being looked up
+    std::pmr::vector<std::byte> shared_buffer_{resource_};
+
+    // told apart from every other container and from the groups this one
+    // held before being assigned to, as addresses may be reused
+    std::uint64_t instance_{next_instance()};
 
 public:
     group_container() noexcept = default;
 
-    constexpr iterator begin() noexcept
+    /// all memory will be allocated from resource, which must outlive the
+    /// container
+    explicit group_container(std::pmr::memory_resource* resource) noexcept
+        : resource_{resource}
+    {}
+
+    group_container(group_container&& other) noexcept
+        : resource_{other.resource_}, metadata_{std::move(other.metadata_)},
+          entities_{std::move(other.entities_)},
+          buckets_{std::move(other.buckets_)}, index_{std::move(other.index_)},
+          store_count_{std::exchange(other.store_count_, 0)},
+          clock_{other.clock_}
+    {
+        // other lost its groups
+        other.instance_ = next_instance();
+        rebind_metadata();
+    }
+
+    group_container& operator=(group_container&& other)
     {
-        return stores_.begin();
+        instance_       = next_instance();
+        other.instance_ = next_instance();
+
+        metadata_    = std::move(other.metadata_);
+        entities_    = std::move(other.entities_);
+        buckets_     = std::move(other.buckets_);
+        index_       = std::move(other.index_);
+        store_count_ = std::exchange(other.store_count_, 0);
+        clock_       = other.clock_;
+
+        rebind_metadata();
+
+        return *this;
     }
 
-    constexpr iterator end() noexcept
+    std::pmr::memory_resource* resource() const noexcept
     {
-        return stores_.end();
+        return resource_;
     }
 
-    constexpr const_iterator begin() const noexcept
+    /// a number unique to this container and the groups it holds, it changes
+    /// once the container is assigned to. Caches of groups are keyed on it.
+    std::uint64_t instance() const noexcept
     {
-        return stores_.begin();
+        return instance_;
     }
 
-    constexpr const_iterator end() const noexcept
+    /// returned by find when no group matches, past the end of every range
+    constexpr iterator end() const noexcept
     {
-        return stores_.end();
+        return iterator{};
     }
 
+    /// the total number of stores over all groups
     constexpr std::size_t size() const noexcept
     {
-        return stores_.size();
+        return store_count_;
     }
 
     /// return the maximum group size, this can be used to iterate over all
     /// contained groups in combination with range(size_t)
     constexpr std::size_t groups_size() const noexcept
     {
-        return begin_indices_.size();
+        return buckets_.size();
+    }
+
+    /// the number of groups in this container
+    std::size_t group_count() const noexcept
+    {
+        return metadata_.size();
     }
 
     constexpr auto range() noexcept
     {
-        return ranges::view::all(view_cache_);
+        return ranges::view::transform(
+            metadata_, [this](const metadata_pointer& meta) {
+                return group_of(*meta);
+            });
     }
 
     constexpr sized_group_range<id_type> range(std::size_t grp_size) noexcept
     {
-        auto begin_index_it = begin_index_iterator(grp_size);
-        auto end_index_it   = end_index_iterator(grp_size);
-
-        if (begin_index_it >= begin_indices_.end())
-        {
-            return sized_group_range<id_type>{grp_size, end(), end()};
-        }
+        assert(grp_size > 0);
 
-        else if (end_index_it == begin_indices_.end())
+        if (grp_size > buckets_.size())
         {
-            return sized_group_range<id_type>{
-                grp_size, stores_.begin() + *begin_index_it, stores_.end()};
+            return sized_group_range<id_type>{grp_size, nullptr};
         }
 
-        else
-        {
-            return sized_group_range<id_type>{grp_size,
-                                              stores_.begin() + *begin_index_it,
-                                              stores_.begin() + *end_index_it};
-        }
+        return sized_group_range<id_type>{grp_size,
+                                          std::addressof(bucket(grp_size))};
     }
 
     template<typename... Ts>
@@ -420,14 +524,13 @@ public:
         const matter::unordered_typed_ids<id_type, Ts...>& ids,
         const matter::ordered_typed_ids<id_type, Ts...>&   ordered_ids) noexcept
     {
-        // use the range's find to remove an if statement
-        auto rng = range(ids.size());
-
-        auto it = rng.find(ordered_ids);
+        static_assert(!(matter::is_component_shared_v<Ts> || ...),
+                      "Groups with shared components are found by their "
+                      "values, see find_shared_group");
 
-        if (it != rng.end())
+        if (auto* meta = find_metadata(ordered_ids))
         {
-            return matter::group{*it, ids};
+            return matter::group{group_of(*meta), ids};
         }
 
         return std::nullopt;
@@ -440,108 +543,120 @@ public:
         return find_group(ids, matter::ordered_typed_ids{ids});
     }
 
+    /// the group of ids in which every shared component among Ts holds its
+    /// value in values, the values of the other components are ignored.
     template<typename... Ts>
-    constexpr typename sized_group_range<id_type>::iterator
-    find(const matter::ordered_typed_ids<id_type, Ts...>& ids) noexcept
+    std::optional<matter::group<id_type, Ts...>>
+    find_shared_group(const matter::unordered_typed_ids<id_type, Ts...>& ids,
+                      const Ts&... values)
     {
-        auto group_size = ids.size();
-        auto rng        = range(group_size);
-
-        auto it = rng.find(ids);
-
-        if (it != rng.end())
+        if (auto* meta = find_metadata(matter::ordered_typed_ids{ids},
+                                       shared_key_of(ids, values...)))
         {
-            // if not at the end we found a valid iterator, return it
-            return it;
+            return matter::group{group_of(*meta), ids};
         }
-        // return the full end of the container, past the end of the range.
-        // this is for comparison with group_container::end().
-        return {end(), group_size};
+
+        return std::nullopt;
     }
 
-    constexpr typename sized_group_range<id_type>::iterator
-    find(const matter::ordered_untyped_ids<id_type> ids) noexcept
+    template<typename... Ts>
+    constexpr iterator
+    find(const matter::ordered_typed_ids<id_type, Ts...>& ids) noexcept
     {
-        auto group_size = ids.size();
-        auto rng        = range(group_size);
-
-        auto it = rng.find(ids);
+        return find(matter::ordered_untyped_ids<id_type>{ids});
+    }
 
-        if (it != rng.end())
+    constexpr iterator
+    find(const matter::ordered_untyped_ids<id_type> ids) noexcept
+    {
+        if (auto* entry = find_entry(ids, {}))
         {
-            return it;
+            // if found return the iterator to the group
+            return iterator_of(*entry);
         }
 
-        return {end(), group_size};
+        // for comparison with group_container::end().
+        return end();
     }
 
     constexpr std::optional<matter::any_group<id_type>>
     find_group(const matter::ordered_untyped_ids<id_type> ids) noexcept
     {
-        auto group_size = ids.size();
-        auto rng        = range(group_size);
-
-        auto it = rng.find(ids);
-
-        if (it != rng.end())
+        if (auto* meta = find_metadata(ids))
         {
-            return *it;
+            return group_of(*meta);
         }
 
         return std::nullopt;
     }
 
     template<typename... Ts>
-    constexpr typename sized_group_range<id_type>::iterator try_emplace(
+    constexpr iterator try_emplace(
         const matter::unordered_typed_ids<id_type, Ts...>& ids,
-        const matter::ordered_typed_ids<id_type, Ts...>&   ordered_ids) noexcept
+        const matter::ordered_typed_ids<id_type, Ts...>&   ordered_ids)
     {
-        auto grp_size = ids.size();
-
-        auto rng = range(grp_size);
-
-        auto it = rng.lower_bound(ordered_ids);
+        static_assert(!(matter::is_component_shared_v<Ts> || ...),
+                      "Groups with shared components are created with their "
+                      "values, see try_emplace_shared_group");
 
-        // if it is end then the appropriate group couldn't be found, insert
-        if (it == rng.end() || *it != ordered_ids)
+        if (auto* entry = find_entry(
+                matter::ordered_untyped_ids<id_type>{ordered_ids}, {}))
         {
-            // set to the returned iterator
-            it = emplace(it, ids);
+            return iterator_of(*entry);
         }
 
-        return it;
+        // the group doesn't exist yet, create it
+        return emplace(ids, {});
     }
 
     /// emplace the group if it does not yet exist and return the iterator to
     /// this group, otherwise simply return the iterator to the requested group
     template<typename... Ts>
-    constexpr typename sized_group_range<id_type>::iterator
-    try_emplace(const matter::unordered_typed_ids<id_type, Ts...>& ids) noexcept
+    constexpr iterator
+    try_emplace(const matter::unordered_typed_ids<id_type, Ts...>& ids)
     {
         return try_emplace(ids, matter::ordered_typed_ids{ids});
     }
 
     /// try to emplace the group if it doesn't already exist using the vtable
-    /// stored in the provided group. if already present, simply return
-    constexpr typename sized_group_range<id_type>::iterator
+    /// stored in the provided group. if already present, simply return.
+    /// Shared components keep the value they have in storage_source.
+    constexpr iterator
     try_emplace(const matter::const_any_group<id_type>     storage_source,
-                const matter::ordered_untyped_ids<id_type> copy_ids) noexcept
+                const matter::ordered_untyped_ids<id_type> copy_ids)
     {
-        auto new_group_size = copy_ids.size();
-
-        auto new_rng = range(new_group_size);
-        auto it      = new_rng.lower_bound(copy_ids);
+        auto shared = shared_key_of(storage_source, copy_ids);
 
-        if (it != new_rng.end() && *it == copy_ids)
+        if (auto* entry = find_entry(copy_ids, shared))
         {
             // we found a valid group, return it
-            return it;
+            return iterator_of(*entry);
         }
-        else
+
+        return emplace(storage_source, copy_ids, shared);
+    }
+
+    /// same as above but copy_ids contains exactly one id which is not present
+    /// in storage_source, its store is created from extra_id. This is how a
+    /// component gets added to the rows of a group.
+    template<typename T>
+    constexpr iterator
+    try_emplace(const matter::const_any_group<id_type>     storage_source,
+                const matter::ordered_untyped_ids<id_type> copy_ids,
+                const matter::typed_id<id_type, T>&        extra_id)
+    {
+        static_assert(!matter::is_component_shared_v<T>,
+                      "A shared component is added with its value, see "
+                      "try_emplace_group_with");
+
+        auto shared = shared_key_of(storage_source, copy_ids);
+
+        if (auto* entry = find_entry(copy_ids, shared))
         {
-            // we can legally insert at the range end as well
-            return emplace(it, storage_source, copy_ids);
+            return iterator_of(*entry);
         }
+
+        return emplace(storage_source, copy_ids, extra_id, shared);
     }
 
     /// retrieves the iterator using try_emplace and constructs the correct
@@ -550,7 +665,7 @@ public:
     template<typename... Ts>
     constexpr matter::group<id_type, Ts...> try_emplace_group(
         const matter::unordered_typed_ids<id_type, Ts...>& ids,
-        const matter::ordered_typed_ids<id_type, Ts...>&   ordered_ids) noexcept
+        const matter::ordered_typed_ids<id_type, Ts...>&   ordered_ids)
     {
         auto it = try_emplace(ids, ordered_ids);
         return matter::group{*it, ids};
@@ -560,99 +675,482 @@ public:
     /// unordered ones.
     template<typename... Ts>
     constexpr matter::group<id_type, Ts...> try_emplace_group(
-        const matter::unordered_typed_ids<id_type, Ts...>& ids) noexcept
+        const matter::unordered_typed_ids<id_type, Ts...>& ids)
     {
         return try_emplace_group(ids, matter::ordered_typed_ids{ids});
     }
 
+    /// the group of ids in which every shared component among Ts holds its
+    /// value in values, created if it doesn't exist yet. The values of the
+    /// other components are ignored.
+    template<typename... Ts>
+    matter::group<id_type, Ts...> try_emplace_shared_group(
+        const matter::unordered_typed_ids<id_type, Ts...>& ids,
+        const Ts&... values)
+    {
+        auto ordered_ids = matter::ordered_typed_ids{ids};
+        auto shared      = shared_key_of(ids, values...);
+
+        if (auto* meta = find_metadata(ordered_ids, shared))
+        {
+            return matter::group{group_of(*meta), ids};
+        }
+
+        return matter::group{*emplace(ids, shared), ids};
+    }
+
     constexpr matter::any_group<id_type>
     try_emplace_group(const matter::const_any_group<id_type>     store_source,
-                      const matter::ordered_untyped_ids<id_type> ids) noexcept
+                      const matter::ordered_untyped_ids<id_type> ids)
     {
         return *try_emplace(store_source, ids);
     }
 
-private:
+    template<typename T>
+    constexpr matter::any_group<id_type>
+    try_emplace_group(const matter::const_any_group<id_type>     store_source,
+                      const matter::ordered_untyped_ids<id_type> ids,
+                      const matter::typed_id<id_type, T>&        extra_id)
+    {
+        return *try_emplace(store_source, ids, extra_id);
+    }
+
+    /// the group with the stores of src and extra_id, created from src if it
+    /// doesn't exist yet. The edge between both groups is cached, so adding
+    /// the same component to rows of src again is a single lookup in src.
+    template<typename T>
+    matter::any_group<id_type>
+    try_emplace_group_with(const matter::any_group<id_type>    src,
+                           const matter::typed_id<id_type, T>& extra_id)
+    {
+        static_assert(!matter::is_component_shared_v<T>,
+                      "A shared component is added with its value");
+
+        assert(src.metadata());
+        assert(!src.contains(extra_id.base()));
+
+        auto& src_meta = *src.metadata();
+
+        if (auto* dst_meta = src_meta.edge_with(extra_id.base()))
+        {
+            return group_of(*dst_meta);
+        }
+
+        // the shared values stay the same
+        auto ids    = ids_with(src, extra_id.base());
+        auto shared = src_meta.shared_key();
+
+        auto* dst_meta = find_metadata(ids, shared);
+        if (!dst_meta)
+        {
+            emplace(src, ids, extra_id, shared);
+            dst_meta = metadata_.back().get();
+        }
+
+        src_meta.link_with(extra_id.base(), *dst_meta);
+        return group_of(*dst_meta);
+    }
+
+    /// the group with the stores of src and the shared component of extra_id
+    /// holding value, created from src if it doesn't exist yet. The group
+    /// depends on value, so no edge is cached.
+    template<typename T>
+    matter::any_group<id_type>
+    try_emplace_group_with(const matter::any_group<id_type>    src,
+                           const matter::typed_id<id_type, T>& extra_id,
+                           const T&                            value)
+    {
+        static_assert(matter::is_component_shared_v<T>,
+                      "Only shared components are added with their value");
+
+        assert(src.metadata());
+        assert(!src.contains(extra_id.base()));
+
+        auto ids    = ids_with(src, extra_id.base());
+        auto shared = shared_key_with(src, extra_id.base(), value);
+
+        if (auto* dst_meta = find_metadata(ids, shared))
+        {
+            return group_of(*dst_meta);
+        }
+
+        emplace(src, ids, extra_id, shared);
+        return group_of(*metadata_.back());
+    }
+
+    /// the group with the same stores as src, except that the shared
+    /// component of id holds value. It is created from src if it doesn't
+    /// exist yet and src itself if it already holds value.
+    template<typename T>
+    matter::any_group<id_type>
+    try_emplace_group_set(const matter::any_group<id_type>    src,
+                          const matter::typed_id<id_type, T>& id,
+                          const T&                            value)
+    {
+        static_assert(matter::is_component_shared_v<T>,
+                      "Only shared components have a value per group");
+
+        assert(src.metadata());
+        assert(src.contains(id.base()));
+
+        auto ids    = src.metadata()->ids();
+        auto shared = shared_key_with(src, id.base(), value);
+
+        if (auto* dst_meta = find_metadata(ids, shared))
+        {
+            return group_of(*dst_meta);
+        }
+
+        emplace(src, ids, shared);
+        return group_of(*metadata_.back());
+    }
+
+    /// the group with the stores of src except id, created from src if it
+    /// doesn't exist yet. The edge between both groups is cached like in
+    /// `try_emplace_group_with`. src must hold id and at least one other store.
+    matter::any_group<id_type>
+    try_emplace_group_without(const matter::any_group<id_type> src,
+                              const id_type&                   id)
+    {
+        assert(src.metadata());
+        assert(src.contains(id) && src.group_size() > 1);
+
+        auto& src_meta = *src.metadata();
+
+        if (auto* dst_meta = src_meta.edge_without(id))
+        {
+            return group_of(*dst_meta);
+        }
+
+        auto ids       = ids_without(src, id);
+        auto is_shared = src.find_id(id)->shared_size() != 0;
+        auto shared =
+            is_shared ? shared_key_without(src, id) : src_meta.shared_key();
+
+        auto* dst_meta = find_metadata(ids, shared);
+        if (!dst_meta)
+        {
+            emplace(src, ids, shared);
+            dst_meta = metadata_.back().get();
+        }
+
+        // adding a shared component back depends on its value
+        if (is_shared)
+        {
+            src_meta.link_without(id, *dst_meta);
+        }
+        else
+        {
+            dst_meta->link_with(id, src_meta);
+        }
+
+        return group_of(*dst_meta);
+    }
+
+    /// take the next version for marking changed columns, see
+    /// `change_clock`
+    std::uint64_t advance_version() noexcept
+    {
+        return clock_.advance();
+    }
+
+    const entity_table_type& entities() const noexcept
+    {
+        return entities_;
+    }
+
+    /// whether the entity is still alive
+    bool contains(const matter::entity& ent) const noexcept
+    {
+        return entities_.contains(ent);
+    }
+
+    /// the group owning this metadata
+    matter::any_group<id_type> group_of(metadata_type& meta) noexcept
+    {
+        return {meta.stores(), meta.group_size(), &meta};
+    }
+
+    /// the metadata of the group with exactly these ids and no shared
+    /// components, nullptr if no such group exists.
+    metadata_type*
+    find_metadata(const matter::ordered_untyped_ids<id_type> ids) noexcept
+    {
+        return find_metadata(ids, {});
+    }
+
+    /// the metadata of the group with exactly these ids whose shared
+    /// components hold the values in shared, nullptr if no such group exists.
+    /// The values are the bytes of each shared component in the order of
+    /// their ids, see `group_metadata::shared_key`.
+    metadata_type*
+    find_metadata(const matter::ordered_untyped_ids<id_type> ids,
+                  const matter::span<const std::byte>        shared) noexcept
+    {
+        auto* entry = find_entry(ids, shared);
+        return entry ? entry->metadata : nullptr;
+    }
+
     template<typename... Ts>
-    constexpr typename sized_group_range<id_type>::iterator
-    emplace(typename matter::sized_group_range<id_type>::iterator pos,
-            const matter::unordered_typed_ids<id_type, Ts...>&    ids) noexcept
+    metadata_type*
+    find_metadata(const matter::ordered_typed_ids<id_type, Ts...>& ids,
+                  const matter::span<const std::byte> shared = {}) noexcept
+    {
+        return find_metadata(matter::ordered_untyped_ids<id_type>{ids},
+                             shared);
+    }
 
+    /// find the group and row the entity resides in, nullopt if the entity
+    /// was already destroyed.
+    std::optional<std::pair<matter::any_group<id_type>, std::size_t>>
+    locate(const matter::entity& ent) noexcept
     {
-        constexpr auto grp_size = sizeof...(Ts);
-        assert(pos.group_size() == grp_size);
+        auto* loc = entities_.find(ent);
 
-        // assert that the ids don't already exist
-        // and the element at the position is greater than our ids.
-        assert([&] {
-            // we need the check with range end or we compare to a subgroup
-            // which might match
-            if (pos != end() && pos != range(grp_size).end())
+        if (!loc)
+        {
+            return std::nullopt;
+        }
+
+        return std::pair{group_of(*loc->group), loc->row};
+    }
+
+    /// destroy the entity, the last row of its group takes its place.
+    /// Returns false if the entity was already destroyed.
+    bool erase(const matter::entity& ent) noexcept
+    {
+        auto loc = locate(ent);
+
+        if (!loc)
+        {
+            return false;
+        }
+
+        loc->first.erase(loc->second);
+        return true;
+    }
+
+private:
+    /// the ordered ids of src with id inserted, views ids_buffer_
+    matter::ordered_untyped_ids<id_type>
+    ids_with(const matter::const_any_group<id_type> src, const id_type& id)
+    {
+        ids_buffer_.clear();
+        for (const auto& store : src)
+        {
+            ids_buffer_.push_back(store.id());
+        }
+
+        ids_buffer_.insert(
+            std::upper_bound(ids_buffer_.begin(), ids_buffer_.end(), id), id);
+
+        return matter::ordered_untyped_ids<id_type>{ids_buffer_};
+    }
+
+    /// the ordered ids of src with id removed, views ids_buffer_
+    matter::ordered_untyped_ids<id_type>
+    ids_without(const matter::const_any_group<id_type> src, const id_type& id)
+    {
+        ids_buffer_.clear();
+        for (const auto& store : src)
+        {
+            if (store.id() != id)
             {
-                auto ordered_ids = matter::ordered_typed_ids{ids};
-                return *pos != ordered_ids && *pos > ordered_ids;
+                ids_buffer_.push_back(store.id());
             }
+        }
 
-            return true;
-        }());
+        return matter::ordered_untyped_ids<id_type>{ids_buffer_};
+    }
 
-        // create our stores, and sort them afterwards
-        std::array<erased_type, grp_size> stores{
-            matter::erased_storage{ids.template get<Ts>()}...};
-        matter::insertion_sort(stores.begin(), stores.end());
+    /// the shared values of the stores of src whose id is in ids, views
+    /// shared_buffer_
+    matter::span<const std::byte>
+    shared_key_of(const matter::const_any_group<id_type>     src,
+                  const matter::ordered_untyped_ids<id_type> ids)
+    {
+        shared_buffer_.clear();
+
+        auto id_it = ids.begin();
+        for (const auto& store : src)
+        {
+            while (id_it != ids.end() && *id_it < store.id())
+            {
+                ++id_it;
+            }
+
+            if (id_it != ids.end() && *id_it == store.id())
+            {
+                append_shared(store);
+            }
+        }
+
+        return {shared_buffer_.data(), shared_buffer_.size()};
+    }
+
+    /// the shared values of src with the value of the shared component id
+    /// added or replaced, views shared_buffer_
+    template<typename T>
+    matter::span<const std::byte>
+    shared_key_with(const matter::const_any_group<id_type> src,
+                    const id_type&                         id,
+                    const T&                               value)
+    {
+        shared_buffer_.clear();
+
+        auto append_value = [&]() {
+            auto* bytes = reinterpret_cast<const std::byte*>(&value);
+            shared_buffer_.insert(
+                shared_buffer_.end(), bytes, bytes + sizeof(T));
+        };
+
+        auto placed = false;
+        for (const auto& store : src)
+        {
+            if (!placed && !(store.id() < id))
+            {
+                append_value();
+                placed = true;
 
-        // create more indices if our current vector is too small
-        resize_indices(grp_size);
+                if (store.id() == id)
+                {
+                    continue;
+                }
+            }
 
-        // iterator could invalidate so store the result
-        auto new_pos = stores_.insert(pos.base(),
-                                      std::make_move_iterator(stores.begin()),
-                                      std::make_move_iterator(stores.end()));
+            append_shared(store);
+        }
 
-        // increment all following index values
-        increment_indices(grp_size);
+        if (!placed)
+        {
+            append_value();
+        }
 
-        update_cache(matter::any_group<id_type>{*new_pos, grp_size});
-        // view_cache_.push_back({*new_pos, grp_size});
+        return {shared_buffer_.data(), shared_buffer_.size()};
+    }
+
+    /// the shared values of src except the one of id, views shared_buffer_
+    matter::span<const std::byte>
+    shared_key_without(const matter::const_any_group<id_type> src,
+                       const id_type&                         id)
+    {
+        shared_buffer_.clear();
+
+        for (const auto& store : src)
+        {
+            if (store.id() != id)
+            {
+                append_shared(store);
+            }
+        }
 
-        // return where the inserted element is at
-        return {new_pos, grp_size};
+        return {shared_buffer_.data(), shared_buffer_.size()};
     }
 
-    constexpr typename sized_group_range<id_type>::iterator
-    emplace(typename matter::sized_group_range<id_type>::iterator pos,
-            const matter::const_any_group<id_type>     storage_source,
-            const matter::ordered_untyped_ids<id_type> copy_ids) noexcept
+    /// the values among values of the shared components among Ts, ordered
+    /// by their ids. Views shared_buffer_ unless none of Ts is shared.
+    template<typename... Ts>
+    matter::span<const std::byte>
+    shared_key_of(const matter::unordered_typed_ids<id_type, Ts...>& ids,
+                  const Ts&... values)
     {
-        assert(pos.group_size() == copy_ids.size());
-        assert(stores_buffer_.empty());
-        assert(storage_source.contains(copy_ids));
-        assert([&] {
-            auto rng = range(copy_ids.size());
-            if (pos != rng.end())
+        constexpr auto shared_count =
+            (std::size_t{0} + ... +
+             std::size_t{matter::is_component_shared_v<Ts>});
+
+        if constexpr (shared_count == 0)
+        {
+            (void) ids;
+            ((void) values, ...);
+            return {};
+        }
+        else
+        {
+            struct shared_value
             {
-                return *pos > copy_ids;
+                id_type          id;
+                const std::byte* bytes;
+                std::size_t      size;
+            };
+
+            std::array<shared_value, shared_count> shared{};
+            std::size_t                            count = 0;
+
+            auto add = [&](auto&& tid, const auto& value) {
+                using component_type = std::decay_t<decltype(value)>;
+
+                if constexpr (matter::is_component_shared_v<component_type>)
+                {
+                    shared[count++] = shared_value{
+                        tid.base(),
+                        reinterpret_cast<const std::byte*>(&value),
+                        sizeof(component_type)};
+                }
+            };
+            (add(ids.template get<Ts>(), values), ...);
+
+            matter::insertion_sort(
+                shared.begin(),
+                shared.end(),
+                [](const shared_value& lhs, const shared_value& rhs) {
+                    return lhs.id < rhs.id;
+                });
+
+            shared_buffer_.clear();
+            for (auto& value : shared)
+            {
+                shared_buffer_.insert(shared_buffer_.end(),
+                                      value.bytes,
+                                      value.bytes + value.size);
             }
 
-            return true;
-        }());
+            return {shared_buffer_.data(), shared_buffer_.size()};
+        }
+    }
 
-        auto grp_size = copy_ids.size();
+    void append_shared(const erased_type& store)
+    {
+        if (auto size = store.shared_size(); size != 0)
+        {
+            auto* value = static_cast<const std::byte*>(store.shared_value());
+            shared_buffer_.insert(shared_buffer_.end(), value, value + size);
+        }
+    }
 
-        auto base_pos = pos.base();
+    template<typename... Ts>
+    constexpr iterator
+    emplace(const matter::unordered_typed_ids<id_type, Ts...>& ids,
+            const matter::span<const std::byte>                shared)
+    {
+        constexpr auto grp_size = sizeof...(Ts);
 
-        auto id_it = copy_ids.begin();
+        // assert that the ids don't already exist
+        assert(!find_metadata(matter::ordered_typed_ids{ids}, shared));
 
-        resize_indices(grp_size);
+        // create our stores, and sort them afterwards
+        std::pmr::vector<erased_type> stores{resource_};
+        stores.reserve(grp_size);
+        (stores.emplace_back(ids.template get<Ts>(), resource_), ...);
+        matter::insertion_sort(stores.begin(), stores.end());
+
+        return insert_group(std::move(stores), shared);
+    }
+
+    constexpr iterator
+    emplace(const matter::const_any_group<id_type>     storage_source,
+            const matter::ordered_untyped_ids<id_type> copy_ids,
+            const matter::span<const std::byte>        shared)
+    {
+        assert(storage_source.contains(copy_ids));
+        assert(!find_metadata(copy_ids, shared));
 
-        // make sure we have the space without having reallocs
-        stores_buffer_.reserve(grp_size);
+        auto grp_size = copy_ids.size();
+        auto id_it    = copy_ids.begin();
 
-        // in the following we fill the end and move it to the correct position,
-        // this is done to avoid many unnecessary moves of inserting single
-        // stores.
+        std::pmr::vector<erased_type> stores{resource_};
+        stores.reserve(grp_size);
 
-        // fill the end of our vector with stores
+        // both are ordered so the matching stores can be picked in one pass
         auto store_src_end = storage_source.end();
         for (auto store_it = storage_source.begin();
              store_it != store_src_end && id_it != copy_ids.end();
@@ -665,95 +1163,166 @@ private:
             }
             else
             {
-                stores_buffer_.emplace_back(store_it->duplicate_storage());
+                stores.emplace_back(store_it->duplicate_storage(resource_));
                 ++id_it; // found it, let's move on
             }
         }
 
-        // verify we have all the elements in our buffer
-        assert(stores_buffer_.size() == grp_size);
+        // verify we have all the stores
+        assert(stores.size() == grp_size);
 
-        auto move_beg = stores_buffer_.begin();
-        auto move_end = stores_buffer_.end();
+        return insert_group(std::move(stores), shared);
+    }
 
-        // insert them into their appropriate position
-        auto new_pos = stores_.insert(base_pos,
-                                      std::make_move_iterator(move_beg),
-                                      std::make_move_iterator(move_end));
+    template<typename T>
+    constexpr iterator
+    emplace(const matter::const_any_group<id_type>     storage_source,
+            const matter::ordered_untyped_ids<id_type> copy_ids,
+            const matter::typed_id<id_type, T>&        extra_id,
+            const matter::span<const std::byte>        shared)
+    {
+        assert(!storage_source.contains(extra_id.base()));
+        assert(!find_metadata(copy_ids, shared));
 
-        // erase our temporary buffer
-        stores_buffer_.clear();
+        std::pmr::vector<erased_type> stores{resource_};
+        stores.reserve(copy_ids.size());
 
-        // increment all begin indices to match up again
-        increment_indices(grp_size);
+        auto store_it = storage_source.begin();
+        for (const auto& id : copy_ids)
+        {
+            while (store_it != storage_source.end() && *store_it < id)
+            {
+                ++store_it;
+            }
 
-        update_cache({*new_pos, grp_size});
+            if (store_it != storage_source.end() && *store_it == id)
+            {
+                stores.emplace_back(store_it->duplicate_storage(resource_));
+            }
+            else
+            {
+                // the only id not in the source
+                assert(id == extra_id.base());
+                stores.emplace_back(extra_id, resource_);
+            }
+        }
 
-        return {new_pos, grp_size};
-    }
+        assert(stores.size() == copy_ids.size());
 
-    /// increment indices after the current, this method is called when a
-    /// group was inserted
-    constexpr void increment_indices(std::size_t group_size) noexcept
-    {
-        std::for_each(end_index_iterator(group_size),
-                      begin_indices_.end(),
-                      [&](auto& index) { index += group_size; });
+        return insert_group(std::move(stores), shared);
     }
 
-    /// adjust the size of the index vector, resize it when a group bigger than
-    /// we currently account for is inserted
-    constexpr void resize_indices(std::size_t group_size) noexcept
+    /// create the metadata owning the stores and register it in the bucket
+    /// of its size and the index. The shared stores get their values from
+    /// shared, in order. No other group is touched.
+    iterator insert_group(std::pmr::vector<erased_type>       stores,
+                          const matter::span<const std::byte> shared)
     {
-        if (auto it = begin_index_iterator(group_size);
-            it >= begin_indices_.end())
+        auto grp_size = stores.size();
+
+        auto* value = shared.begin();
+        for (auto& store : stores)
+        {
+            if (auto size = store.shared_size(); size != 0)
+            {
+                assert(value + size <= shared.end());
+                store.assign_shared(value);
+                value += size;
+            }
+        }
+        assert(value == shared.end());
+
+        // everything which may throw happens before the group is published,
+        // so a failure leaves the container as it was
+        if (metadata_.size() == metadata_.capacity())
         {
-            auto new_size = it - begin_indices_.begin() + 1;
-            begin_indices_.resize(new_size, stores_.size());
+            metadata_.reserve(std::max<std::size_t>(1, 2 * metadata_.size()));
         }
-    }
 
-    constexpr auto begin_index_iterator(std::size_t group_size) noexcept
-    {
-        return begin_indices_.begin() + (group_size - 1);
+        resize_buckets(grp_size);
+        auto& grp_bucket = bucket(grp_size);
+        if (grp_bucket.size() == grp_bucket.capacity())
+        {
+            grp_bucket.reserve(
+                std::max<std::size_t>(1, 2 * grp_bucket.size()));
+        }
+
+        auto* mem = resource_->allocate(sizeof(metadata_type),
+                                        alignof(metadata_type));
+        metadata_type* constructed;
+        try
+        {
+            constructed = ::new (mem)
+                metadata_type(entities_, clock_, std::move(stores));
+        }
+        catch (...)
+        {
+            resource_->deallocate(
+                mem, sizeof(metadata_type), alignof(metadata_type));
+            throw;
+        }
+
+        metadata_pointer meta{constructed, metadata_deleter{resource_}};
+
+        // the metadata is released again if the index fails to grow
+        index_.emplace(index_key{meta->ids(), meta->shared_key()},
+                       index_entry{meta.get(), grp_bucket.size()});
+
+        grp_bucket.push_back(meta.get());
+        metadata_.push_back(std::move(meta));
+        store_count_ += grp_size;
+
+        MATTER_PROFILE_INSTANT("structure",
+                               "create group",
+                               {"stores", grp_size},
+                               {"groups", metadata_.size()});
+
+        return {std::addressof(grp_bucket), grp_bucket.size() - 1, grp_size};
     }
 
-    constexpr auto begin_index_iterator(std::size_t group_size) const noexcept
+    /// the index entry of the group with these ids and shared values,
+    /// nullptr if no such group exists
+    const index_entry*
+    find_entry(const matter::ordered_untyped_ids<id_type> ids,
+               const matter::span<const std::byte>        shared) const
+        noexcept
     {
-        return begin_indices_.begin() + (group_size - 1);
+        auto it = index_.find(index_key{ids, shared});
+        return it != index_.end() ? std::addressof(it->second) : nullptr;
     }
 
-    constexpr auto end_index_iterator(std::size_t group_size) noexcept
+    /// the iterator to the group of entry, the position within its bucket is
+    /// kept in the entry so no further lookup is required
+    iterator iterator_of(const index_entry& entry) noexcept
     {
-        return begin_indices_.begin() + group_size;
+        auto grp_size = entry.metadata->group_size();
+        return {std::addressof(bucket(grp_size)), entry.position, grp_size};
     }
 
-    constexpr auto end_index_iterator(std::size_t group_size) const noexcept
+    /// point all metadata to our entity table and clock again, after moving
+    void rebind_metadata() noexcept
     {
-        return begin_indices_.begin() + group_size;
+        for (auto& meta : metadata_)
+        {
+            meta->rebind(entities_, clock_);
+        }
     }
 
-    /// update our view_cache_, called after every emplace.
-    /// Currently the cache gets rebuild after every new group. This doesn't
-    /// scale well but after a few cycles there shouldn't be many groups being
-    /// inserted so this should never become a bottleneck.
-    constexpr void update_cache([
-        [maybe_unused]] matter::any_group<id_type> new_group) noexcept
+    /// add buckets when a group bigger than we currently account for is
+    /// inserted
+    void resize_buckets(std::size_t group_size)
     {
-        view_cache_.clear(); // clear old cache
-
-        // redo the cache
-        auto sz = groups_size();
-        for (auto i = 1u; i <= sz; ++i)
+        if (group_size > buckets_.size())
         {
-            auto rng = range(i);
-
-            for (auto grp : rng)
-            {
-                view_cache_.emplace_back(grp);
-            }
+            buckets_.resize(group_size);
         }
     }
+
+    bucket_type& bucket(std::size_t group_size) noexcept
+    {
+        assert(group_size > 0 && group_size <= buckets_.size());
+        return buckets_[group_size - 1];
+    }
 };
 } // namespace matter
 
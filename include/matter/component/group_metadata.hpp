@@ -0,0 +1,446 @@
+#ifndef MATTER_COMPONENT_GROUP_METADATA_HPP
+#define MATTER_COMPONENT_GROUP_METADATA_HPP
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+#include "matter/component/change_clock.hpp"
+#include "matter/component/signature.hpp"
+#include "matter/container/span.hpp"
+#include "matter/entity/entity.hpp"
+#include "matter/entity/entity_table.hpp"
+#include "matter/id/id.hpp"
+#include "matter/id/untyped_id.hpp"
+#include "matter/storage/erased_storage.hpp"
+#include "matter/util/profiler.hpp"
+
+namespace matter
+{
+/// \brief the stores and bookkeeping of a single group inside a
+/// `group_container`
+/// Each group owns one metadata object which lives at a stable address for the
+/// lifetime of the container. The stores of the group are allocated once upon
+/// creation and never move afterwards, so any handle to the group remains
+/// valid while other groups get created. It also holds the entity handle for
+/// every row of the group and keeps the `entity_table` up to date whenever
+/// rows get added or moved by swap and pop.
+/// Every column carries the version it last changed at, see `change_clock`.
+/// Adding rows marks all columns as changed.
+/// The ids of the stores are summarized in a `component_signature`, which
+/// lets queries reject the group without searching its stores.
+/// Groups holding shared components are also keyed on the bytes of their
+/// shared values, copied upon creation.
+/// Adding or removing a single component moves rows along an edge to another
+/// group. Once taken an edge is remembered on both ends, so moving along it
+/// again skips building and looking up the ids of the other group.
+template<typename Id>
+class group_metadata {
+    static_assert(matter::is_id_v<Id>);
+
+public:
+    using id_type     = Id;
+    using size_type   = std::size_t;
+    using table_type  = matter::entity_table<group_metadata<id_type>>;
+    using erased_type = matter::erased_storage<id_type>;
+
+private:
+    table_type*                 table_;
+    const matter::change_clock* clock_;
+
+    // the stores of the group ordered by id, never resized after creation
+    std::pmr::vector<erased_type> stores_;
+
+    // the entity residing at each row, always the same size as the stores
+    std::pmr::vector<matter::entity> entities_;
+
+    // the ordered ids of the group's stores, owned here so the group can be
+    // indexed by them
+    std::pmr::vector<id_type> ids_;
+
+    // the version each store last changed at
+    std::pmr::vector<std::uint64_t> versions_;
+
+    matter::component_signature signature_;
+
+    // the values of the shared stores in the order of their ids, part of the
+    // key of the group besides its ids
+    std::pmr::vector<std::byte> shared_key_;
+
+    // the groups with one component added or removed, sorted by the id of
+    // that component. Groups live as long as the container, so the pointers
+    // never dangle.
+    struct edge
+    {
+        id_type         id;
+        group_metadata* with{nullptr};
+        group_metadata* without{nullptr};
+    };
+
+    std::pmr::vector<edge> edges_;
+
+public:
+    /// scratch space of bulk erasure, see `any_group::erase`
+    struct erase_scratch
+    {
+        std::pmr::vector<size_type> rows;
+        std::pmr::vector<size_type> holes;
+        std::pmr::vector<size_type> sources;
+    };
+
+private:
+    // kept between erasures, so despawning rows every frame doesn't allocate
+    erase_scratch scratch_;
+
+#ifdef MATTER_PROFILER
+    // the capacity of the rows when it last changed, the stores grow along
+    size_type profiled_capacity_{0};
+#endif
+
+public:
+    /// all bookkeeping allocates from the resource of stores
+    group_metadata(table_type&                   table,
+                   const matter::change_clock&   clock,
+                   std::pmr::vector<erased_type> stores)
+        : table_{std::addressof(table)}, clock_{std::addressof(clock)},
+          stores_{std::move(stores)}, entities_{stores_.get_allocator()},
+          ids_{stores_.get_allocator()},
+          versions_(stores_.size(), 0, stores_.get_allocator()),
+          shared_key_{stores_.get_allocator()},
+          edges_{stores_.get_allocator()},
+          scratch_{std::pmr::vector<size_type>{stores_.get_allocator()},
+                   std::pmr::vector<size_type>{stores_.get_allocator()},
+                   std::pmr::vector<size_type>{stores_.get_allocator()}}
+    {
+        assert(!stores_.empty());
+        assert(std::is_sorted(stores_.begin(), stores_.end()));
+
+        ids_.reserve(stores_.size());
+        std::transform(stores_.begin(),
+                       stores_.end(),
+                       std::back_inserter(ids_),
+                       [](const erased_type& store) { return store.id(); });
+
+        for (auto& id : ids_)
+        {
+            signature_.insert(id);
+        }
+
+        for (auto& store : stores_)
+        {
+            if (auto size = store.shared_size(); size != 0)
+            {
+                auto* value =
+                    static_cast<const std::byte*>(store.shared_value());
+                shared_key_.insert(shared_key_.end(), value, value + size);
+            }
+        }
+    }
+
+    group_metadata(const group_metadata&) = delete;
+    group_metadata& operator=(const group_metadata&) = delete;
+
+    matter::ordered_untyped_ids<id_type> ids() const noexcept
+    {
+        return matter::ordered_untyped_ids<id_type>{ids_};
+    }
+
+    /// the values of the shared components of the group, empty if it has none
+    matter::span<const std::byte> shared_key() const noexcept
+    {
+        return {shared_key_.data(), shared_key_.size()};
+    }
+
+    /// the ids of the group's stores as a signature
+    const matter::component_signature& signature() const noexcept
+    {
+        return signature_;
+    }
+
+    /// the group with id added to this one, nullptr if that edge wasn't
+    /// taken yet
+    group_metadata* edge_with(const id_type& id) const noexcept
+    {
+        auto* e = find_edge(id);
+        return e ? e->with : nullptr;
+    }
+
+    /// the group with id removed from this one, nullptr if that edge wasn't
+    /// taken yet
+    group_metadata* edge_without(const id_type& id) const noexcept
+    {
+        auto* e = find_edge(id);
+        return e ? e->without : nullptr;
+    }
+
+    /// remember that dst is this group with id added, and this group is dst
+    /// with id removed
+    void link_with(const id_type& id, group_metadata& dst)
+    {
+        assert(dst.group_size() == group_size() + 1);
+
+        edge_of(id).with        = std::addressof(dst);
+        dst.edge_of(id).without = this;
+    }
+
+    /// remember that dst is this group with id removed. Unlike `link_with`
+    /// the way back isn't remembered, which is what removing a shared
+    /// component needs as adding it back may lead to a group of another value.
+    void link_without(const id_type& id, group_metadata& dst)
+    {
+        assert(dst.group_size() + 1 == group_size());
+
+        edge_of(id).without = std::addressof(dst);
+    }
+
+    /// the buffers reused by every bulk erase of the group, they are only
+    /// valid during a single erase
+    erase_scratch& scratch() noexcept
+    {
+        return scratch_;
+    }
+
+    erased_type* stores() noexcept
+    {
+        return stores_.data();
+    }
+
+    const erased_type* stores() const noexcept
+    {
+        return stores_.data();
+    }
+
+    size_type group_size() const noexcept
+    {
+        return stores_.size();
+    }
+
+    /// number of rows currently present in the group
+    size_type size() const noexcept
+    {
+        return entities_.size();
+    }
+
+    const std::pmr::vector<matter::entity>& entities() const noexcept
+    {
+        return entities_;
+    }
+
+    matter::entity entity_at(size_type row) const noexcept
+    {
+        assert(row < size());
+        return entities_[row];
+    }
+
+    /// the version the store at index last changed at
+    std::uint64_t version(size_type index) const noexcept
+    {
+        assert(index < group_size());
+        return versions_[index];
+    }
+
+    /// the version of every store, in the order of the stores. Like the
+    /// stores they never move.
+    std::uint64_t* versions() noexcept
+    {
+        return versions_.data();
+    }
+
+    /// the store at index changed at version
+    void mark_changed(size_type index, std::uint64_t version) noexcept
+    {
+        assert(index < group_size());
+        versions_[index] = version;
+    }
+
+    void reserve(size_type new_capacity)
+    {
+        entities_.reserve(new_capacity);
+    }
+
+    /// make room for `count` more rows, growing geometrically
+    void reserve_more(size_type count)
+    {
+        auto required = entities_.size() + count;
+
+        if (required > entities_.capacity())
+        {
+            entities_.reserve(std::max(required, 2 * entities_.capacity()));
+        }
+    }
+
+    /// a row was appended to the group, create a handle for it
+    matter::entity push_back()
+    {
+        mark_added();
+        return append();
+    }
+
+    /// make room for `count` more rows and their handles, push_back(count)
+    /// doesn't allocate afterwards
+    void reserve_handles(size_type count)
+    {
+        reserve_more(count);
+        table_->reserve_more(count);
+    }
+
+    /// `count` rows were appended to the group
+    void push_back(size_type count)
+    {
+        reserve_handles(count);
+
+        for (size_type i = 0; i < count; ++i)
+        {
+            append();
+        }
+
+        mark_added();
+    }
+
+    /// the row at `row` was erased and the row previously at `moved_from` took
+    /// its place, `moved_from` equals `row` when the last row was erased.
+    void erase(size_type row, size_type moved_from) noexcept
+    {
+        assert(row < size());
+        assert(moved_from == size() - 1);
+
+        table_->release(entities_[row]);
+
+        if (moved_from != row)
+        {
+            entities_[row] = entities_[moved_from];
+            table_->relocate(entities_[row], row);
+        }
+
+        entities_.pop_back();
+    }
+
+    /// the rows in [first, last) were erased, after which the row at
+    /// sources[i] was moved into holes[i] and the group shrunk to new_size.
+    template<typename ForwardIt>
+    void erase(ForwardIt        first,
+               ForwardIt        last,
+               const size_type* holes,
+               const size_type* sources,
+               size_type        count,
+               size_type        new_size) noexcept
+    {
+        for (; first != last; ++first)
+        {
+            table_->release(entities_[*first]);
+        }
+
+        for (size_type i = 0; i < count; ++i)
+        {
+            entities_[holes[i]] = entities_[sources[i]];
+            table_->relocate(entities_[holes[i]], holes[i]);
+        }
+
+        entities_.erase(entities_.begin() + new_size, entities_.end());
+    }
+
+    /// the rows lhs and rhs were swapped
+    void swap_rows(size_type lhs, size_type rhs) noexcept
+    {
+        assert(lhs < size() && rhs < size());
+
+        if (lhs == rhs)
+        {
+            return;
+        }
+
+        std::swap(entities_[lhs], entities_[rhs]);
+        table_->relocate(entities_[lhs], lhs);
+        table_->relocate(entities_[rhs], rhs);
+    }
+
+    /// the last `count` rows were moved to the back of dst, which must have
+    /// room for them already
+    void transfer_back(group_metadata& dst, size_type count) noexcept
+    {
+        assert(count <= size());
+        assert(table_ == dst.table_);
+        assert(dst.entities_.capacity() - dst.size() >= count);
+
+        auto first     = entities_.begin() + (size() - count);
+        auto dst_first = dst.size();
+
+        dst.entities_.insert(dst.entities_.end(), first, entities_.end());
+        entities_.erase(first, entities_.end());
+
+        for (auto row = dst_first; row < dst.size(); ++row)
+        {
+            table_->relocate(dst.entities_[row], std::addressof(dst), row);
+        }
+
+        dst.mark_added();
+    }
+
+    /// point to a different table and clock, used when the owning container
+    /// is moved
+    void rebind(table_type& table, const matter::change_clock& clock) noexcept
+    {
+        table_ = std::addressof(table);
+        clock_ = std::addressof(clock);
+    }
+
+private:
+    static bool edge_before(const edge& e, const id_type& id) noexcept
+    {
+        return e.id < id;
+    }
+
+    const edge* find_edge(const id_type& id) const noexcept
+    {
+        auto it =
+            std::lower_bound(edges_.begin(), edges_.end(), id, edge_before);
+        return it != edges_.end() && it->id == id ? std::addressof(*it)
+                                                  : nullptr;
+    }
+
+    edge& edge_of(const id_type& id)
+    {
+        auto it =
+            std::lower_bound(edges_.begin(), edges_.end(), id, edge_before);
+
+        if (it == edges_.end() || it->id != id)
+        {
+            it = edges_.insert(it, edge{id});
+        }
+
+        return *it;
+    }
+
+    matter::entity append()
+    {
+        auto ent = table_->create(this, entities_.size());
+        entities_.push_back(ent);
+        return ent;
+    }
+
+    void mark_added() noexcept
+    {
+        std::fill(versions_.begin(), versions_.end(), clock_->pending());
+
+#ifdef MATTER_PROFILER
+        if (entities_.capacity() != profiled_capacity_)
+        {
+            profiled_capacity_ = entities_.capacity();
+            MATTER_PROFILE_INSTANT("structure",
+                                   "reallocate",
+                                   {"rows", size()},
+                                   {"capacity", profiled_capacity_});
+        }
+#endif
+    }
+};
+} // namespace matter
+
+#endif
@@ -7,6 +7,9 @@
 #include "matter/component/component_view.hpp"
 #include "matter/component/traits.hpp"
 #include "matter/id/typed_id.hpp"
+#include "matter/storage/chunks.hpp"
+#include "matter/util/algorithm.hpp"
+#include "matter/util/thread_pool.hpp"
 
 namespace matter
 {
@@ -22,6 +25,9 @@ class group_slice {
 
 public:
     using id_type = Id;
+    /// the components of a single row, shared components are read only
+    using view_type =
+        matter::component_view<matter::component_access_t<Ts>...>;
 
     /// This is an iterator for the subgroup.
     /// Unlike regular iterators this uses a reference to the storage and index
@@ -36,7 +42,7 @@ public:
     /// get invalidated.
     class iterator {
     public:
-        using value_type        = matter::component_view<Ts...>;
+        using value_type        = view_type;
         using reference         = value_type;
         using pointer           = void;
         using difference_type   = std::ptrdiff_t;
@@ -294,12 +300,11 @@ public:
         return get<T>().capacity();
     }
 
-    constexpr matter::component_view<Ts...>
-    operator[](std::size_t index) noexcept
+    constexpr view_type operator[](std::size_t index) noexcept
     {
         return std::apply(
             [&](auto&&... stores) {
-                return matter::component_view<Ts...>{stores.get()[index]...};
+                return view_type{stores.get()[index]...};
             },
             stores_);
     }
@@ -315,12 +320,10 @@ public:
             stores_);
     }
 
-    constexpr matter::component_view<Ts...> back() noexcept
+    constexpr view_type back() noexcept
     {
         return std::apply(
-            [](auto&&... stores) {
-                return matter::component_view<Ts...>{stores.get().back()...};
-            },
+            [](auto&&... stores) { return view_type{stores.get().back()...}; },
             stores_);
     }
 
@@ -361,6 +364,30 @@ public:
         return (contains<Us>() && ...);
     }
 
+    /// \brief invokes `f(count, col...)` for each block of contiguous rows
+    /// Every `col` points to `count` components of the matching type in Ts,
+    /// shared and empty components are passed as a `broadcast_ptr`, see
+    /// `matter::for_each_chunk`. A kernel looping over these pointers can be
+    /// vectorized by the compiler.
+    template<typename F>
+    constexpr void for_each_chunk(F&& f)
+    {
+        for_each_chunk(0, size(), std::forward<F>(f));
+    }
+
+    /// invokes `f(count, col...)` for each block of contiguous rows within
+    /// the rows [first, last)
+    template<typename F>
+    constexpr void for_each_chunk(std::size_t first, std::size_t last, F&& f)
+    {
+        std::apply(
+            [&](auto&... stores) {
+                matter::for_each_chunk_in(
+                    first, last, std::forward<F>(f), stores.get()...);
+            },
+            stores_);
+    }
+
 protected:
     template<std::size_t N>
     constexpr auto& get() noexcept
@@ -423,6 +450,59 @@ make_group_slice(matter::any_group<Id>                         grp,
         return std::nullopt;
     }
 }
+
+/// invokes `f(Ts&...)` on every row of the slice in order
+template<typename Id, typename... Ts, typename F>
+constexpr F for_each(matter::execution::sequenced_policy,
+                     matter::group_slice<Id, Ts...>& slice,
+                     F                               f)
+{
+    for (auto view : slice)
+    {
+        view.invoke(std::ref(f));
+    }
+
+    return f;
+}
+
+/// invokes `f(Ts&...)` on every row of the slice, the rows are walked with a
+/// loop over the raw columns of each block instead of through the
+/// `component_view` proxy.
+template<typename Id, typename... Ts, typename F>
+constexpr F for_each(matter::execution::unsequenced_policy,
+                     matter::group_slice<Id, Ts...>& slice,
+                     F                               f)
+{
+    slice.for_each_chunk([&](std::size_t count, auto... cols) {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            f(cols[i]...);
+        }
+    });
+
+    return f;
+}
+
+/// invokes `f(Ts&...)` on every row of the slice, ranges of rows are spread
+/// over the thread pool of the policy and f is invoked concurrently.
+template<typename Id, typename... Ts, typename F>
+constexpr F for_each(matter::execution::parallel_policy policy,
+                     matter::group_slice<Id, Ts...>&    slice,
+                     F                                  f)
+{
+    matter::parallel_for(
+        policy, slice.size(), [&](std::size_t first, std::size_t last) {
+            slice.for_each_chunk(
+                first, last, [&](std::size_t count, auto... cols) {
+                    for (std::size_t i = 0; i < count; ++i)
+                    {
+                        f(cols[i]...);
+                    }
+                });
+        });
+
+    return f;
+}
 } // namespace matter
 
 #endif
@@ -3,10 +3,17 @@
 
 #pragma once
 
+#include <functional>
+#include <memory_resource>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 
+#include "matter/container/span.hpp"
 #include "matter/id/typed_id.hpp"
+#include "matter/util/algorithm.hpp"
 #include "matter/util/meta.hpp"
+#include "matter/util/thread_pool.hpp"
 
 namespace matter
 {
@@ -21,11 +28,14 @@ private:
 
 private:
     matter::unordered_typed_ids<Id, Ts...> ids_;
-    std::tuple<std::vector<Ts>...>         buffers_;
+    std::tuple<std::pmr::vector<Ts>...>    buffers_;
 
 public:
-    insert_buffer(const matter::unordered_typed_ids<Id, Ts...>& ids) noexcept
-        : ids_{ids}, buffers_{}
+    /// the buffers allocate from resource, which must outlive the buffer
+    insert_buffer(const matter::unordered_typed_ids<Id, Ts...>& ids,
+                  std::pmr::memory_resource*                    resource =
+                      std::pmr::get_default_resource()) noexcept
+        : ids_{ids}, buffers_{std::pmr::vector<Ts>{resource}...}
     {}
 
     template<typename... Us>
@@ -36,14 +46,14 @@ public:
               // buffer that we also have in the current buffer
               if constexpr (detail::type_in_list_v<Ts, Us...>)
               {
-                  auto vec =
-                      std::vector<Ts>{std::move(move_from.template get<Ts>())};
+                  auto vec = std::pmr::vector<Ts>{
+                      std::move(move_from.template get<Ts>())};
                   vec.clear();
                   return vec;
               }
               else
               {
-                  return std::vector<Ts>{};
+                  return std::pmr::vector<Ts>{move_from.resource()};
               }
           }()...}
     {}
@@ -72,11 +82,31 @@ public:
         return get<T>().end();
     }
 
+    /// the contiguous elements of the column of T
+    template<typename T>
+    constexpr const T* data() const noexcept
+    {
+        return get<T>().data();
+    }
+
+    /// the column of T, after a resize different threads may write to
+    /// disjoint parts of the columns at once
+    template<typename T>
+    matter::span<T> column() noexcept
+    {
+        return matter::span<T>{get<T>().data(), get<T>().size()};
+    }
+
     const auto& ids() const noexcept
     {
         return ids_;
     }
 
+    std::pmr::memory_resource* resource() const noexcept
+    {
+        return std::get<0>(buffers_).get_allocator().resource();
+    }
+
     std::size_t size() const noexcept
     {
         // all buffers are guaranteed to be the same size
@@ -90,6 +120,13 @@ public:
             buffers_);
     }
 
+    /// remove every element, the buffers keep their capacity
+    void clear() noexcept
+    {
+        return std::apply([](auto&&... buffers) { (buffers.clear(), ...); },
+                          buffers_);
+    }
+
     void resize(std::size_t new_size) noexcept(
         (std::is_nothrow_default_constructible_v<Ts> && ...))
     {
@@ -122,7 +159,67 @@ public:
         (get<Ts>().emplace_back(std::forward<Us>(us)), ...);
     }
 
+    /// append count rows, the row at first + i is built from gen(i) which
+    /// returns a tuple with a component for each of Ts...
+    template<typename Generator>
+    void generate(std::size_t count, Generator gen)
+    {
+        reserve(size() + count);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            emplace_row(std::invoke(gen, i));
+        }
+    }
+
+    /// append count rows like `generate`, but the columns grow once and the
+    /// rows are assigned from gen on the threads of policy. gen is invoked
+    /// concurrently for different rows and must be safe to do so, the
+    /// components must be default constructible.
+    template<typename Generator>
+    void generate(matter::execution::parallel_policy policy,
+                  std::size_t                        count,
+                  Generator                          gen)
+    {
+        auto first = size();
+        resize(first + count);
+
+        matter::parallel_for(
+            policy, count, [&](std::size_t task_first, std::size_t task_last) {
+                for (auto i = task_first; i < task_last; ++i)
+                {
+                    assign_row(first + i, std::invoke(gen, i));
+                }
+            });
+    }
+
 private:
+    template<typename Row>
+    void emplace_row(Row&& row)
+    {
+        static_assert(std::tuple_size_v<std::decay_t<Row>> == sizeof...(Ts),
+                      "Must generate a component for each column");
+        std::apply(
+            [&](auto&&... comps) {
+                (get<Ts>().emplace_back(std::forward<decltype(comps)>(comps)),
+                 ...);
+            },
+            std::forward<Row>(row));
+    }
+
+    template<typename Row>
+    void assign_row(std::size_t index, Row&& row)
+    {
+        static_assert(std::tuple_size_v<std::decay_t<Row>> == sizeof...(Ts),
+                      "Must generate a component for each column");
+        std::apply(
+            [&](auto&&... comps) {
+                ((get<Ts>()[index] = std::forward<decltype(comps)>(comps)),
+                 ...);
+            },
+            std::forward<Row>(row));
+    }
+
     template<typename T, typename... Args>
     void emplace_one_impl(std::tuple<Args...> tuple_args) noexcept(
         std::is_nothrow_constructible_v<T, Args...>)
@@ -133,13 +230,13 @@ private:
     template<typename T>
     auto& get() noexcept
     {
-        return std::get<std::vector<T>>(buffers_);
+        return std::get<std::pmr::vector<T>>(buffers_);
     }
 
     template<typename T>
     const auto& get() const noexcept
     {
-        return std::get<std::vector<T>>(buffers_);
+        return std::get<std::pmr::vector<T>>(buffers_);
     }
 };
 
@@ -147,6 +244,11 @@ template<typename Id, typename... Ts>
 insert_buffer(const matter::unordered_typed_ids<Id, Ts...>& ids)
     ->insert_buffer<Id, Ts...>;
 
+template<typename Id, typename... Ts>
+insert_buffer(const matter::unordered_typed_ids<Id, Ts...>& ids,
+              std::pmr::memory_resource*)
+    ->insert_buffer<Id, Ts...>;
+
 template<typename Id, typename... Ts, typename... Us>
 insert_buffer(const matter::unordered_typed_ids<Id, Ts...>&,
               matter::insert_buffer<Id, Us...> &&)
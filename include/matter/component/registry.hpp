@@ -4,11 +4,21 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory_resource>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "matter/id/component_identifier.hpp"
 
 #include "matter/component/group_container.hpp"
+#include "matter/entity/entity.hpp"
 #include "matter/util/meta.hpp"
+#include "matter/util/profiler.hpp"
 
 namespace matter
 {
@@ -20,14 +30,66 @@ public:
     using identifier_type      = Identifier;
     using id_type              = typename identifier_type::id_type;
     using group_container_type = matter::group_container<id_type>;
+    using entity_type          = matter::entity;
 
 private:
     identifier_type identifier_{};
 
     group_container_type container_;
 
+    // an entity to migrate and the group and row it resided in at the start
+    struct migrate_entry
+    {
+        typename group_container_type::metadata_type* group;
+        std::size_t                                   row;
+        entity_type                                   ent;
+
+        bool operator==(const migrate_entry& other) const noexcept
+        {
+            return group == other.group && row == other.row;
+        }
+
+        /// groups together the entities of each source group, ordered by row
+        bool operator<(const migrate_entry& other) const noexcept
+        {
+            if (group != other.group)
+            {
+                return std::less<>{}(group, other.group);
+            }
+
+            return row < other.row;
+        }
+
+        // the generic matter::swap would be ambiguous with std::swap
+        friend void swap(migrate_entry& lhs, migrate_entry& rhs) noexcept
+        {
+            std::swap(lhs.group, rhs.group);
+            std::swap(lhs.row, rhs.row);
+            std::swap(lhs.ent, rhs.ent);
+        }
+    };
+
+    // scratch space for batched migration and destruction
+    std::pmr::vector<migrate_entry> migrate_buffer_{container_.resource()};
+
+    // scratch space for the rows to erase from a single group
+    std::pmr::vector<std::size_t> rows_buffer_{container_.resource()};
+
 public:
-    constexpr registry() noexcept = default;
+    registry() noexcept = default;
+
+    /// allocate the groups, component storages and insert buffers of this
+    /// registry from resource, which must outlive the registry. Passing a
+    /// `std::pmr::monotonic_buffer_resource` turns the registry into an arena
+    /// which is released all at once together with the resource.
+    explicit registry(std::pmr::memory_resource* resource) noexcept
+        : container_{resource}
+    {}
+
+    std::pmr::memory_resource* resource() const noexcept
+    {
+        return container_.resource();
+    }
 
     template<typename C>
     constexpr std::enable_if_t<
@@ -75,30 +137,340 @@ public:
         return container_;
     }
 
+    /// see `group_container::instance`
+    std::uint64_t instance() const noexcept
+    {
+        return container_.instance();
+    }
+
+    /// create an entity composed of Cs... and return the handle to it
     template<typename... Cs, typename... TupArgs>
-    void create(TupArgs&&... args)
+    entity_type create(TupArgs&&... args)
     {
         static_assert(sizeof...(Cs) == sizeof...(TupArgs),
                       "Did not provide Component for each Argument.");
 
         auto ids = component_ids<Cs...>();
 
-        auto ideal_group = try_emplace_group(ids);
+        if constexpr ((matter::is_component_shared_v<Cs> || ...))
+        {
+            // the group depends on the values, so they're built up front
+            return create_from_values(
+                ids,
+                matter::detail::construct_from_ambiguous<Cs>(
+                    std::forward<TupArgs>(args))...);
+        }
+        else
+        {
+            auto ideal_group = try_emplace_group(ids);
+
+            static_assert(
+                boost::hana::is_valid([&]() {
+                    ideal_group.template emplace_back(
+                        std::forward<TupArgs>(args)...);
+                })(),
+                "cannot emplace into container from provided arguments");
+
+            // this emplace_back can emplace from tuple as well as non tuple
+            ideal_group.template emplace_back(std::forward<TupArgs>(args)...);
+
+            return ideal_group.entity_at(ideal_group.size() - 1);
+        }
+    }
+
+    /// create count entities composed of Cs... and return their handles,
+    /// either
+    /// - `create_n<Cs...>(count, args...)` with an argument for each of Cs...,
+    ///   which is the component or a tuple to construct it from. Every entity
+    ///   gets a copy of it.
+    /// - `create_n<Cs...>(count, gen)` where gen is invoked with the index of
+    ///   each entity and returns its components, see `group::generate_back`.
+    /// The group is looked up once and every column grows once. The handles
+    /// are copied out of the group into a vector allocated from the resource
+    /// of the registry, so they stay valid while the entities are changed.
+    /// Entities with shared components can't be generated, as the generated
+    /// values would pick their group.
+    template<typename... Cs, typename... Args>
+    std::pmr::vector<entity_type> create_n(std::size_t count, Args&&... args)
+    {
+        if constexpr (is_row_generator<Cs...>(boost::hana::type_c<Args>...))
+        {
+            static_assert(!(matter::is_component_shared_v<Cs> || ...),
+                          "Entities with shared components are created from "
+                          "their values");
+
+            auto grp   = try_emplace_group(component_ids<Cs...>());
+            auto first = grp.size();
+
+            MATTER_PROFILE_SCOPE(create_scope, "structure", "create entities");
+            MATTER_PROFILE_ARG(create_scope, "rows", count);
+
+            grp.generate_back(count, std::forward<Args>(args)...);
+
+            return created_since(grp, first);
+        }
+        else
+        {
+            static_assert(sizeof...(Cs) == sizeof...(Args),
+                          "Must pass an argument for each component or a "
+                          "generator");
+
+            return fill_n(component_ids<Cs...>(),
+                          count,
+                          matter::detail::construct_from_ambiguous<Cs>(
+                              std::forward<Args>(args))...);
+        }
+    }
+
+    /// whether the entity has not been destroyed yet
+    bool contains(const entity_type& ent) const noexcept
+    {
+        return container_.contains(ent);
+    }
+
+    /// destroy the entity in O(1), returns false if it was already destroyed
+    bool destroy(const entity_type& ent) noexcept
+    {
+        return container_.erase(ent);
+    }
+
+    /// destroy every alive entity in [first, last), returns the number of
+    /// destroyed entities. The rows of each group are erased together, which
+    /// compacts every store of the group once.
+    template<typename InputIt>
+    std::size_t destroy(InputIt first, InputIt last)
+    {
+        sort_by_group(first, last, [](const_any_group<id_type>) {
+            return true;
+        });
+
+        for_each_group_run([&](auto run_first, auto run_last) {
+            // no rows moved yet, so the rows are still valid and sorted
+            rows_buffer_.clear();
+            for (auto it = run_first; it != run_last; ++it)
+            {
+                rows_buffer_.push_back(it->row);
+            }
 
-        static_assert(boost::hana::is_valid([&]() {
-                          ideal_group.template emplace_back(
-                              std::forward<TupArgs>(args)...);
-                      })(),
-                      "cannot emplace into container from provided arguments");
+            auto grp = container_.group_of(*run_first->group);
+            grp.erase(rows_buffer_.begin(), rows_buffer_.end());
+        });
 
-        // this emplace_back can emplace from tuple as well as non tuple
-        ideal_group.template emplace_back(std::forward<TupArgs>(args)...);
+        return migrate_buffer_.size();
     }
 
+    /// retrieve the component of an entity, nullptr if the entity is dead or
+    /// does not have this component. Shared components are const, see
+    /// `set_shared`.
+    template<typename C>
+    matter::component_access_t<C>* try_get(const entity_type& ent)
+    {
+        if (!contains_component<C>())
+        {
+            return nullptr;
+        }
+
+        auto loc = container_.locate(ent);
+
+        if (!loc)
+        {
+            return nullptr;
+        }
+
+        auto& [grp, row] = *loc;
+        auto* store      = grp.maybe_storage(component_id<C>());
+
+        return store ? std::addressof((*store)[row]) : nullptr;
+    }
+
+    /// retrieve the component of an entity, the entity must be alive and have
+    /// this component.
+    template<typename C>
+    matter::component_access_t<C>& get(const entity_type& ent)
+    {
+        auto* comp = try_get<C>(ent);
+        assert(comp);
+        return *comp;
+    }
+
+    /// add the component C to an entity and return it. The entity's row moves
+    /// to the group with C added, the other components are moved along and
+    /// the handle remains valid. A shared C moves the entity to the group
+    /// holding the constructed value. Like the bulk form this skips entities
+    /// which are dead or already have C, nullptr is returned for them.
+    template<typename C, typename... Args>
+    matter::component_access_t<C>* add_component(const entity_type& ent,
+                                                 Args&&... args)
+    {
+        auto loc = container_.locate(ent);
+
+        if (!loc)
+        {
+            return nullptr;
+        }
+
+        auto [src, row] = *loc;
+        auto cid        = component_id<C>();
+
+        if (src.contains(cid))
+        {
+            return nullptr;
+        }
+
+        MATTER_PROFILE_SCOPE(migrate_scope, "structure", "add component");
+        MATTER_PROFILE_ARG(migrate_scope, "rows", 1);
+
+        if constexpr (matter::is_component_shared_v<C>)
+        {
+            // the group is picked by the value, which it holds already
+            const auto value = C(std::forward<Args>(args)...);
+            auto dst = container_.try_emplace_group_with(src, cid, value);
+
+            src.swap_rows(row, src.size() - 1);
+            src.transfer_back(dst, 1);
+
+            auto& store = *dst.maybe_storage(cid);
+            store.push_back(value);
+            return std::addressof(store.back());
+        }
+        else
+        {
+            auto dst = container_.try_emplace_group_with(src, cid);
+
+            src.swap_rows(row, src.size() - 1);
+            src.transfer_back(dst, 1);
+
+            auto& store = *dst.maybe_storage(cid);
+            store.emplace_back(std::forward<Args>(args)...);
+            return std::addressof(store.back());
+        }
+    }
+
+    /// add the component C with the given value to every alive entity in
+    /// [first, last) which does not have C yet. Entities sharing a group
+    /// migrate together, each column is copied with a single call.
+    template<typename C, typename InputIt>
+    void add_component(InputIt first, InputIt last, const C& value = C())
+    {
+        auto cid = component_id<C>();
+
+        migrate(first,
+                last,
+                [&](const_any_group<id_type> src) {
+                    return !src.contains(cid);
+                },
+                [&](any_group<id_type> src) {
+                    if constexpr (matter::is_component_shared_v<C>)
+                    {
+                        return container_.try_emplace_group_with(
+                            src, cid, value);
+                    }
+                    else
+                    {
+                        return container_.try_emplace_group_with(src, cid);
+                    }
+                },
+                [&](any_group<id_type> dst, std::size_t count) {
+                    auto& store = *dst.maybe_storage(cid);
+                    store.resize(store.size() + count, value);
+                });
+    }
+
+    /// remove the component C from an entity, the other components are kept
+    /// and the handle remains valid. Returns false if the entity is dead,
+    /// doesn't have C or C is its only component, use destroy for the latter.
+    template<typename C>
+    bool remove_component(const entity_type& ent)
+    {
+        auto loc = container_.locate(ent);
+
+        if (!loc)
+        {
+            return false;
+        }
+
+        auto [src, row] = *loc;
+        auto cid        = component_id<C>();
+
+        if (!src.contains(cid) || src.group_size() == 1)
+        {
+            return false;
+        }
+
+        MATTER_PROFILE_SCOPE(migrate_scope, "structure", "remove component");
+        MATTER_PROFILE_ARG(migrate_scope, "rows", 1);
+
+        auto dst = container_.try_emplace_group_without(src, cid);
+
+        src.swap_rows(row, src.size() - 1);
+        src.transfer_back(dst, 1);
+
+        return true;
+    }
+
+    /// change the value of the shared component C of an entity. The entity's
+    /// row moves to the group holding value, the handle remains valid.
+    /// Returns false if the entity is dead or doesn't have C.
+    template<typename C>
+    bool set_shared(const entity_type& ent, const C& value)
+    {
+        static_assert(matter::is_component_shared_v<C>,
+                      "Only shared components are set per group");
+
+        auto loc = container_.locate(ent);
+
+        if (!loc)
+        {
+            return false;
+        }
+
+        auto [src, row] = *loc;
+        auto cid        = component_id<C>();
+
+        if (!src.contains(cid))
+        {
+            return false;
+        }
+
+        auto dst = container_.try_emplace_group_set(src, cid, value);
+
+        if (dst.metadata() == src.metadata())
+        {
+            return true;
+        }
+
+        MATTER_PROFILE_SCOPE(migrate_scope, "structure", "set shared");
+        MATTER_PROFILE_ARG(migrate_scope, "rows", 1);
+
+        src.swap_rows(row, src.size() - 1);
+        src.transfer_back(dst, 1);
+        return true;
+    }
+
+    /// remove the component C from every entity in [first, last), skipping
+    /// the entities remove_component(ent) would return false for.
+    template<typename C, typename InputIt>
+    void remove_component(InputIt first, InputIt last)
+    {
+        auto cid = component_id<C>();
+
+        migrate(first,
+                last,
+                [&](const_any_group<id_type> src) {
+                    return src.contains(cid) && src.group_size() != 1;
+                },
+                [&](any_group<id_type> src) {
+                    return container_.try_emplace_group_without(src, cid);
+                },
+                [](any_group<id_type>, std::size_t) {});
+    }
+
+    /// create a buffer for bulk insertion, it allocates from the resource of
+    /// this registry
     template<typename... Cs>
     auto create_buffer_for() const noexcept
     {
-        return matter::insert_buffer{component_ids<Cs...>()};
+        return matter::insert_buffer{component_ids<Cs...>(), resource()};
     }
 
     template<typename... Cs, typename... Ts>
@@ -108,12 +480,32 @@ public:
                                      std::move(move_from)};
     }
 
+    /// create an entity for every row of buffer. The columns are copied in
+    /// bulk, unless the buffer holds shared components, then every run of
+    /// rows with the same shared values is appended row by row to its group.
     template<typename... Ts>
-    void insert(const matter::insert_buffer<id_type, Ts...>& buffer) noexcept(
-        (std::is_nothrow_copy_constructible_v<Ts> && ...))
+    void insert(const matter::insert_buffer<id_type, Ts...>& buffer)
     {
-        auto ideal_group = try_emplace_group(buffer.ids());
-        ideal_group.insert_back(buffer);
+        if constexpr ((matter::is_component_shared_v<Ts> || ...))
+        {
+            std::optional<matter::group<id_type, Ts...>> grp;
+
+            for (std::size_t i = 0; i < buffer.size(); ++i)
+            {
+                if (!grp || !same_shared_values(buffer, i - 1, i))
+                {
+                    grp = container_.try_emplace_shared_group(
+                        buffer.ids(), buffer.template begin<Ts>()[i]...);
+                }
+
+                grp->emplace_back(buffer.template begin<Ts>()[i]...);
+            }
+        }
+        else
+        {
+            auto ideal_group = try_emplace_group(buffer.ids());
+            ideal_group.insert_back(buffer);
+        }
     }
 
     template<typename GroupViewIterator>
@@ -126,20 +518,220 @@ public:
     }
 
 private:
+    // a single argument invocable with an index, which can't be used as the
+    // only component instead
+    template<typename... Cs, typename... Args>
+    static constexpr bool
+    is_row_generator(boost::hana::basic_type<Args>...) noexcept
+    {
+        if constexpr (sizeof...(Args) != 1)
+        {
+            return false;
+        }
+        else if constexpr (sizeof...(Cs) == 1)
+        {
+            return (std::is_invocable_v<Args&, std::size_t> && ...) &&
+                   !(std::is_constructible_v<Cs, Args> && ...);
+        }
+        else
+        {
+            return (std::is_invocable_v<Args&, std::size_t> && ...);
+        }
+    }
+
     template<typename... Ts>
     constexpr matter::group<id_type, Ts...> try_emplace_group(
-        const matter::unordered_typed_ids<id_type, Ts...>& ids) noexcept
+        const matter::unordered_typed_ids<id_type, Ts...>& ids)
     {
         return container_.try_emplace_group(ids);
     }
 
+    /// the group of ids for an entity with these values, only the values of
+    /// shared components matter
+    template<typename... Ts>
+    matter::group<id_type, Ts...>
+    try_emplace_group(const matter::unordered_typed_ids<id_type, Ts...>& ids,
+                      const Ts&... values)
+    {
+        if constexpr ((matter::is_component_shared_v<Ts> || ...))
+        {
+            return container_.try_emplace_shared_group(ids, values...);
+        }
+        else
+        {
+            ((void) values, ...);
+            return container_.try_emplace_group(ids);
+        }
+    }
+
+    template<typename... Cs>
+    entity_type
+    create_from_values(const matter::unordered_typed_ids<id_type, Cs...>& ids,
+                       Cs... values)
+    {
+        auto grp = try_emplace_group(ids, values...);
+        grp.emplace_back(std::move(values)...);
+
+        return grp.entity_at(grp.size() - 1);
+    }
+
+    template<typename... Cs>
+    std::pmr::vector<entity_type>
+    fill_n(const matter::unordered_typed_ids<id_type, Cs...>& ids,
+           std::size_t                                        count,
+           const Cs&... values)
+    {
+        auto grp   = try_emplace_group(ids, values...);
+        auto first = grp.size();
+
+        MATTER_PROFILE_SCOPE(create_scope, "structure", "create entities");
+        MATTER_PROFILE_ARG(create_scope, "rows", count);
+
+        grp.fill_back(count, values...);
+
+        return created_since(grp, first);
+    }
+
+    /// copy the handles of the rows of grp starting at first
+    template<typename Group>
+    std::pmr::vector<entity_type> created_since(const Group& grp,
+                                                std::size_t  first) const
+    {
+        const auto& ents = grp.metadata()->entities();
+
+        return std::pmr::vector<entity_type>{
+            ents.begin() + static_cast<std::ptrdiff_t>(first),
+            ents.end(),
+            container_.resource()};
+    }
+
+    /// whether rows lhs and rhs of buffer hold the same shared values
+    template<typename... Ts>
+    static bool
+    same_shared_values(const matter::insert_buffer<id_type, Ts...>& buffer,
+                       std::size_t                                  lhs,
+                       std::size_t                                  rhs)
+    {
+        auto same = [&](auto type) {
+            using component_type = typename decltype(type)::type;
+
+            if constexpr (matter::is_component_shared_v<component_type>)
+            {
+                auto it = buffer.template begin<component_type>();
+                return std::memcmp(std::addressof(it[lhs]),
+                                   std::addressof(it[rhs]),
+                                   sizeof(component_type)) == 0;
+            }
+            else
+            {
+                return true;
+            }
+        };
+
+        return (same(boost::hana::type_c<Ts>) && ...);
+    }
+
     constexpr any_group<id_type>
     find_emplace_group(const_any_group<id_type>             storage_source,
-                       matter::ordered_untyped_ids<id_type> new_ids) noexcept
+                       matter::ordered_untyped_ids<id_type> new_ids)
     {
-        auto& grp_vec = get_group_vector(new_ids.size());
-        return grp_vec.find_emplace_group(std::move(storage_source),
-                                          std::move(new_ids));
+        return container_.try_emplace_group(storage_source, new_ids);
+    }
+
+    /// fill migrate_buffer_ with every alive entity in [first, last) for
+    /// whose group `filter` returns true, ordered by group without duplicates
+    template<typename InputIt, typename Filter>
+    void sort_by_group(InputIt first, InputIt last, Filter filter)
+    {
+        migrate_buffer_.clear();
+
+        if constexpr (std::is_base_of_v<
+                          std::forward_iterator_tag,
+                          typename std::iterator_traits<
+                              InputIt>::iterator_category>)
+        {
+            migrate_buffer_.reserve(
+                static_cast<std::size_t>(std::distance(first, last)));
+        }
+
+        for (; first != last; ++first)
+        {
+            const entity_type& ent = *first;
+            auto*              loc = container_.entities().find(ent);
+
+            if (loc && filter(container_.group_of(*loc->group)))
+            {
+                migrate_buffer_.push_back(
+                    migrate_entry{loc->group, loc->row, ent});
+            }
+        }
+
+        // entities gathered by iterating groups are already in order
+        if (!std::is_sorted(migrate_buffer_.begin(), migrate_buffer_.end()))
+        {
+            std::sort(migrate_buffer_.begin(), migrate_buffer_.end());
+        }
+
+        migrate_buffer_.erase(
+            std::unique(migrate_buffer_.begin(), migrate_buffer_.end()),
+            migrate_buffer_.end());
+    }
+
+    /// invoke fn with every range of migrate_buffer_ sharing the same group
+    template<typename F>
+    void for_each_group_run(F fn)
+    {
+        for (auto run_first = migrate_buffer_.begin();
+             run_first != migrate_buffer_.end();)
+        {
+            auto* meta     = run_first->group;
+            auto  run_last = std::find_if(
+                run_first, migrate_buffer_.end(), [meta](const auto& entry) {
+                    return entry.group != meta;
+                });
+
+            fn(run_first, run_last);
+
+            run_first = run_last;
+        }
+    }
+
+    /// move every alive entity in [first, last) for whose group `filter`
+    /// returns true to the group returned by `find_dst`. Entities from the
+    /// same group are swapped to its tail and moved in one go, `finish` then
+    /// receives the destination and the number of moved rows.
+    template<typename InputIt,
+             typename Filter,
+             typename FindDst,
+             typename Finish>
+    void migrate(InputIt first,
+                 InputIt last,
+                 Filter  filter,
+                 FindDst find_dst,
+                 Finish  finish)
+    {
+        MATTER_PROFILE_SCOPE(migrate_scope, "structure", "migrate");
+
+        sort_by_group(first, last, filter);
+
+        MATTER_PROFILE_ARG(migrate_scope, "rows", migrate_buffer_.size());
+
+        for_each_group_run([&](auto run_first, auto run_last) {
+            auto count = static_cast<std::size_t>(run_last - run_first);
+
+            // gather the rows at the tail of the source group
+            auto src  = container_.group_of(*run_first->group);
+            auto tail = src.size();
+            for (auto it = run_first; it != run_last; ++it)
+            {
+                src.swap_rows(container_.entities().find(it->ent)->row,
+                              --tail);
+            }
+
+            auto dst = find_dst(src);
+            src.transfer_back(dst, count);
+            finish(dst, count);
+        });
     }
 
     template<typename... Ts>
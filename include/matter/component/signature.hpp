@@ -0,0 +1,175 @@
+#ifndef MATTER_COMPONENT_SIGNATURE_HPP
+#define MATTER_COMPONENT_SIGNATURE_HPP
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "matter/id/id.hpp"
+
+namespace matter
+{
+/// the number of component ids told apart by a signature without collisions
+constexpr std::size_t signature_bits = 256;
+
+/// \brief a fixed width set of component ids
+/// Every id sets the bit of its value modulo `signature_bits`, ids past the
+/// width share bits with lower ones. Such a signature is inexact, a set bit
+/// then only means one of the ids mapping to it may be present. A cleared bit
+/// always means none of them is.
+/// Comparisons work word by word over a fixed number of words, which compilers
+/// unroll and vectorize.
+class component_signature {
+public:
+    using word_type = std::uint64_t;
+
+    static constexpr std::size_t word_bits  = 64;
+    static constexpr std::size_t word_count = signature_bits / word_bits;
+
+    static_assert(signature_bits % word_bits == 0);
+
+private:
+    std::array<word_type, word_count> words_{};
+    bool                              exact_{true};
+
+public:
+    constexpr component_signature() noexcept = default;
+
+    template<typename Id>
+    constexpr void insert(const Id& id) noexcept
+    {
+        static_assert(matter::is_id_v<Id>);
+
+        auto bit = static_cast<std::size_t>(id.value());
+        exact_   = exact_ && bit < signature_bits;
+        bit %= signature_bits;
+
+        words_[bit / word_bits] |= word_type{1} << (bit % word_bits);
+    }
+
+    /// whether every set bit stands for a single id
+    constexpr bool exact() const noexcept
+    {
+        return exact_;
+    }
+
+    constexpr bool empty() const noexcept
+    {
+        word_type any = 0;
+        for (std::size_t i = 0; i < word_count; ++i)
+        {
+            any |= words_[i];
+        }
+        return any == 0;
+    }
+
+    /// whether every bit of other is set in this
+    constexpr bool includes(const component_signature& other) const noexcept
+    {
+        word_type missing = 0;
+        for (std::size_t i = 0; i < word_count; ++i)
+        {
+            missing |= other.words_[i] & ~words_[i];
+        }
+        return missing == 0;
+    }
+
+    /// whether any bit is set in both this and other
+    constexpr bool intersects(const component_signature& other) const noexcept
+    {
+        word_type shared = 0;
+        for (std::size_t i = 0; i < word_count; ++i)
+        {
+            shared |= other.words_[i] & words_[i];
+        }
+        return shared != 0;
+    }
+
+    constexpr bool operator==(const component_signature& other) const noexcept
+    {
+        for (std::size_t i = 0; i < word_count; ++i)
+        {
+            if (words_[i] != other.words_[i])
+            {
+                return false;
+            }
+        }
+        return exact_ == other.exact_;
+    }
+
+    constexpr bool operator!=(const component_signature& other) const noexcept
+    {
+        return !(*this == other);
+    }
+};
+
+/// the outcome of matching a group by signature, see `signature_mask`
+enum struct signature_match
+{
+    /// the group can't match, none of its stores need to be looked at
+    reject,
+    /// the group matches
+    accept,
+    /// the signatures weren't exact, the stores of the group decide
+    maybe
+};
+
+/// \brief the components a query requires and excludes as signatures
+/// Groups are matched by comparing their signature to both masks, which
+/// rejects most groups with a handful of word operations.
+class signature_mask {
+private:
+    component_signature require_;
+    component_signature exclude_;
+
+public:
+    constexpr signature_mask() noexcept = default;
+
+    template<typename Id>
+    constexpr void require(const Id& id) noexcept
+    {
+        require_.insert(id);
+    }
+
+    template<typename Id>
+    constexpr void exclude(const Id& id) noexcept
+    {
+        exclude_.insert(id);
+    }
+
+    constexpr const component_signature& required() const noexcept
+    {
+        return require_;
+    }
+
+    constexpr const component_signature& excluded() const noexcept
+    {
+        return exclude_;
+    }
+
+    /// match the signature of a group against the masks
+    constexpr signature_match
+    match(const component_signature& group_signature) const noexcept
+    {
+        if (!group_signature.includes(require_))
+        {
+            return signature_match::reject;
+        }
+
+        if (group_signature.intersects(exclude_))
+        {
+            return group_signature.exact() && exclude_.exact()
+                       ? signature_match::reject
+                       : signature_match::maybe;
+        }
+
+        return group_signature.exact() && require_.exact()
+                   ? signature_match::accept
+                   : signature_match::maybe;
+    }
+};
+} // namespace matter
+
+#endif
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <memory_resource>
 #include <tuple>
 #include <type_traits>
 #include <vector>
@@ -12,6 +13,10 @@
 #include <nameof.hpp>
 
 #include "matter/container/soa.hpp"
+#include "matter/storage/aligned_vector.hpp"
+#include "matter/storage/chunked_storage.hpp"
+#include "matter/storage/empty_storage.hpp"
+#include "matter/storage/shared_storage.hpp"
 #include "matter/util/meta.hpp"
 
 namespace matter
@@ -225,10 +230,39 @@ struct component_name<Component,
 template<typename Component>
 constexpr auto component_name_v = component_name<Component>::value;
 
+/// \brief the storage of components which don't define `storage_type`
+/// This is `std::pmr::vector` unless `MATTER_DEFAULT_CHUNKED_STORAGE` is
+/// defined, in which case all these components are stored in
+/// `chunked_storage`. Both allocate from the memory resource of the registry.
+/// Empty components are counted by an `empty_storage` instead, which never
+/// allocates.
+template<typename Component, typename = void>
+struct default_component_storage
+{
+#ifdef MATTER_DEFAULT_CHUNKED_STORAGE
+    using type = matter::chunked_storage<Component>;
+#else
+    using type = std::pmr::vector<Component>;
+#endif
+};
+
+template<typename Component>
+struct default_component_storage<
+    Component,
+    std::enable_if_t<is_component_empty_v<Component> &&
+                     std::is_copy_constructible_v<Component>>>
+{
+    using type = matter::empty_storage<Component>;
+};
+
+template<typename Component>
+using default_component_storage_t =
+    typename default_component_storage<Component>::type;
+
 template<typename Component, typename = void>
 struct component_storage
 {
-    using type = std::vector<Component>;
+    using type = matter::default_component_storage_t<Component>;
 };
 
 template<typename Component>
@@ -242,6 +276,26 @@ struct component_storage<
 template<typename Component>
 using component_storage_t = typename component_storage<Component>::type;
 
+/// \brief whether a single value of the component is shared by every entity
+/// of a group
+/// Shared components define `shared_storage` as their `storage_type`. Entities
+/// with different values of them end up in different groups.
+template<typename Component>
+struct is_component_shared
+    : detail::is_specialization_of<component_storage_t<Component>,
+                                   matter::shared_storage>
+{};
+
+template<typename Component>
+constexpr bool is_component_shared_v = is_component_shared<Component>::value;
+
+/// the type an entity's component is handed out as, shared components are
+/// const as their value may only change through `registry::set_shared`
+template<typename Component>
+using component_access_t = std::conditional_t<is_component_shared_v<Component>,
+                                              const Component,
+                                              Component>;
+
 template<typename... Components>
 constexpr auto make_component_soa()
 {
@@ -3,10 +3,43 @@
 
 #pragma once
 
+#include <array>
 #include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/hana/type.hpp>
+
+#include "matter/id/component_identifier.hpp"
+#include "matter/query/component_query_description.hpp"
+#include "matter/query/runtime_entities.hpp"
+#include "matter/query/type_traits.hpp"
+#include "matter/system/job.hpp"
+#include "matter/system/world_compiler.hpp"
+#include "matter/util/profiler.hpp"
+#include "matter/util/task_graph.hpp"
+#include "matter/util/thread_pool.hpp"
 
 namespace matter
 {
+namespace detail
+{
+// jobs running concurrently can't register components, so every component
+// queried has to be known to the world beforehand
+template<typename T, typename World>
+void ensure_registered(World& w)
+{
+    if constexpr (matter::is_dynamic_component_identifier_v<World>)
+    {
+        if (!w.template contains_component<T>())
+        {
+            w.template register_component<T>();
+        }
+    }
+}
+} // namespace detail
+
 template<typename World, typename... Systems>
 class dispatcher {
 private:
@@ -24,6 +57,272 @@ public:
                    systems_);
     }
 };
+
+/// \brief runs jobs concurrently unless their queries conflict
+/// On construction the queries of every job are described with
+/// `component_query_description`, two jobs conflict when any of their
+/// descriptions can't access concurrently. Conflicting jobs run in the order
+/// they were passed in, all other jobs may run at the same time on a
+/// `thread_pool`. The conflict graph is built once, invoking the dispatcher
+/// only walks it.
+/// Components used by the queries get registered to a world with a dynamic
+/// identifier. A `runtime_entities` query is described by its own
+/// descriptions, queries other than entity queries conflict with every job.
+template<typename World, typename... Jobs>
+class parallel_dispatcher {
+public:
+    using id_type = typename World::id_type;
+
+private:
+    using description_type = matter::component_query_description<id_type>;
+
+    // the descriptions of all queries of a job, exclusive when they can't be
+    // described
+    struct job_description
+    {
+        std::vector<description_type> queries;
+        bool                          exclusive{false};
+    };
+
+    World*              world_;
+    std::tuple<Jobs...> jobs_;
+    matter::task_graph  graph_;
+
+public:
+    parallel_dispatcher(World& w, Jobs&&... jobs)
+        : world_{std::addressof(w)}, jobs_{std::move(jobs)...},
+          graph_{build_graph(w, jobs_)}
+    {}
+
+    /// the dependencies between the jobs, indexed in the order they were
+    /// passed in
+    const matter::task_graph& graph() const noexcept
+    {
+        return graph_;
+    }
+
+    /// run every job once on the default thread pool
+    void operator()()
+    {
+        (*this)(matter::thread_pool::default_pool());
+    }
+
+    /// run every job once on pool
+    void operator()(matter::thread_pool& pool)
+    {
+        constexpr auto invokers =
+            make_invokers(std::index_sequence_for<Jobs...>{});
+
+        MATTER_PROFILE_SCOPE(dispatch_scope, "dispatcher", "dispatch");
+        MATTER_PROFILE_ARG(dispatch_scope, "jobs", sizeof...(Jobs));
+
+        graph_.run(pool, [&](std::size_t job) { invokers[job](*this); });
+    }
+
+private:
+    template<std::size_t... Is>
+    static constexpr auto make_invokers(std::index_sequence<Is...>) noexcept
+    {
+        return std::array<void (*)(parallel_dispatcher&), sizeof...(Is)>{
+            [](parallel_dispatcher& disp) {
+                matter::invoke_job(std::get<Is>(disp.jobs_), *disp.world_);
+            }...};
+    }
+
+    template<typename T, typename Access, typename Presence>
+    static void describe(
+        World&                                                           w,
+        boost::hana::basic_type<matter::type_query<T, Access, Presence>> tq,
+        std::vector<description_type>&                                   out)
+    {
+        matter::detail::ensure_registered<T>(w);
+        out.emplace_back(w, tq);
+    }
+
+    template<typename... TypeQueries>
+    static void describe(World& w,
+                         std::tuple<TypeQueries...>*,
+                         std::vector<description_type>& out)
+    {
+        (describe(w, boost::hana::type_c<TypeQueries>, out), ...);
+    }
+
+    template<typename Job>
+    static job_description describe_job(World& w, Job& job)
+    {
+        job_description descr;
+
+        std::apply(
+            [&](auto&... queries) {
+                auto describe_query = [&](auto& query) {
+                    using query_type = std::decay_t<decltype(query)>;
+
+                    if constexpr (matter::is_runtime_query_v<query_type>)
+                    {
+                        static_assert(
+                            std::is_same_v<typename query_type::id_type,
+                                           id_type>,
+                            "The runtime query must use the ids of the world");
+                        for (const auto& qd : query.descriptions())
+                        {
+                            descr.queries.push_back(qd);
+                        }
+                    }
+                    else if constexpr (matter::traits::is_entity_query(
+                                           boost::hana::type_c<query_type>))
+                    {
+                        describe(w,
+                                 static_cast<typename query_type::query_types*>(
+                                     nullptr),
+                                 descr.queries);
+                    }
+                    else
+                    {
+                        descr.exclusive = true;
+                    }
+                };
+
+                (describe_query(queries), ...);
+            },
+            job.queries());
+
+        return descr;
+    }
+
+    static bool conflicts(const job_description& lhs,
+                          const job_description& rhs) noexcept
+    {
+        if (lhs.exclusive || rhs.exclusive)
+        {
+            return true;
+        }
+
+        for (const auto& l : lhs.queries)
+        {
+            for (const auto& r : rhs.queries)
+            {
+                if (!l.can_access_concurrent(r))
+                {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    static matter::task_graph build_graph(World& w, std::tuple<Jobs...>& jobs)
+    {
+        auto descriptions = std::apply(
+            [&](auto&... js) {
+                return std::array<job_description, sizeof...(Jobs)>{
+                    describe_job(w, js)...};
+            },
+            jobs);
+
+        auto graph = matter::task_graph{sizeof...(Jobs)};
+
+        for (std::size_t after = 0; after < sizeof...(Jobs); ++after)
+        {
+            for (std::size_t before = 0; before < after; ++before)
+            {
+                if (conflicts(descriptions[before], descriptions[after]))
+                {
+                    graph.add_dependency(before, after);
+                }
+            }
+        }
+
+        return graph;
+    }
+};
+
+/// \brief runs jobs stage by stage, following a plan made at compile time
+/// The jobs are split into stages by `matter::make_stage_plan`, the jobs of a
+/// stage run concurrently on a `thread_pool` and each stage waits for the one
+/// before it. Unlike `parallel_dispatcher` nothing is built at runtime and
+/// running the jobs doesn't allocate, in turn a job waits for the whole stage
+/// before it rather than only the jobs it conflicts with.
+/// Components used by the queries get registered to a world with a dynamic
+/// identifier.
+template<typename World, typename... Jobs>
+class staged_dispatcher {
+public:
+    static constexpr auto plan = matter::make_stage_plan<Jobs...>();
+
+private:
+    World*              world_;
+    std::tuple<Jobs...> jobs_;
+
+public:
+    staged_dispatcher(World& w, Jobs&&... jobs)
+        : world_{std::addressof(w)}, jobs_{std::move(jobs)...}
+    {
+        auto register_job = [&](auto& job) {
+            std::apply(
+                [&](auto&... queries) { (register_query(queries), ...); },
+                job.queries());
+        };
+
+        std::apply([&](auto&... js) { (register_job(js), ...); }, jobs_);
+    }
+
+    /// run every job once on the default thread pool
+    void operator()()
+    {
+        (*this)(matter::thread_pool::default_pool());
+    }
+
+    /// run every job once on pool
+    void operator()(matter::thread_pool& pool)
+    {
+        constexpr auto invokers =
+            make_invokers(std::index_sequence_for<Jobs...>{});
+
+        for (std::size_t stage = 0; stage < plan.stage_count; ++stage)
+        {
+            MATTER_PROFILE_SCOPE(stage_scope, "dispatcher", "stage");
+            MATTER_PROFILE_ARG(stage_scope, "stage", stage);
+            MATTER_PROFILE_ARG(stage_scope, "jobs", plan.stage_size(stage));
+
+            pool.parallel_for(plan.stage_size(stage), [&](std::size_t i) {
+                invokers[plan.job(stage, i)](*this);
+            });
+        }
+    }
+
+private:
+    template<std::size_t... Is>
+    static constexpr auto make_invokers(std::index_sequence<Is...>) noexcept
+    {
+        return std::array<void (*)(staged_dispatcher&), sizeof...(Is)>{
+            [](staged_dispatcher& disp) {
+                matter::invoke_job(std::get<Is>(disp.jobs_), *disp.world_);
+            }...};
+    }
+
+    template<typename... TypeQueries>
+    void register_components(std::tuple<TypeQueries...>*)
+    {
+        (matter::detail::ensure_registered<typename TypeQueries::element_type>(
+             *world_),
+         ...);
+    }
+
+    // the components of a runtime query are known by id, so they are
+    // registered already
+    template<typename Query>
+    void register_query(Query&)
+    {
+        if constexpr (!matter::is_runtime_query_v<Query> &&
+                      matter::traits::is_entity_query(
+                          boost::hana::type_c<Query>))
+        {
+            register_components(
+                static_cast<typename Query::query_types*>(nullptr));
+        }
+    }
+};
 } // namespace matter
 
 #endif
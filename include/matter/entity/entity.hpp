@@ -0,0 +1,91 @@
+#ifndef MATTER_ENTITY_ENTITY_HPP
+#define MATTER_ENTITY_ENTITY_HPP
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+
+namespace matter
+{
+/// \brief a generational handle to an entity
+/// The index refers to a slot in the `entity_table` while the generation is
+/// used to detect stale handles. Every time an entity gets destroyed the
+/// generation of its slot is incremented, so a handle to a destroyed entity
+/// never resolves to an entity which later reuses the same slot.
+class entity {
+public:
+    using index_type      = std::uint32_t;
+    using generation_type = std::uint32_t;
+
+    static constexpr index_type invalid_index =
+        std::numeric_limits<index_type>::max();
+
+private:
+    index_type      index_{invalid_index};
+    generation_type generation_{0};
+
+public:
+    constexpr entity() noexcept = default;
+
+    constexpr entity(index_type index, generation_type generation) noexcept
+        : index_{index}, generation_{generation}
+    {}
+
+    constexpr index_type index() const noexcept
+    {
+        return index_;
+    }
+
+    constexpr generation_type generation() const noexcept
+    {
+        return generation_;
+    }
+
+    /// whether this handle was ever assigned, says nothing about whether the
+    /// entity is still alive.
+    constexpr explicit operator bool() const noexcept
+    {
+        return index_ != invalid_index;
+    }
+
+    constexpr bool operator==(const entity& other) const noexcept
+    {
+        return index() == other.index() && generation() == other.generation();
+    }
+
+    constexpr bool operator!=(const entity& other) const noexcept
+    {
+        return !(*this == other);
+    }
+
+    constexpr bool operator<(const entity& other) const noexcept
+    {
+        return index() < other.index() ||
+               (index() == other.index() && generation() < other.generation());
+    }
+
+    friend void swap(entity& lhs, entity& rhs) noexcept
+    {
+        using std::swap;
+        swap(lhs.index_, rhs.index_);
+        swap(lhs.generation_, rhs.generation_);
+    }
+};
+} // namespace matter
+
+namespace std
+{
+template<>
+struct hash<matter::entity>
+{
+    std::size_t operator()(const matter::entity& ent) const noexcept
+    {
+        return (static_cast<std::size_t>(ent.generation()) << 32) ^
+               static_cast<std::size_t>(ent.index());
+    }
+};
+} // namespace std
+
+#endif
@@ -0,0 +1,160 @@
+#ifndef MATTER_ENTITY_ENTITY_TABLE_HPP
+#define MATTER_ENTITY_ENTITY_TABLE_HPP
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+#include "matter/entity/entity.hpp"
+
+namespace matter
+{
+/// \brief maps entity handles to the group and row they currently reside in
+/// The table is dense, the index of an entity is the index of its slot. Slots
+/// of destroyed entities are recycled through a free list, their generation is
+/// bumped upon release so stale handles can be detected in O(1).
+/// `Group` is the type identifying a group, the table only stores a pointer to
+/// it and never dereferences it.
+template<typename Group>
+class entity_table {
+public:
+    using group_type = Group;
+    using size_type  = std::size_t;
+
+    struct location
+    {
+        group_type* group{nullptr};
+        size_type   row{0};
+    };
+
+private:
+    struct slot
+    {
+        entity::generation_type generation{0};
+        location                loc{};
+    };
+
+    std::pmr::vector<slot>               slots_;
+    std::pmr::vector<entity::index_type> free_;
+
+public:
+    entity_table() noexcept = default;
+
+    explicit entity_table(std::pmr::memory_resource* resource) noexcept
+        : slots_{resource}, free_{resource}
+    {}
+
+    /// number of currently alive entities
+    size_type size() const noexcept
+    {
+        return slots_.size() - free_.size();
+    }
+
+    bool empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+    /// number of slots ever allocated, alive or not
+    size_type capacity() const noexcept
+    {
+        return slots_.size();
+    }
+
+    void reserve(size_type new_capacity)
+    {
+        slots_.reserve(new_capacity);
+        free_.reserve(slots_.capacity());
+    }
+
+    /// make room for count more handles, so creating them doesn't reallocate
+    /// in between
+    void reserve_more(size_type count)
+    {
+        auto fresh    = count > free_.size() ? count - free_.size() : 0;
+        auto required = slots_.size() + fresh;
+
+        if (required > slots_.capacity())
+        {
+            reserve(std::max(required, 2 * slots_.capacity()));
+        }
+    }
+
+    /// allocate a new handle located at the given group and row
+    entity create(group_type* grp, size_type row)
+    {
+        if (!free_.empty())
+        {
+            auto idx = free_.back();
+            free_.pop_back();
+
+            auto& s = slots_[idx];
+            s.loc   = location{grp, row};
+            return entity{idx, s.generation};
+        }
+
+        auto idx = static_cast<entity::index_type>(slots_.size());
+        assert(idx != entity::invalid_index);
+
+        // the free list always has room for every slot, so release never
+        // allocates
+        if (slots_.size() == slots_.capacity())
+        {
+            reserve(std::max(size_type{1}, 2 * slots_.capacity()));
+        }
+
+        slots_.push_back(slot{0, location{grp, row}});
+
+        return entity{idx, 0};
+    }
+
+    /// invalidate the handle, its slot can now be reused
+    void release(const entity& ent) noexcept
+    {
+        assert(contains(ent));
+
+        auto& s = slots_[ent.index()];
+        ++s.generation;
+        s.loc = location{};
+        free_.push_back(ent.index());
+    }
+
+    bool contains(const entity& ent) const noexcept
+    {
+        return ent.index() < slots_.size() &&
+               slots_[ent.index()].generation == ent.generation() &&
+               slots_[ent.index()].loc.group != nullptr;
+    }
+
+    /// returns nullptr if the entity is no longer alive
+    const location* find(const entity& ent) const noexcept
+    {
+        if (!contains(ent))
+        {
+            return nullptr;
+        }
+
+        return std::addressof(slots_[ent.index()].loc);
+    }
+
+    /// the entity changed row within its group, this happens upon swap and pop
+    void relocate(const entity& ent, size_type row) noexcept
+    {
+        assert(contains(ent));
+        slots_[ent.index()].loc.row = row;
+    }
+
+    /// the entity moved to another group
+    void relocate(const entity& ent, group_type* grp, size_type row) noexcept
+    {
+        assert(contains(ent));
+        slots_[ent.index()].loc = location{grp, row};
+    }
+};
+} // namespace matter
+
+#endif
@@ -35,8 +35,9 @@ public:
         assert(std::adjacent_find(ids, ids_ + size) == (ids_ + size));
     }
 
+    template<typename Allocator>
     explicit constexpr ordered_untyped_ids(
-        const std::vector<id_type>& ids) noexcept
+        const std::vector<id_type, Allocator>& ids) noexcept
         : ordered_untyped_ids{ids.data(), ids.size()}
     {
         // the main constructor asserts for us
@@ -160,7 +161,30 @@ public:
 
     constexpr bool contains(matter::ordered_untyped_ids<Id> other) const
         noexcept
-    {}
+    {
+        return std::includes(begin(), end(), other.begin(), other.end());
+    }
+};
+
+/// hashes the ids as a whole, the ids being ordered means equal sets of ids
+/// always produce the same hash.
+template<typename Id>
+struct ordered_untyped_ids_hash
+{
+    constexpr std::size_t operator()(const ordered_untyped_ids<Id>& ids) const
+        noexcept
+    {
+        // FNV-1a over the id values
+        std::size_t hash = 14695981039346656037ull;
+
+        for (const auto& id : ids)
+        {
+            hash ^= static_cast<std::size_t>(id.value());
+            hash *= 1099511628211ull;
+        }
+
+        return hash;
+    }
 };
 } // namespace matter
 
@@ -0,0 +1,230 @@
+#ifndef MATTER_QUERY_CACHED_ENTITIES_HPP
+#define MATTER_QUERY_CACHED_ENTITIES_HPP
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/hana/type.hpp>
+
+#include "matter/component/traits.hpp"
+#include "matter/query/category.hpp"
+#include "matter/query/entities.hpp"
+#include "matter/query/primitives/filter.hpp"
+#include "matter/query/type_query.hpp"
+
+namespace matter
+{
+namespace detail
+{
+// what `filter_group` returns for a single type query of a matching group
+template<typename TypeQuery>
+using type_query_result_t = matter::detail::filter_result_t<decltype(
+    *std::declval<std::invoke_result_t<
+        typename TypeQuery::presence_type::storage_filter,
+        std::invoke_result_t<typename TypeQuery::access_type::storage_modifier,
+                             matter::component_storage_t<
+                                 typename TypeQuery::element_type>*>>>())>;
+} // namespace detail
+
+/// \brief an entity query remembering the groups it matches
+/// Groups are never removed from a world and new ones are appended, so the
+/// query only filters the groups created since it was last processed. The
+/// result of every matching group is kept, processing the query afterwards
+/// costs O(matching groups) no matter how many groups the world holds.
+/// Processing yields the same per group results as `entities`, but as a
+/// vector owned by the query which stays valid until the query is processed
+/// again. The cache is rebuilt when the query is processed with another world,
+/// or with a world which was assigned to since.
+template<typename... TypeAccess>
+class cached_entities;
+
+template<typename... Ts, typename... Access, typename... Presence>
+class cached_entities<matter::type_query<Ts, Access, Presence>...>
+    : public matter::detail::query_version<
+          (std::is_same_v<Presence, matter::prim::changed> || ...)> {
+public:
+    using query_category = matter::entity_query_tag;
+    using query_types = std::tuple<matter::type_query<Ts, Access, Presence>...>;
+
+    using result_type = std::tuple<matter::detail::type_query_result_t<
+        matter::type_query<Ts, Access, Presence>>...>;
+
+private:
+    static constexpr bool filters_changes =
+        (std::is_same_v<Presence, matter::prim::changed> || ...);
+    static constexpr bool writes =
+        ((Access::access_enum() == matter::access::write) || ...);
+
+    // the version of each column of a matched group, nullptr for columns the
+    // group doesn't have
+    using versions_type = std::array<std::uint64_t*, sizeof...(Ts)>;
+    using indices       = std::index_sequence_for<Ts...>;
+
+    std::uint64_t              source_{0};
+    std::size_t                seen_{0};
+    std::vector<result_type>   results_;
+    std::vector<versions_type> versions_;
+    // the results passing the change filters
+    std::vector<result_type> changed_;
+
+public:
+    constexpr cached_entities() noexcept = default;
+    constexpr cached_entities(
+        boost::hana::basic_type<
+            matter::type_query<Ts, Access, Presence>>...) noexcept
+    {}
+
+    /// the number of groups matched so far
+    std::size_t size() const noexcept
+    {
+        return results_.size();
+    }
+
+    /// filter the groups of group_rng created since the last call and
+    /// return the results of all matching groups, see `process_query`.
+    template<typename Range, typename Identifier>
+    const std::vector<result_type>&
+    update(Range&&                       group_rng,
+           const Identifier&             ident,
+           const matter::query_versions& versions)
+    {
+        // keyed on the instance rather than the address, a world assigned to
+        // or rebuilt in place keeps its address but frees the old groups
+        if (source_ != ident.instance())
+        {
+            source_ = ident.instance();
+            seen_   = 0;
+            results_.clear();
+            versions_.clear();
+        }
+
+        auto first = std::begin(group_rng);
+        auto last  = std::end(group_rng);
+        auto count = static_cast<std::size_t>(std::distance(first, last));
+
+        std::advance(first, seen_);
+        for (; first != last; ++first)
+        {
+            add_if_matching(*first, ident);
+        }
+        seen_ = count;
+
+        if constexpr (!filters_changes && !writes)
+        {
+            return results_;
+        }
+        else
+        {
+            changed_.clear();
+
+            for (std::size_t i = 0; i < results_.size(); ++i)
+            {
+                if (!is_changed(versions_[i], versions.since, indices{}))
+                {
+                    continue;
+                }
+
+                if (versions.now != 0)
+                {
+                    mark_changed(versions_[i], versions.now, indices{});
+                }
+
+                if constexpr (filters_changes)
+                {
+                    changed_.push_back(results_[i]);
+                }
+            }
+
+            return filters_changes ? changed_ : results_;
+        }
+    }
+
+private:
+    template<typename Group, typename Identifier>
+    void add_if_matching(Group grp, const Identifier& ident)
+    {
+        using boost::hana::type_c;
+
+        auto res = matter::filter_group(
+            grp,
+            ident,
+            matter::query_signature_mask(
+                ident, type_c<matter::type_query<Ts, Access, Presence>>...),
+            matter::query_versions{},
+            type_c<matter::type_query<Ts, Access, Presence>>...);
+
+        if (!res)
+        {
+            return;
+        }
+
+        results_.emplace_back(*std::move(res));
+
+        auto* meta       = grp.metadata();
+        auto  version_of = [&](const auto& id) -> std::uint64_t* {
+            auto* store = grp.find_id(id);
+            return meta && store ? meta->versions() + (store - grp.data())
+                                 : nullptr;
+        };
+
+        versions_.push_back(
+            versions_type{version_of(ident.template component_id<Ts>())...});
+    }
+
+    template<std::size_t... Is>
+    static bool is_changed(const versions_type& versions,
+                           std::uint64_t        since,
+                           std::index_sequence<Is...>) noexcept
+    {
+        return ((!std::is_same_v<Presence, matter::prim::changed> ||
+                 (versions[Is] && *versions[Is] > since)) &&
+                ...);
+    }
+
+    template<std::size_t... Is>
+    static void mark_changed(const versions_type& versions,
+                             std::uint64_t        now,
+                             std::index_sequence<Is...>) noexcept
+    {
+        auto mark = [&](auto access_type, std::uint64_t* version) {
+            if constexpr (decltype(access_type)::type::access_enum() ==
+                          matter::access::write)
+            {
+                if (version)
+                {
+                    *version = now;
+                }
+            }
+        };
+
+        (mark(boost::hana::type_c<Access>, versions[Is]), ...);
+    }
+};
+
+template<typename... Ts, typename... Access, typename... Presence>
+cached_entities(boost::hana::basic_type<
+                matter::type_query<Ts, Access, Presence>>...) noexcept
+    ->cached_entities<matter::type_query<Ts, Access, Presence>...>;
+
+template<typename T>
+struct is_cached_query : std::false_type
+{};
+
+template<typename... TypeQueries>
+struct is_cached_query<matter::cached_entities<TypeQueries...>>
+    : std::true_type
+{};
+
+template<typename T>
+constexpr bool is_cached_query_v = is_cached_query<T>::value;
+} // namespace matter
+
+#endif
@@ -3,17 +3,52 @@
 
 #pragma once
 
+#include <cstdint>
+#include <type_traits>
+
 #include "matter/query/category.hpp"
 #include "matter/query/type_query.hpp"
 #include "matter/util/filter_transform.hpp"
 
 namespace matter
 {
+namespace detail
+{
+// queries filtering for changes remember the version they were processed with
+template<bool TracksChanges>
+class query_version {
+public:
+    static constexpr bool tracks_changes = false;
+};
+
+template<>
+class query_version<true> {
+private:
+    std::uint64_t last_{0};
+
+public:
+    static constexpr bool tracks_changes = true;
+
+    /// the version this query was processed with the last time
+    constexpr std::uint64_t last_version() const noexcept
+    {
+        return last_;
+    }
+
+    constexpr void last_version(std::uint64_t version) noexcept
+    {
+        last_ = version;
+    }
+};
+} // namespace detail
+
 template<typename... TypeAccess>
 class entities;
 
 template<typename... Ts, typename... Access, typename... Presence>
-class entities<matter::type_query<Ts, Access, Presence>...> {
+class entities<matter::type_query<Ts, Access, Presence>...>
+    : public matter::detail::query_version<
+          (std::is_same_v<Presence, matter::prim::changed> || ...)> {
 public:
     using query_category = matter::entity_query_tag;
     using query_types = std::tuple<matter::type_query<Ts, Access, Presence>...>;
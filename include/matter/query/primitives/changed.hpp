@@ -0,0 +1,27 @@
+#ifndef MATTER_QUERY_PRIMITIVES_CHANGED_HPP
+#define MATTER_QUERY_PRIMITIVES_CHANGED_HPP
+
+#pragma once
+
+#include "matter/query/primitives/require.hpp"
+#include "matter/query/runtime.hpp"
+
+namespace matter
+{
+namespace prim
+{
+/// requires the component like `require`, additionally `filter_group` skips
+/// groups whose column didn't change since the query was processed last.
+struct changed
+{
+    using storage_filter = matter::prim::require::storage_filter;
+
+    static constexpr matter::presence presence_enum() noexcept
+    {
+        return presence::require;
+    }
+};
+} // namespace prim
+} // namespace matter
+
+#endif
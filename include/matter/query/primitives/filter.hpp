@@ -3,16 +3,38 @@
 
 #pragma once
 
+#include <cstdint>
+#include <type_traits>
+
 #include "matter/component/any_group.hpp"
+#include "matter/component/signature.hpp"
 #include "matter/query/component_query_description.hpp"
 #include "matter/query/type_query.hpp"
 
 namespace matter
 {
+namespace detail
+{
+template<typename Result>
+using filter_result_t = std::conditional_t<std::is_lvalue_reference_v<Result>,
+                                           Result,
+                                           std::decay_t<Result>>;
+} // namespace detail
+
+/// the versions a query compares and marks columns with, see `change_clock`
+struct query_versions
+{
+    /// columns marked after this version pass `changed`
+    std::uint64_t since{0};
+    /// the version columns handed out for writing get marked with, 0 marks
+    /// nothing
+    std::uint64_t now{0};
+};
+
 // filter the group for the specified access.
 // this function will return a result of the form
-// std::optional<std::tuple<component_storage<T>, ...>>. Where nullopt means the
-// filtering failed and the group does not qualify.
+// std::optional<std::tuple<component_storage<T>&, ...>>. Where nullopt means
+// the filtering failed and the group does not qualify.
 template<typename Identifier,
          typename... Ts,
          typename... Access,
@@ -20,6 +42,7 @@ template<typename Identifier,
 constexpr auto filter_group(
     matter::any_group<typename Identifier::id_type> grp,
     const Identifier&                               ident,
+    const matter::query_versions&                   versions,
     boost::hana::basic_type<
         matter::type_query<Ts, Access, Presence>>... access_types) noexcept
 {
@@ -56,10 +79,44 @@ constexpr auto filter_group(
     auto success =
         (shortcircuit(ident.template component_id<Ts>(), access_types) && ...);
 
+    // only checked once all storages are known to be present
+    auto is_changed = [&](auto tid, auto access_type) {
+        using presence_type =
+            typename decltype(access_type)::type::presence_type;
+
+        if constexpr (std::is_same_v<presence_type, matter::prim::changed>)
+        {
+            return grp.version(tid) > versions.since;
+        }
+        else
+        {
+            return true;
+        }
+    };
+
+    success = success &&
+              (is_changed(ident.template component_id<Ts>(), access_types) &&
+               ...);
+
+    auto mark_changed = [&](auto tid, auto access_type) {
+        if constexpr (decltype(access_type)::type::access_enum() ==
+                      matter::access::write)
+        {
+            if (versions.now != 0)
+            {
+                grp.mark_changed(tid, versions.now);
+            }
+        }
+    };
+
+    // required storages are returned as reference to the storage of the group,
+    // everything held by value in an optional is moved out.
     auto dereference_results = [](auto&& result) {
         return std::apply(
             [](auto&&... results) {
-                return std::optional{std::make_tuple(*std::move(results)...)};
+                return std::optional{
+                    std::tuple<matter::detail::filter_result_t<decltype(
+                        *std::move(results))>...>{*std::move(results)...}};
             },
             std::move(result));
     };
@@ -68,6 +125,7 @@ constexpr auto filter_group(
 
     if (success)
     {
+        (mark_changed(ident.template component_id<Ts>(), access_types), ...);
         return dereference_results(std::move(results));
     }
     else
@@ -75,7 +133,87 @@ constexpr auto filter_group(
         return optional_type{std::nullopt};
     }
 }
-// TODO: filtering for runtime component access
+
+// filter the group without tracking changes
+template<typename Identifier,
+         typename... Ts,
+         typename... Access,
+         typename... Presence>
+constexpr auto filter_group(
+    matter::any_group<typename Identifier::id_type> grp,
+    const Identifier&                               ident,
+    boost::hana::basic_type<
+        matter::type_query<Ts, Access, Presence>>... access_types) noexcept
+{
+    return matter::filter_group(
+        grp, ident, matter::query_versions{}, access_types...);
+}
+
+/// the components required and excluded by a list of type queries, optional
+/// ones don't affect which groups match.
+template<typename Identifier,
+         typename... Ts,
+         typename... Access,
+         typename... Presence>
+constexpr matter::signature_mask query_signature_mask(
+    const Identifier& ident,
+    boost::hana::basic_type<
+        matter::type_query<Ts, Access, Presence>>...) noexcept
+{
+    auto mask = matter::signature_mask{};
+
+    auto add = [&](const auto& tid, matter::presence pres) {
+        if (pres == matter::presence::require)
+        {
+            mask.require(tid);
+        }
+        else if (pres == matter::presence::exclude)
+        {
+            mask.exclude(tid);
+        }
+    };
+
+    (add(ident.template component_id<Ts>(), Presence::presence_enum()), ...);
+
+    return mask;
+}
+
+/// match the signature of grp against mask, groups not owned by a
+/// `group_container` have no signature and are left to their stores.
+template<typename Id>
+constexpr matter::signature_match
+match_signature(const matter::any_group<Id>& grp,
+                const matter::signature_mask& mask) noexcept
+{
+    auto* meta = grp.metadata();
+    return meta ? mask.match(meta->signature())
+                : matter::signature_match::maybe;
+}
+
+// filter the group after rejecting it by its signature where possible, the
+// mask must be made from the same type queries by `query_signature_mask`.
+template<typename Identifier,
+         typename... Ts,
+         typename... Access,
+         typename... Presence>
+constexpr auto filter_group(
+    matter::any_group<typename Identifier::id_type> grp,
+    const Identifier&                               ident,
+    const matter::signature_mask&                   mask,
+    const matter::query_versions&                   versions,
+    boost::hana::basic_type<
+        matter::type_query<Ts, Access, Presence>>... access_types) noexcept
+{
+    using result_type =
+        decltype(matter::filter_group(grp, ident, versions, access_types...));
+
+    if (matter::match_signature(grp, mask) == matter::signature_match::reject)
+    {
+        return result_type{std::nullopt};
+    }
+
+    return matter::filter_group(grp, ident, versions, access_types...);
+}
 } // namespace matter
 
 #endif
@@ -3,43 +3,229 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <vector>
+
 #include <boost/hana/ext/std/tuple.hpp>
 #include <boost/hana/type.hpp>
+#include <nameof.hpp>
 #include <range/v3/view/transform.hpp>
 
 #include "matter/id/id_cache.hpp"
+#include "matter/query/cached_entities.hpp"
 #include "matter/query/primitives/filter.hpp"
+#include "matter/query/runtime_entities.hpp"
 #include "matter/query/type_traits.hpp"
+#include "matter/storage/chunks.hpp"
+#include "matter/util/algorithm.hpp"
+#include "matter/util/empty.hpp"
 #include "matter/util/meta.hpp"
+#include "matter/util/profiler.hpp"
+#include "matter/util/thread_pool.hpp"
 
 namespace matter
 {
 template<typename EntityQuery, typename Range, typename Identifier>
-constexpr decltype(auto) process_entity_query(EntityQuery&      eq,
-                                              Range&&           rng,
-                                              const Identifier& ident) noexcept
+constexpr decltype(auto)
+process_entity_query(EntityQuery&                  eq,
+                     Range&&                       rng,
+                     const Identifier&             ident,
+                     const matter::query_versions& versions = {}) noexcept
 {
     static_assert(matter::traits::is_entity_query(boost::hana::typeid_(eq)));
 
-    auto query_primitives = decltype(matter::traits::to_hana_tuple_t(
-        std::declval<
-            matter::meta::tuplify_t<typename EntityQuery::query_types>>())){};
-
-    return boost::hana::unpack(query_primitives, [&](auto... query_types) {
-        auto transformed_range =
-            std::forward<Range>(rng) |
-            ranges::view::transform(
-                [         =,
-                 id_cache = matter::id_cache{
-                     ident,
-                     boost::hana::type_c<typename decltype(
-                         query_types)::type::element_type>...}](auto grp) {
-                    return matter::filter_group(grp, id_cache, query_types...);
-                });
-
-        return eq(std::move(transformed_range));
-    });
+    if constexpr (matter::is_cached_query_v<EntityQuery> ||
+                  matter::is_runtime_query_v<EntityQuery>)
+    {
+        return eq.update(std::forward<Range>(rng), ident, versions);
+    }
+    else
+    {
+        using query_types_type =
+            matter::meta::tuplify_t<typename EntityQuery::query_types>;
+
+        auto query_primitives = decltype(matter::traits::to_hana_tuple_t(
+            std::declval<query_types_type>())){};
+
+        return boost::hana::unpack(query_primitives, [&](auto... query_types) {
+            auto transformed_range =
+                std::forward<Range>(rng) |
+                ranges::view::transform(
+                    [         =,
+                     id_cache = matter::id_cache{
+                         ident,
+                         boost::hana::type_c<typename decltype(
+                             query_types)::type::element_type>...},
+                     mask = matter::query_signature_mask(
+                         ident, query_types...)](auto grp) {
+                        return matter::filter_group(
+                            grp, id_cache, mask, versions, query_types...);
+                    });
+
+            return eq(std::move(transformed_range));
+        });
+    }
+}
+
+namespace detail
+{
+template<typename World, typename = void>
+struct has_change_clock : std::false_type
+{};
+
+template<typename World>
+struct has_change_clock<
+    World,
+    std::void_t<decltype(std::declval<World&>().advance_version())>>
+    : std::true_type
+{};
+
+template<typename... Ts, typename... Access, typename... Presence>
+constexpr bool uses_versions(
+    std::tuple<matter::type_query<Ts, Access, Presence>...>*) noexcept
+{
+    return ((Access::access_enum() == matter::access::write ||
+             std::is_same_v<Presence, matter::prim::changed>) ||
+            ...);
+}
+
+// queries writing or looking for changes take a new version from worlds
+// tracking changes
+template<typename EntityQuery, typename World>
+matter::query_versions entity_query_versions(EntityQuery& eq, World& w)
+{
+    if constexpr (matter::is_runtime_query_v<EntityQuery>)
+    {
+        if constexpr (has_change_clock<World>::value)
+        {
+            if (eq.writes())
+            {
+                return matter::query_versions{0, w.advance_version()};
+            }
+        }
+
+        return matter::query_versions{};
+    }
+    else if constexpr (has_change_clock<World>::value &&
+                  uses_versions(
+                      static_cast<typename EntityQuery::query_types*>(nullptr)))
+    {
+        auto versions = matter::query_versions{0, w.advance_version()};
+
+        if constexpr (EntityQuery::tracks_changes)
+        {
+            versions.since = eq.last_version();
+            eq.last_version(versions.now);
+        }
+
+        return versions;
+    }
+    else
+    {
+        return matter::query_versions{};
+    }
+}
+
+// the number of rows of a single group matched by a query
+template<typename GroupResult>
+std::size_t query_result_rows(const GroupResult& res) noexcept
+{
+    std::size_t rows = 0;
+
+    auto visit = [&](const auto& store) {
+        using store_type = std::decay_t<decltype(store)>;
+
+        if constexpr (std::is_pointer_v<store_type>)
+        {
+            rows = store ? std::max(rows, std::size(*store)) : rows;
+        }
+        else if constexpr (!std::is_same_v<store_type, matter::empty>)
+        {
+            rows = std::max(rows, std::size(store));
+        }
+    };
+
+    if constexpr (matter::meta::is_tuple_v<GroupResult>)
+    {
+        std::apply([&](const auto&... stores) { (visit(stores), ...); }, res);
+        return rows;
+    }
+    else
+    {
+        // the group_result of a runtime query
+        return res.size();
+    }
+}
+
+// the groups visited and matched and the rows handed out by a query, recorded
+// once the result it was counted from is gone
+template<typename Query>
+struct query_profile
+{
+    std::uint64_t visited{0};
+    std::uint64_t matched{0};
+    std::uint64_t rows{0};
+
+    query_profile(std::uint64_t visited) noexcept : visited{visited}
+    {}
+
+    query_profile(const query_profile&) = delete;
+    query_profile& operator=(const query_profile&) = delete;
+
+    ~query_profile()
+    {
+        MATTER_PROFILE_INSTANT("query",
+                               ::nameof::nameof_type<Query>(),
+                               {"groups visited", visited},
+                               {"groups matched", matched},
+                               {"rows", rows});
+    }
+
+    template<typename GroupResult>
+    void count(const GroupResult& res) noexcept
+    {
+        ++matched;
+        rows += matter::detail::query_result_rows(res);
+    }
+};
+
+// records the groups visited and matched and the rows handed out by a query.
+// The results of cached and runtime queries are already filtered and get
+// counted right away, lazy results are counted while the caller walks them
+// so no group gets filtered twice.
+template<typename Query, typename World, typename Result>
+decltype(auto) profile_query(World& w, Result&& result)
+{
+    auto&& groups  = w.group_range();
+    auto   visited = static_cast<std::uint64_t>(
+        std::distance(std::begin(groups), std::end(groups)));
+
+    if constexpr (std::is_lvalue_reference_v<Result>)
+    {
+        auto profile = query_profile<Query>{visited};
+        for (auto&& res : result)
+        {
+            profile.count(res);
+        }
+
+        return std::forward<Result>(result);
+    }
+    else
+    {
+        // shared by every copy of the view, the last one records the event
+        auto profile = std::make_shared<query_profile<Query>>(visited);
+
+        return std::move(result) |
+               ranges::view::transform([profile](auto&& res) {
+                   profile->count(res);
+                   return std::forward<decltype(res)>(res);
+               });
+    }
 }
+} // namespace detail
 
 template<typename Query, typename World>
 constexpr decltype(auto) process_query(Query& q, World& w) noexcept
@@ -52,13 +238,170 @@ constexpr decltype(auto) process_query(Query& q, World& w) noexcept
             matter::is_component_identifier_v<World>,
             "World for entity query must be a valid ComponentIdentifier");
 
-        return process_entity_query(q, w.group_range(), w);
+        auto versions = matter::detail::entity_query_versions(q, w);
+
+        if constexpr (matter::profiler_enabled)
+        {
+            return matter::detail::profile_query<Query>(
+                w, process_entity_query(q, w.group_range(), w, versions));
+        }
+        else
+        {
+            return process_entity_query(q, w.group_range(), w, versions);
+        }
     }
     // TODO: group query, meta information will contain handle to the group
     // TODO: group filter query, no metainformation will be passed
     // TODO: world query, no metainformation will be passed
 }
 
+namespace detail
+{
+// the columns a row of a query result is made of, excluded components have no
+// column.
+template<typename Storage>
+constexpr auto query_columns(Storage& store) noexcept
+{
+    if constexpr (std::is_same_v<std::decay_t<Storage>, matter::empty>)
+    {
+        return std::tuple<>{};
+    }
+    else
+    {
+        static_assert(!std::is_pointer_v<std::decay_t<Storage>>,
+                      "Optional components cannot be visited per row");
+        return std::tuple<Storage&>{store};
+    }
+}
+
+template<typename GroupStores>
+constexpr auto query_group_columns(GroupStores& group_stores) noexcept
+{
+    return std::apply(
+        [](auto&... stores) {
+            return std::tuple_cat(matter::detail::query_columns(stores)...);
+        },
+        group_stores);
+}
+
+template<typename ExecutionPolicy, typename Query, typename World, typename F>
+constexpr void for_each_query_row(Query& q, World& w, F& f)
+{
+    for (auto&& group_stores : matter::process_query(q, w))
+    {
+        std::apply(
+            [&](auto&... columns) {
+                static_assert(sizeof...(columns) > 0,
+                              "Query must require at least one component");
+
+                if constexpr (std::is_same_v<
+                                  ExecutionPolicy,
+                                  matter::execution::unsequenced_policy>)
+                {
+                    matter::for_each_row(f, columns...);
+                }
+                else
+                {
+                    auto size = std::size(std::get<0>(std::tie(columns...)));
+                    for (std::size_t i = 0; i < size; ++i)
+                    {
+                        f(columns[i]...);
+                    }
+                }
+            },
+            matter::detail::query_group_columns(group_stores));
+    }
+}
+
+// all rows of the matched groups are numbered consecutively and this range is
+// split into tasks, so large groups get split up and small groups handled
+// together with their neighbours.
+template<typename Query, typename World, typename F>
+void parallel_for_each_query_row(matter::execution::parallel_policy policy,
+                                 Query&                             q,
+                                 World&                             w,
+                                 F&                                 f)
+{
+    auto groups = matter::process_query(q, w);
+
+    using group_stores_type = std::remove_reference_t<decltype(
+        *std::begin(std::declval<decltype(groups)&>()))>;
+    using columns_type      = decltype(matter::detail::query_group_columns(
+        std::declval<group_stores_type&>()));
+    static_assert(std::tuple_size_v<columns_type> > 0,
+                  "Query must require at least one component");
+
+    std::vector<columns_type> columns;
+    // offsets[i] is the number of rows before group i
+    std::vector<std::size_t> offsets{0};
+
+    for (auto&& group_stores : groups)
+    {
+        auto group_columns = matter::detail::query_group_columns(group_stores);
+        auto size          = std::size(std::get<0>(group_columns));
+
+        if (size != 0)
+        {
+            columns.push_back(group_columns);
+            offsets.push_back(offsets.back() + size);
+        }
+    }
+
+    matter::parallel_for(
+        policy, offsets.back(), [&](std::size_t first, std::size_t last) {
+            auto group =
+                static_cast<std::size_t>(
+                    std::upper_bound(offsets.begin(), offsets.end(), first) -
+                    offsets.begin()) -
+                1;
+
+            for (; first < last; ++group)
+            {
+                auto group_last = std::min(last, offsets[group + 1]);
+
+                std::apply(
+                    [&](auto&... cols) {
+                        matter::for_each_row_in(first - offsets[group],
+                                                group_last - offsets[group],
+                                                f,
+                                                cols...);
+                    },
+                    columns[group]);
+
+                first = group_last;
+            }
+        });
+}
+} // namespace detail
+
+/// \brief invokes f on the components of every entity matching an entity query
+/// `f` receives a reference to each required component, excluded components
+/// are skipped. With `matter::execution::unseq` the rows of each group are
+/// walked through the raw columns, giving the compiler loops it can
+/// vectorize, with `matter::execution::seq` they are visited in order.
+/// `matter::execution::par` spreads the rows of all matched groups over a
+/// thread pool, f is then invoked concurrently on different entities and
+/// must be safe to do so.
+template<typename ExecutionPolicy, typename Query, typename World, typename F>
+constexpr std::enable_if_t<matter::is_execution_policy_v<ExecutionPolicy>, F>
+for_each(ExecutionPolicy policy, Query& q, World& w, F f)
+{
+    static_assert(matter::traits::is_entity_query(boost::hana::typeid_(q)),
+                  "Only entity queries can be iterated per entity");
+
+    if constexpr (std::is_same_v<ExecutionPolicy,
+                                 matter::execution::parallel_policy>)
+    {
+        matter::detail::parallel_for_each_query_row(policy, q, w, f);
+    }
+    else
+    {
+        matter::detail::for_each_query_row<ExecutionPolicy>(q, w, f);
+    }
+
+    return f;
+}
+
 namespace traits
 {
 template<typename Query, typename World>
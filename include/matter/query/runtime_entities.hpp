@@ -0,0 +1,267 @@
+#ifndef MATTER_QUERY_RUNTIME_ENTITIES_HPP
+#define MATTER_QUERY_RUNTIME_ENTITIES_HPP
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#include "matter/component/any_group.hpp"
+#include "matter/component/signature.hpp"
+#include "matter/id/untyped_id.hpp"
+#include "matter/query/category.hpp"
+#include "matter/query/component_query_description.hpp"
+#include "matter/query/primitives/filter.hpp"
+#include "matter/storage/erased_storage.hpp"
+
+namespace matter
+{
+/// \brief an entity query described at runtime
+/// The components a query accesses are given as a list of
+/// `component_query_description`, so systems which only know the ids of
+/// components, like bindings to a scripting language, can query a world.
+/// Processing yields a `group_result` for every matching group, holding the
+/// erased store of every description in the order they were passed.
+/// Groups are matched by their signature, the sorted ids of a group are only
+/// compared to the required and excluded ones when it isn't exact. The results
+/// are kept in buffers owned by the query which get reused, so processing it
+/// every frame doesn't allocate once they grew large enough. The results stay
+/// valid until the query is processed again or the groups of the world
+/// change.
+template<typename Id>
+class runtime_entities {
+public:
+    using id_type          = Id;
+    using query_category   = matter::entity_query_tag;
+    using description_type = matter::component_query_description<id_type>;
+    using storage_type     = matter::erased_storage<id_type>;
+
+    /// \brief the stores of a single group matching the query
+    class group_result {
+    private:
+        storage_type* const* stores_;
+        std::size_t          store_count_;
+        std::size_t          size_;
+
+    public:
+        constexpr group_result(storage_type* const* stores,
+                               std::size_t          store_count,
+                               std::size_t          size) noexcept
+            : stores_{stores}, store_count_{store_count}, size_{size}
+        {}
+
+        /// the number of entities in the group
+        constexpr std::size_t size() const noexcept
+        {
+            return size_;
+        }
+
+        /// the store of the description at index, nullptr for excluded
+        /// components, inaccessible ones and optional ones the group doesn't
+        /// have
+        constexpr storage_type* operator[](std::size_t index) const noexcept
+        {
+            assert(index < store_count_);
+            return stores_[index];
+        }
+
+        constexpr storage_type* const* begin() const noexcept
+        {
+            return stores_;
+        }
+
+        constexpr storage_type* const* end() const noexcept
+        {
+            return stores_ + store_count_;
+        }
+    };
+
+private:
+    std::vector<description_type> descriptions_;
+    // sorted and unique, used to match groups with a single pass
+    std::vector<id_type>   required_;
+    std::vector<id_type>   excluded_;
+    matter::signature_mask mask_;
+    bool                   writes_{false};
+
+    // the stores of all matched groups, one row of descriptions_.size()
+    // stores per group
+    std::vector<storage_type*> stores_;
+    std::vector<group_result>  results_;
+
+public:
+    template<typename InputIt>
+    runtime_entities(InputIt first, InputIt last)
+        : descriptions_(first, last)
+    {
+        for (auto& descr : descriptions_)
+        {
+            if (descr.is_required())
+            {
+                required_.push_back(descr.id());
+                mask_.require(descr.id());
+            }
+            else if (descr.is_excluded())
+            {
+                excluded_.push_back(descr.id());
+                mask_.exclude(descr.id());
+            }
+
+            writes_ = writes_ || (descr.is_write() && !descr.is_excluded());
+        }
+
+        for (auto* ids : {&required_, &excluded_})
+        {
+            std::sort(ids->begin(), ids->end());
+            ids->erase(std::unique(ids->begin(), ids->end()), ids->end());
+        }
+    }
+
+    runtime_entities(std::initializer_list<description_type> descriptions)
+        : runtime_entities{descriptions.begin(), descriptions.end()}
+    {}
+
+    const std::vector<description_type>& descriptions() const noexcept
+    {
+        return descriptions_;
+    }
+
+    /// whether processing the query hands out any component for writing
+    bool writes() const noexcept
+    {
+        return writes_;
+    }
+
+    /// filter every group of group_rng and return the results of all matching
+    /// groups, see `process_query`. Columns handed out for writing are marked
+    /// with `versions.now`.
+    template<typename Range, typename Identifier>
+    const std::vector<group_result>&
+    update(Range&&                       group_rng,
+           const Identifier&             ident,
+           const matter::query_versions& versions)
+    {
+        static_assert(
+            std::is_same_v<typename Identifier::id_type, id_type>,
+            "The identifier must use the same ids as the descriptions");
+        (void) ident;
+
+        stores_.clear();
+        results_.clear();
+
+        // group sizes are kept in results_ until stores_ stops growing
+        for (auto grp : group_rng)
+        {
+            if (add_if_matching(grp, versions.now))
+            {
+                results_.emplace_back(nullptr, 0, grp.size());
+            }
+        }
+
+        auto stride = descriptions_.size();
+        for (std::size_t i = 0; i < results_.size(); ++i)
+        {
+            results_[i] = group_result{
+                stores_.data() + i * stride, stride, results_[i].size()};
+        }
+
+        return results_;
+    }
+
+private:
+    template<typename Group>
+    bool add_if_matching(Group grp, std::uint64_t now)
+    {
+        auto match = matter::match_signature(grp, mask_);
+        if (match == matter::signature_match::reject)
+        {
+            return false;
+        }
+
+        if (match == matter::signature_match::maybe)
+        {
+            auto required = matter::ordered_untyped_ids<id_type>{required_};
+            if (!grp.contains(required) || contains_excluded(grp))
+            {
+                return false;
+            }
+        }
+
+        auto* meta = grp.metadata();
+
+        for (auto& descr : descriptions_)
+        {
+            storage_type* store = nullptr;
+
+            if (!descr.is_excluded() && !descr.is_inaccessible())
+            {
+                store = grp.find_id(descr.id());
+            }
+
+            // the value of a shared component picks the group
+            assert(!(store && descr.is_write() && store->shared_size() != 0) &&
+                   "Shared components can't be written to");
+
+            if (store && descr.is_write() && meta && now != 0)
+            {
+                meta->mark_changed(
+                    static_cast<std::size_t>(store - grp.data()), now);
+            }
+
+            stores_.push_back(store);
+        }
+
+        return true;
+    }
+
+    // both the group and excluded_ are sorted, so a single pass finds
+    // whether they share any id
+    template<typename Group>
+    bool contains_excluded(Group& grp) const noexcept
+    {
+        auto grp_it = grp.begin();
+
+        for (auto& id : excluded_)
+        {
+            while (grp_it != grp.end() && grp_it->id() < id)
+            {
+                ++grp_it;
+            }
+
+            if (grp_it == grp.end())
+            {
+                return false;
+            }
+
+            if (grp_it->id() == id)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+};
+
+template<typename Id>
+runtime_entities(std::initializer_list<matter::component_query_description<Id>>)
+    ->runtime_entities<Id>;
+
+template<typename T>
+struct is_runtime_query : std::false_type
+{};
+
+template<typename Id>
+struct is_runtime_query<matter::runtime_entities<Id>> : std::true_type
+{};
+
+template<typename T>
+constexpr bool is_runtime_query_v = is_runtime_query<T>::value;
+} // namespace matter
+
+#endif
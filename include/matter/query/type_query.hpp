@@ -3,10 +3,14 @@
 
 #pragma once
 
+#include <type_traits>
+
 #include <boost/hana/type.hpp>
 
+#include "matter/component/traits.hpp"
 #include "matter/query/access.hpp"
 #include "matter/query/presence.hpp"
+#include "matter/query/primitives/changed.hpp"
 #include "matter/query/primitives/exclude.hpp"
 #include "matter/query/primitives/inaccessible.hpp"
 #include "matter/query/primitives/optional.hpp"
@@ -20,6 +24,10 @@ template<typename T, typename Access, typename Presence>
 class type_query {
     static_assert(matter::is_access_v<Access>);
     static_assert(matter::is_presence_v<Presence>);
+    static_assert(!(std::is_same_v<Access, matter::prim::write> &&
+                    matter::is_component_shared_v<T>),
+                  "Shared components can't be written to, their value picks "
+                  "the group, see registry::set_shared");
 
 public:
     using element_type = T;
@@ -63,6 +71,11 @@ using has =
 template<typename T>
 using opt_has =
     matter::type_query<T, matter::prim::inaccessible, matter::prim::optional>;
+
+/// read T of the groups in which T changed since the query was last processed
+template<typename T>
+using changed =
+    matter::type_query<T, matter::prim::read, matter::prim::changed>;
 } // namespace matter
 
 #endif
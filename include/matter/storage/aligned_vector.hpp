@@ -0,0 +1,172 @@
+#ifndef MATTER_STORAGE_ALIGNED_VECTOR_HPP
+#define MATTER_STORAGE_ALIGNED_VECTOR_HPP
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory_resource>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+namespace matter
+{
+/// the number of T fitting in Alignment bytes, for an alignment equal to the
+/// width of a SIMD register this is the number of lanes for T.
+template<typename T, std::size_t Alignment>
+constexpr std::size_t simd_lanes_v =
+    std::max<std::size_t>(Alignment / sizeof(T), 1);
+
+namespace detail
+{
+constexpr std::size_t round_up(std::size_t n, std::size_t multiple) noexcept
+{
+    return (n + multiple - 1) / multiple * multiple;
+}
+} // namespace detail
+
+/// \brief an allocator for SIMD friendly columns
+/// Every allocation starts on an `Alignment` byte boundary and is padded to a
+/// multiple of `simd_lanes_v<T, Alignment>` elements, so a kernel can always
+/// process whole registers up to `padded_size(size())` without a scalar tail.
+/// The padding elements past the size of the container have unspecified
+/// values, which is why T must be trivially copyable.
+/// Memory comes from a `std::pmr::memory_resource`, the allocator converts
+/// from `std::pmr::polymorphic_allocator` so containers using it get the
+/// resource of the registry like every other storage.
+template<typename T, std::size_t Alignment = 64>
+class aligned_allocator {
+    static_assert((Alignment & (Alignment - 1)) == 0,
+                  "Alignment must be a power of two");
+    static_assert(Alignment >= alignof(T),
+                  "Alignment must be at least the alignment of T");
+
+    template<typename U, std::size_t A>
+    friend class aligned_allocator;
+
+public:
+    using value_type = T;
+
+    static constexpr std::size_t alignment = Alignment;
+    static constexpr std::size_t lanes     = simd_lanes_v<T, Alignment>;
+
+    template<typename U>
+    struct rebind
+    {
+        using other = aligned_allocator<U, Alignment>;
+    };
+
+private:
+    std::pmr::memory_resource* resource_{std::pmr::get_default_resource()};
+
+public:
+    aligned_allocator() noexcept = default;
+
+    aligned_allocator(std::pmr::memory_resource* resource) noexcept
+        : resource_{resource}
+    {}
+
+    template<typename U>
+    aligned_allocator(const std::pmr::polymorphic_allocator<U>& alloc) noexcept
+        : resource_{alloc.resource()}
+    {}
+
+    template<typename U>
+    aligned_allocator(const aligned_allocator<U, Alignment>& other) noexcept
+        : resource_{other.resource_}
+    {}
+
+    /// the number of elements actually allocated for n elements
+    static constexpr std::size_t padded_size(std::size_t n) noexcept
+    {
+        return matter::detail::round_up(n, lanes);
+    }
+
+    T* allocate(std::size_t n)
+    {
+        static_assert(std::is_trivially_copyable_v<T>,
+                      "padding elements are never constructed");
+        return static_cast<T*>(
+            resource_->allocate(padded_bytes(n), Alignment));
+    }
+
+    void deallocate(T* ptr, std::size_t n) noexcept
+    {
+        resource_->deallocate(ptr, padded_bytes(n), Alignment);
+    }
+
+    std::pmr::memory_resource* resource() const noexcept
+    {
+        return resource_;
+    }
+
+    /// like `std::pmr::polymorphic_allocator` copies use the default resource
+    aligned_allocator select_on_container_copy_construction() const noexcept
+    {
+        return aligned_allocator{};
+    }
+
+    template<typename U>
+    bool operator==(const aligned_allocator<U, Alignment>& other) const
+        noexcept
+    {
+        return resource_ == other.resource_ ||
+               resource_->is_equal(*other.resource_);
+    }
+
+    template<typename U>
+    bool operator!=(const aligned_allocator<U, Alignment>& other) const
+        noexcept
+    {
+        return !(*this == other);
+    }
+
+private:
+    static constexpr std::size_t padded_bytes(std::size_t n) noexcept
+    {
+        return matter::detail::round_up(padded_size(n) * sizeof(T),
+                                        Alignment);
+    }
+};
+
+/// \brief a vector whose data is aligned and padded for SIMD kernels
+/// Use it as `storage_type` of a component to get a column starting on a cache
+/// line with room for whole registers, see `aligned_allocator`.
+template<typename T, std::size_t Alignment = 64>
+using aligned_vector = std::vector<T, matter::aligned_allocator<T, Alignment>>;
+
+/// the number of elements by which a storage pads its allocations, kernels may
+/// access elements up to the size rounded up to a multiple of this.
+template<typename Storage>
+struct storage_lanes : std::integral_constant<std::size_t, 1>
+{};
+
+template<typename T, std::size_t Alignment>
+struct storage_lanes<matter::aligned_vector<T, Alignment>>
+    : std::integral_constant<std::size_t, simd_lanes_v<T, Alignment>>
+{};
+
+template<typename Storage>
+constexpr std::size_t storage_lanes_v = storage_lanes<Storage>::value;
+
+/// the size of storage rounded up to its padding, every element below this
+/// may be accessed through `storage.data()`
+template<typename Storage>
+constexpr std::size_t padded_size(const Storage& storage) noexcept
+{
+    return matter::detail::round_up(storage.size(),
+                                    storage_lanes_v<Storage>);
+}
+
+/// the least common multiple of the lanes of every storage, reserving a
+/// multiple of this keeps the padding of all of them aligned to each other.
+template<typename... Storages>
+constexpr std::size_t common_storage_lanes_v = []() {
+    std::size_t res = 1;
+    ((res = std::lcm(res, storage_lanes_v<Storages>)), ...);
+    return res;
+}();
+} // namespace matter
+
+#endif
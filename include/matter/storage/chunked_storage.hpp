@@ -0,0 +1,674 @@
+#ifndef MATTER_STORAGE_CHUNKED_STORAGE_HPP
+#define MATTER_STORAGE_CHUNKED_STORAGE_HPP
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace matter
+{
+namespace detail
+{
+constexpr std::size_t floor_power_of_two(std::size_t n) noexcept
+{
+    std::size_t res = 1;
+
+    while (res <= n / 2)
+    {
+        res *= 2;
+    }
+
+    return res;
+}
+
+constexpr std::size_t log2_power_of_two(std::size_t n) noexcept
+{
+    std::size_t res = 0;
+
+    while (n > 1)
+    {
+        n /= 2;
+        ++res;
+    }
+
+    return res;
+}
+} // namespace detail
+
+/// the default number of elements per chunk, chosen so a chunk takes up at
+/// most 16KiB. Always a power of two so indexing compiles to a shift and mask.
+template<typename T>
+constexpr std::size_t default_chunk_size_v =
+    matter::detail::floor_power_of_two(
+        std::max<std::size_t>(std::size_t{16384} / sizeof(T), 1));
+
+/// \brief a sequence container made of fixed size chunks
+/// Growing never relocates existing elements, instead a new chunk gets
+/// allocated. This makes appending O(1) without the occasional reallocation
+/// and copy of every element `std::vector` does, and references to elements
+/// remain valid until the element is erased.
+/// Elements are contiguous within a chunk, `chunk_data` and `chunk_extent`
+/// expose each chunk for tight loops.
+/// Satisfies the storage contract used by `erased_storage` and `group_slice`,
+/// so it can be used as `storage_type` of a component. `ChunkSize` of 0 picks
+/// `default_chunk_size_v<T>`, which allows naming the storage before T is
+/// complete.
+/// Chunks are allocated from a `std::pmr::memory_resource`, like the pmr
+/// containers the resource is not propagated on copy or assignment.
+template<typename T, std::size_t ChunkSize = 0>
+class chunked_storage {
+
+public:
+    using value_type      = T;
+    using size_type       = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference       = T&;
+    using const_reference = const T&;
+    using pointer         = T*;
+    using const_pointer   = const T*;
+    using allocator_type  = std::pmr::polymorphic_allocator<T>;
+
+    static constexpr size_type chunk_size =
+        ChunkSize == 0 ? matter::default_chunk_size_v<T> : ChunkSize;
+
+    static_assert((chunk_size & (chunk_size - 1)) == 0,
+                  "ChunkSize must be a power of two");
+
+private:
+    static constexpr size_type chunk_shift =
+        matter::detail::log2_power_of_two(chunk_size);
+    static constexpr size_type chunk_mask = chunk_size - 1;
+
+    template<bool Const>
+    class basic_iterator {
+        friend class chunked_storage;
+        friend class basic_iterator<!Const>;
+
+    public:
+        using value_type        = T;
+        using difference_type   = std::ptrdiff_t;
+        using reference         = std::conditional_t<Const, const T&, T&>;
+        using pointer           = std::conditional_t<Const, const T*, T*>;
+        using iterator_category = std::random_access_iterator_tag;
+
+    private:
+        T* const* chunks_{nullptr};
+        size_type idx_{0};
+
+    public:
+        constexpr basic_iterator() noexcept = default;
+
+        constexpr basic_iterator(T* const* chunks, size_type idx) noexcept
+            : chunks_{chunks}, idx_{idx}
+        {}
+
+        template<bool C = Const, typename = std::enable_if_t<C>>
+        constexpr basic_iterator(const basic_iterator<false>& other) noexcept
+            : chunks_{other.chunks_}, idx_{other.idx_}
+        {}
+
+        constexpr size_type index() const noexcept
+        {
+            return idx_;
+        }
+
+        constexpr reference operator*() const noexcept
+        {
+            return chunks_[idx_ >> chunk_shift][idx_ & chunk_mask];
+        }
+
+        constexpr pointer operator->() const noexcept
+        {
+            return std::addressof(**this);
+        }
+
+        constexpr reference operator[](difference_type n) const noexcept
+        {
+            return *(*this + n);
+        }
+
+        constexpr basic_iterator& operator++() noexcept
+        {
+            ++idx_;
+            return *this;
+        }
+
+        constexpr basic_iterator& operator--() noexcept
+        {
+            --idx_;
+            return *this;
+        }
+
+        constexpr basic_iterator operator++(int) noexcept
+        {
+            auto tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+
+        constexpr basic_iterator operator--(int) noexcept
+        {
+            auto tmp = *this;
+            --(*this);
+            return tmp;
+        }
+
+        constexpr basic_iterator& operator+=(difference_type movement) noexcept
+        {
+            idx_ += movement;
+            return *this;
+        }
+
+        constexpr basic_iterator& operator-=(difference_type movement) noexcept
+        {
+            idx_ -= movement;
+            return *this;
+        }
+
+        constexpr basic_iterator operator+(difference_type movement) const
+            noexcept
+        {
+            auto tmp = *this;
+            tmp += movement;
+            return tmp;
+        }
+
+        friend constexpr basic_iterator operator+(difference_type movement,
+                                                  basic_iterator  it) noexcept
+        {
+            return it + movement;
+        }
+
+        constexpr basic_iterator operator-(difference_type movement) const
+            noexcept
+        {
+            auto tmp = *this;
+            tmp -= movement;
+            return tmp;
+        }
+
+        constexpr difference_type operator-(const basic_iterator& other) const
+            noexcept
+        {
+            return static_cast<difference_type>(idx_) -
+                   static_cast<difference_type>(other.idx_);
+        }
+
+        constexpr bool operator==(const basic_iterator& other) const noexcept
+        {
+            return idx_ == other.idx_;
+        }
+
+        constexpr bool operator!=(const basic_iterator& other) const noexcept
+        {
+            return !(*this == other);
+        }
+
+        constexpr bool operator<(const basic_iterator& other) const noexcept
+        {
+            return idx_ < other.idx_;
+        }
+
+        constexpr bool operator>(const basic_iterator& other) const noexcept
+        {
+            return idx_ > other.idx_;
+        }
+
+        constexpr bool operator<=(const basic_iterator& other) const noexcept
+        {
+            return idx_ <= other.idx_;
+        }
+
+        constexpr bool operator>=(const basic_iterator& other) const noexcept
+        {
+            return idx_ >= other.idx_;
+        }
+    };
+
+public:
+    using iterator               = basic_iterator<false>;
+    using const_iterator         = basic_iterator<true>;
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+private:
+    // every chunk holds room for chunk_size elements, the allocator of this
+    // vector is also used for the chunks
+    std::pmr::vector<T*> chunks_;
+    size_type            size_{0};
+
+public:
+    chunked_storage() noexcept = default;
+
+    explicit chunked_storage(const allocator_type& alloc) noexcept
+        : chunks_{alloc}
+    {}
+
+    chunked_storage(const chunked_storage& other) : chunked_storage{}
+    {
+        append_copy(other);
+    }
+
+    chunked_storage(const chunked_storage& other, const allocator_type& alloc)
+        : chunked_storage{alloc}
+    {
+        append_copy(other);
+    }
+
+    chunked_storage(chunked_storage&& other) noexcept
+        : chunks_{std::move(other.chunks_)},
+          size_{std::exchange(other.size_, 0)}
+    {}
+
+    chunked_storage& operator=(const chunked_storage& other)
+    {
+        if (this != std::addressof(other))
+        {
+            clear();
+            append_copy(other);
+        }
+
+        return *this;
+    }
+
+    chunked_storage& operator=(chunked_storage&& other)
+    {
+        if (this == std::addressof(other))
+        {
+            return *this;
+        }
+
+        clear();
+
+        if (get_allocator() == other.get_allocator())
+        {
+            deallocate_chunks();
+
+            chunks_ = std::move(other.chunks_);
+            size_   = std::exchange(other.size_, 0);
+        }
+        else
+        {
+            // the chunks belong to another resource, move the elements
+            reserve(other.size());
+            std::for_each(other.begin(), other.end(), [&](T& value) {
+                emplace_back(std::move(value));
+            });
+            other.clear();
+        }
+
+        return *this;
+    }
+
+    ~chunked_storage()
+    {
+        clear();
+        deallocate_chunks();
+    }
+
+    allocator_type get_allocator() const noexcept
+    {
+        return allocator_type{chunks_.get_allocator().resource()};
+    }
+
+    iterator begin() noexcept
+    {
+        return {chunks_.data(), 0};
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return {chunks_.data(), 0};
+    }
+
+    iterator end() noexcept
+    {
+        return {chunks_.data(), size_};
+    }
+
+    const_iterator end() const noexcept
+    {
+        return {chunks_.data(), size_};
+    }
+
+    reverse_iterator rbegin() noexcept
+    {
+        return reverse_iterator{end()};
+    }
+
+    const_reverse_iterator rbegin() const noexcept
+    {
+        return const_reverse_iterator{end()};
+    }
+
+    reverse_iterator rend() noexcept
+    {
+        return reverse_iterator{begin()};
+    }
+
+    const_reverse_iterator rend() const noexcept
+    {
+        return const_reverse_iterator{begin()};
+    }
+
+    size_type size() const noexcept
+    {
+        return size_;
+    }
+
+    bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    size_type capacity() const noexcept
+    {
+        return chunks_.size() * chunk_size;
+    }
+
+    /// allocates chunks until `new_capacity` elements fit, existing elements
+    /// never move.
+    void reserve(size_type new_capacity)
+    {
+        auto required = (new_capacity + chunk_mask) >> chunk_shift;
+
+        if (required <= chunks_.size())
+        {
+            return;
+        }
+
+        // room for every pointer is made first, so pushing one never throws
+        // and leaks the chunk just allocated
+        chunks_.reserve(required);
+
+        while (chunks_.size() < required)
+        {
+            chunks_.push_back(allocate_chunk());
+        }
+    }
+
+    reference operator[](size_type idx) noexcept
+    {
+        assert(idx < size());
+        return chunks_[idx >> chunk_shift][idx & chunk_mask];
+    }
+
+    const_reference operator[](size_type idx) const noexcept
+    {
+        assert(idx < size());
+        return chunks_[idx >> chunk_shift][idx & chunk_mask];
+    }
+
+    reference front() noexcept
+    {
+        return (*this)[0];
+    }
+
+    const_reference front() const noexcept
+    {
+        return (*this)[0];
+    }
+
+    reference back() noexcept
+    {
+        return (*this)[size_ - 1];
+    }
+
+    const_reference back() const noexcept
+    {
+        return (*this)[size_ - 1];
+    }
+
+    /// the number of allocated chunks
+    size_type chunk_count() const noexcept
+    {
+        return chunks_.size();
+    }
+
+    /// the contiguous elements of chunk `n`, valid up to `chunk_extent(n)`
+    pointer chunk_data(size_type n) noexcept
+    {
+        assert(n < chunk_count());
+        return chunks_[n];
+    }
+
+    const_pointer chunk_data(size_type n) const noexcept
+    {
+        assert(n < chunk_count());
+        return chunks_[n];
+    }
+
+    /// the number of elements present in chunk `n`
+    size_type chunk_extent(size_type n) const noexcept
+    {
+        auto first = n << chunk_shift;
+        return first >= size_ ? 0 : std::min(chunk_size, size_ - first);
+    }
+
+    template<typename... Args>
+    reference emplace_back(Args&&... args)
+    {
+        if (size_ == capacity())
+        {
+            // same as in reserve, the chunk would leak if the push threw
+            if (chunks_.size() == chunks_.capacity())
+            {
+                chunks_.reserve(std::max<size_type>(1, 2 * chunks_.size()));
+            }
+
+            chunks_.push_back(allocate_chunk());
+        }
+
+        auto* ptr = chunks_[size_ >> chunk_shift] + (size_ & chunk_mask);
+        ::new (static_cast<void*>(ptr)) T(std::forward<Args>(args)...);
+        ++size_;
+
+        return *ptr;
+    }
+
+    void push_back(const T& value)
+    {
+        emplace_back(value);
+    }
+
+    void push_back(T&& value)
+    {
+        emplace_back(std::move(value));
+    }
+
+    void pop_back() noexcept
+    {
+        assert(!empty());
+        --size_;
+        destroy_at(size_);
+    }
+
+    /// inserts the range before pos, appending at the end never moves any
+    /// existing element.
+    template<typename InputIt>
+    iterator insert(const_iterator pos, InputIt first, InputIt last)
+    {
+        auto idx      = pos.index();
+        auto old_size = size_;
+
+        if constexpr (std::is_base_of_v<
+                          std::forward_iterator_tag,
+                          typename std::iterator_traits<
+                              InputIt>::iterator_category>)
+        {
+            reserve(size_ + static_cast<size_type>(std::distance(first, last)));
+        }
+
+        for (; first != last; ++first)
+        {
+            emplace_back(*first);
+        }
+
+        if (idx != old_size)
+        {
+            std::rotate(begin() + idx, begin() + old_size, end());
+        }
+
+        return begin() + idx;
+    }
+
+    /// appends copies of the count elements starting at src, trivially
+    /// copyable elements are copied with one memcpy per chunk.
+    void append(const T* src, size_type count)
+    {
+        reserve(size_ + count);
+
+        if constexpr (std::is_trivially_copyable_v<T>)
+        {
+            while (count > 0)
+            {
+                auto offset = size_ & chunk_mask;
+                auto n      = std::min(chunk_size - offset, count);
+
+                std::memcpy(chunks_[size_ >> chunk_shift] + offset,
+                            src,
+                            n * sizeof(T));
+
+                src += n;
+                size_ += n;
+                count -= n;
+            }
+        }
+        else
+        {
+            for (size_type i = 0; i < count; ++i)
+            {
+                emplace_back(src[i]);
+            }
+        }
+    }
+
+    /// erase a single element, all elements after it shift one position to
+    /// the front. Erasing the last element is O(1).
+    iterator erase(const_iterator pos) noexcept
+    {
+        auto idx = pos.index();
+        assert(idx < size_);
+
+        std::move(begin() + idx + 1, end(), begin() + idx);
+        pop_back();
+
+        return begin() + idx;
+    }
+
+    /// erase the elements in [first, last), the following elements shift to
+    /// the front.
+    iterator erase(const_iterator first, const_iterator last) noexcept
+    {
+        auto first_idx = first.index();
+        auto last_idx  = last.index();
+        assert(first_idx <= last_idx && last_idx <= size_);
+
+        std::move(begin() + last_idx, end(), begin() + first_idx);
+
+        auto new_size = size_ - (last_idx - first_idx);
+        for (auto i = new_size; i < size_; ++i)
+        {
+            destroy_at(i);
+        }
+
+        size_ = new_size;
+
+        return begin() + first_idx;
+    }
+
+    void resize(size_type new_size, const T& value = T())
+    {
+        while (size_ > new_size)
+        {
+            pop_back();
+        }
+
+        reserve(new_size);
+
+        while (size_ < new_size)
+        {
+            emplace_back(value);
+        }
+    }
+
+    /// destroy all elements, the allocated chunks are kept
+    void clear() noexcept
+    {
+        if constexpr (!std::is_trivially_destructible_v<T>)
+        {
+            for (size_type i = 0; i < size_; ++i)
+            {
+                destroy_at(i);
+            }
+        }
+
+        size_ = 0;
+    }
+
+    /// release all chunks which aren't required to hold the current elements
+    void shrink_to_fit()
+    {
+        auto required = (size_ + chunk_mask) >> chunk_shift;
+
+        while (chunks_.size() > required)
+        {
+            deallocate_chunk(chunks_.back());
+            chunks_.pop_back();
+        }
+
+        chunks_.shrink_to_fit();
+    }
+
+private:
+    void append_copy(const chunked_storage& other)
+    {
+        reserve(size() + other.size());
+        std::for_each(other.begin(), other.end(), [&](const T& value) {
+            emplace_back(value);
+        });
+    }
+
+    T* allocate_chunk()
+    {
+        auto* resource = chunks_.get_allocator().resource();
+        return static_cast<T*>(
+            resource->allocate(sizeof(T) * chunk_size, alignof(T)));
+    }
+
+    void deallocate_chunk(T* chunk) noexcept
+    {
+        auto* resource = chunks_.get_allocator().resource();
+        resource->deallocate(chunk, sizeof(T) * chunk_size, alignof(T));
+    }
+
+    void deallocate_chunks() noexcept
+    {
+        for (auto* chunk : chunks_)
+        {
+            deallocate_chunk(chunk);
+        }
+
+        chunks_.clear();
+    }
+
+    void destroy_at(size_type idx) noexcept
+    {
+        if constexpr (!std::is_trivially_destructible_v<T>)
+        {
+            (chunks_[idx >> chunk_shift] + (idx & chunk_mask))->~T();
+        }
+    }
+};
+} // namespace matter
+
+#endif
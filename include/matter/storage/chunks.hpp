@@ -0,0 +1,264 @@
+#ifndef MATTER_STORAGE_CHUNKS_HPP
+#define MATTER_STORAGE_CHUNKS_HPP
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace matter
+{
+namespace detail
+{
+template<typename Storage>
+using is_chunked_sfinae =
+    std::void_t<decltype(Storage::chunk_size),
+                decltype(std::declval<Storage&>().chunk_data(0))>;
+
+template<typename Storage>
+using is_contiguous_sfinae =
+    std::void_t<decltype(std::data(std::declval<Storage&>()))>;
+
+template<typename Storage>
+using is_broadcast_sfinae =
+    std::void_t<decltype(std::declval<Storage&>().broadcast_data())>;
+
+template<typename Storage, typename = void>
+struct has_append : std::false_type
+{};
+
+template<typename Storage>
+struct has_append<Storage,
+                  std::void_t<decltype(std::declval<Storage&>().append(
+                      std::declval<const typename Storage::value_type*>(),
+                      std::size_t{}))>> : std::true_type
+{};
+} // namespace detail
+
+/// \brief whether the storage keeps its elements in fixed size blocks
+/// A chunked storage exposes `chunk_size` and `chunk_data(n)`, element `i`
+/// lives at `chunk_data(i / chunk_size)[i % chunk_size]`, see
+/// `chunked_storage`.
+template<typename Storage, typename = void>
+struct is_storage_chunked : std::false_type
+{};
+
+template<typename Storage>
+struct is_storage_chunked<Storage, detail::is_chunked_sfinae<Storage>>
+    : std::true_type
+{};
+
+template<typename Storage>
+constexpr bool is_storage_chunked_v =
+    is_storage_chunked<std::remove_const_t<Storage>>::value;
+
+/// \brief whether all elements of the storage are in one block of memory
+template<typename Storage, typename = void>
+struct is_storage_contiguous : std::false_type
+{};
+
+template<typename Storage>
+struct is_storage_contiguous<Storage, detail::is_contiguous_sfinae<Storage>>
+    : std::true_type
+{};
+
+template<typename Storage>
+constexpr bool is_storage_contiguous_v =
+    is_storage_contiguous<std::remove_const_t<Storage>>::value;
+
+/// \brief whether every row of the storage refers to the same single value
+/// A broadcast storage exposes `broadcast_data()`, a pointer to the value of
+/// all of its rows, see `shared_storage` and `empty_storage`. It never limits
+/// the size of a block.
+template<typename Storage, typename = void>
+struct is_storage_broadcast : std::false_type
+{};
+
+template<typename Storage>
+struct is_storage_broadcast<Storage, detail::is_broadcast_sfinae<Storage>>
+    : std::true_type
+{};
+
+template<typename Storage>
+constexpr bool is_storage_broadcast_v =
+    is_storage_broadcast<std::remove_const_t<Storage>>::value;
+
+/// \brief the column of a broadcast storage
+/// Indexing it yields the single value for every row, so a kernel written as
+/// `col[i]` reads it like any other column, while the compiler sees a load
+/// which doesn't depend on the loop. Like a raw pointer T is const when the
+/// value is read only, as for `shared_storage`.
+template<typename T>
+class broadcast_ptr {
+private:
+    T* value_;
+
+public:
+    constexpr explicit broadcast_ptr(T* value) noexcept : value_{value}
+    {}
+
+    constexpr T& operator[](std::size_t) const noexcept
+    {
+        return *value_;
+    }
+
+    constexpr T& operator*() const noexcept
+    {
+        return *value_;
+    }
+
+    constexpr T* operator->() const noexcept
+    {
+        return value_;
+    }
+
+    constexpr T* get() const noexcept
+    {
+        return value_;
+    }
+};
+
+/// \brief the contiguous elements of storage starting at index
+/// \returns a pointer to the element at index and the number of elements
+/// following it in the same block of memory, including itself. Broadcast
+/// storages return a `broadcast_ptr` spanning all remaining rows.
+template<typename Storage>
+constexpr auto contiguous_run(Storage& storage, std::size_t index) noexcept
+{
+    assert(index < std::size(storage));
+
+    if constexpr (matter::is_storage_broadcast_v<Storage>)
+    {
+        return std::pair{matter::broadcast_ptr{storage.broadcast_data()},
+                         std::size(storage) - index};
+    }
+    else if constexpr (matter::is_storage_chunked_v<Storage>)
+    {
+        constexpr std::size_t chunk_size = Storage::chunk_size;
+
+        auto offset = index % chunk_size;
+        return std::pair{storage.chunk_data(index / chunk_size) + offset,
+                         std::min(chunk_size - offset,
+                                  std::size(storage) - index)};
+    }
+    else
+    {
+        static_assert(matter::is_storage_contiguous_v<Storage>,
+                      "Storage is neither contiguous nor chunked");
+        return std::pair{std::data(storage) + index,
+                         std::size(storage) - index};
+    }
+}
+
+/// \brief appends copies of the count elements starting at src to storage
+/// Storages providing `append(src, count)`, like `chunked_storage`, copy
+/// them a block at a time. Others get a range insert of raw pointers, which
+/// the standard vectors already turn into a memmove for trivially copyable
+/// elements.
+template<typename Storage>
+void append_copy(Storage&                            storage,
+                 const typename Storage::value_type* src,
+                 std::size_t                         count)
+{
+    if constexpr (detail::has_append<Storage>::value)
+    {
+        storage.append(src, count);
+    }
+    else
+    {
+        storage.insert(storage.end(), src, src + count);
+    }
+}
+
+/// \brief walks the rows [first, last) of storages in lockstep one block at
+/// a time
+/// Invokes `f(count, col...)` where each `col` points to `count` contiguous
+/// elements of the matching storage, all referring to the same rows, or is a
+/// `broadcast_ptr` for a broadcast storage. Blocks are as large as every
+/// storage allows, so contiguous storages are passed in a single call and
+/// chunked storages once per chunk.
+/// Looping from 0 to count over the raw pointers in f gives the compiler a
+/// loop it can vectorize, which the per row `component_view` rarely allows.
+template<typename F, typename Storage, typename... Storages>
+constexpr void for_each_chunk_in(std::size_t first,
+                                 std::size_t last,
+                                 F&&         f,
+                                 Storage&    store,
+                                 Storages&... rest)
+{
+    assert(first <= last && last <= std::size(store));
+    assert(((std::size(rest) == std::size(store)) && ...));
+
+    if constexpr (!matter::is_storage_chunked_v<Storage> &&
+                  (!matter::is_storage_chunked_v<Storages> && ...))
+    {
+        if (first != last)
+        {
+            f(last - first,
+              matter::contiguous_run(store, first).first,
+              matter::contiguous_run(rest, first).first...);
+        }
+    }
+    else
+    {
+        while (first < last)
+        {
+            auto runs = std::make_tuple(matter::contiguous_run(store, first),
+                                        matter::contiguous_run(rest, first)...);
+            auto count = std::apply(
+                [&](const auto&... run) {
+                    return std::min({last - first, run.second...});
+                },
+                runs);
+
+            std::apply([&](const auto&... run) { f(count, run.first...); },
+                       runs);
+            first += count;
+        }
+    }
+}
+
+/// walks all rows of equally sized storages, see `for_each_chunk_in`
+template<typename F, typename Storage, typename... Storages>
+constexpr void for_each_chunk(F&& f, Storage& store, Storages&... rest)
+{
+    matter::for_each_chunk_in(
+        0, std::size(store), std::forward<F>(f), store, rest...);
+}
+
+/// \brief invokes f on the rows [first, last) of equally sized storages
+/// Rows are visited through raw pointers per block, `f` receives a reference
+/// to the element of each storage. Nothing is guaranteed about the order in
+/// which rows get visited, this is what `matter::execution::unseq` maps to.
+template<typename F, typename... Storages>
+constexpr void for_each_row_in(std::size_t first,
+                               std::size_t last,
+                               F&          f,
+                               Storages&... stores)
+{
+    matter::for_each_chunk_in(
+        first,
+        last,
+        [&](std::size_t count, auto... cols) {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                f(cols[i]...);
+            }
+        },
+        stores...);
+}
+
+/// invokes f on every row of equally sized storages, see `for_each_row_in`
+template<typename F, typename Storage, typename... Storages>
+constexpr void for_each_row(F& f, Storage& store, Storages&... rest)
+{
+    matter::for_each_row_in(0, std::size(store), f, store, rest...);
+}
+} // namespace matter
+
+#endif
@@ -0,0 +1,429 @@
+#ifndef MATTER_STORAGE_EMPTY_STORAGE_HPP
+#define MATTER_STORAGE_EMPTY_STORAGE_HPP
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace matter
+{
+namespace detail
+{
+/// \brief iterates a sequence in which every element is the same object
+/// Used by the storages which keep a single instance for all their rows,
+/// only the index moves while the referenced object stays the same.
+template<typename T, bool Const>
+class repeat_iterator {
+    friend class repeat_iterator<T, !Const>;
+
+public:
+    using value_type        = T;
+    using size_type         = std::size_t;
+    using difference_type   = std::ptrdiff_t;
+    using reference         = std::conditional_t<Const, const T&, T&>;
+    using pointer           = std::conditional_t<Const, const T*, T*>;
+    using iterator_category = std::random_access_iterator_tag;
+
+private:
+    pointer   value_{nullptr};
+    size_type idx_{0};
+
+public:
+    constexpr repeat_iterator() noexcept = default;
+
+    constexpr repeat_iterator(pointer value, size_type idx) noexcept
+        : value_{value}, idx_{idx}
+    {}
+
+    template<bool C = Const, typename = std::enable_if_t<C>>
+    constexpr repeat_iterator(const repeat_iterator<T, false>& other) noexcept
+        : value_{other.value_}, idx_{other.idx_}
+    {}
+
+    constexpr size_type index() const noexcept
+    {
+        return idx_;
+    }
+
+    constexpr reference operator*() const noexcept
+    {
+        return *value_;
+    }
+
+    constexpr pointer operator->() const noexcept
+    {
+        return value_;
+    }
+
+    constexpr reference operator[](difference_type) const noexcept
+    {
+        return *value_;
+    }
+
+    constexpr repeat_iterator& operator++() noexcept
+    {
+        ++idx_;
+        return *this;
+    }
+
+    constexpr repeat_iterator& operator--() noexcept
+    {
+        --idx_;
+        return *this;
+    }
+
+    constexpr repeat_iterator operator++(int) noexcept
+    {
+        auto tmp = *this;
+        ++(*this);
+        return tmp;
+    }
+
+    constexpr repeat_iterator operator--(int) noexcept
+    {
+        auto tmp = *this;
+        --(*this);
+        return tmp;
+    }
+
+    constexpr repeat_iterator& operator+=(difference_type movement) noexcept
+    {
+        idx_ += movement;
+        return *this;
+    }
+
+    constexpr repeat_iterator& operator-=(difference_type movement) noexcept
+    {
+        idx_ -= movement;
+        return *this;
+    }
+
+    constexpr repeat_iterator operator+(difference_type movement) const
+        noexcept
+    {
+        auto tmp = *this;
+        tmp += movement;
+        return tmp;
+    }
+
+    friend constexpr repeat_iterator operator+(difference_type movement,
+                                               repeat_iterator it) noexcept
+    {
+        return it + movement;
+    }
+
+    constexpr repeat_iterator operator-(difference_type movement) const
+        noexcept
+    {
+        auto tmp = *this;
+        tmp -= movement;
+        return tmp;
+    }
+
+    constexpr difference_type operator-(const repeat_iterator& other) const
+        noexcept
+    {
+        return static_cast<difference_type>(idx_) -
+               static_cast<difference_type>(other.idx_);
+    }
+
+    constexpr bool operator==(const repeat_iterator& other) const noexcept
+    {
+        return idx_ == other.idx_;
+    }
+
+    constexpr bool operator!=(const repeat_iterator& other) const noexcept
+    {
+        return !(*this == other);
+    }
+
+    constexpr bool operator<(const repeat_iterator& other) const noexcept
+    {
+        return idx_ < other.idx_;
+    }
+
+    constexpr bool operator>(const repeat_iterator& other) const noexcept
+    {
+        return idx_ > other.idx_;
+    }
+
+    constexpr bool operator<=(const repeat_iterator& other) const noexcept
+    {
+        return idx_ <= other.idx_;
+    }
+
+    constexpr bool operator>=(const repeat_iterator& other) const noexcept
+    {
+        return idx_ >= other.idx_;
+    }
+};
+} // namespace detail
+
+/// \brief a storage for empty components which only counts its elements
+/// Empty components, like tags, carry no state, so every element is the same.
+/// Instead of keeping one per row this storage keeps the number of rows and a
+/// single instance, copied from the first element put into it. Growing,
+/// erasing and copying never allocate or write a thing per row.
+/// It is a broadcast storage like `shared_storage`, loops walking the raw
+/// columns of a group through `for_each_chunk` receive a `broadcast_ptr` to
+/// the instance, so a tag never splits the blocks of the other columns.
+template<typename T>
+class empty_storage {
+    static_assert(std::is_empty_v<T> && std::is_copy_constructible_v<T>,
+                  "Only copy constructible empty types can be counted");
+
+public:
+    using value_type      = T;
+    using size_type       = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference       = T&;
+    using const_reference = const T&;
+    using pointer         = T*;
+    using const_pointer   = const T*;
+
+    using iterator               = matter::detail::repeat_iterator<T, false>;
+    using const_iterator         = matter::detail::repeat_iterator<T, true>;
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+private:
+    // the element of every row, engaged once the first row got added
+    std::optional<T> value_;
+    size_type        size_{0};
+    // only kept so reserving behaves like it does for other storages
+    size_type capacity_{0};
+
+public:
+    constexpr empty_storage() noexcept = default;
+
+    constexpr iterator begin() noexcept
+    {
+        return iterator{instance(), 0};
+    }
+
+    constexpr const_iterator begin() const noexcept
+    {
+        return const_iterator{instance(), 0};
+    }
+
+    constexpr iterator end() noexcept
+    {
+        return iterator{instance(), size_};
+    }
+
+    constexpr const_iterator end() const noexcept
+    {
+        return const_iterator{instance(), size_};
+    }
+
+    constexpr reverse_iterator rbegin() noexcept
+    {
+        return reverse_iterator{end()};
+    }
+
+    constexpr const_reverse_iterator rbegin() const noexcept
+    {
+        return const_reverse_iterator{end()};
+    }
+
+    constexpr reverse_iterator rend() noexcept
+    {
+        return reverse_iterator{begin()};
+    }
+
+    constexpr const_reverse_iterator rend() const noexcept
+    {
+        return const_reverse_iterator{begin()};
+    }
+
+    constexpr size_type size() const noexcept
+    {
+        return size_;
+    }
+
+    constexpr bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    constexpr size_type capacity() const noexcept
+    {
+        return capacity_;
+    }
+
+    constexpr void reserve(size_type new_capacity) noexcept
+    {
+        capacity_ = std::max(capacity_, new_capacity);
+    }
+
+    constexpr void shrink_to_fit() noexcept
+    {
+        capacity_ = size_;
+    }
+
+    constexpr reference operator[](size_type idx) noexcept
+    {
+        assert(idx < size_);
+        (void) idx;
+        return *value_;
+    }
+
+    constexpr const_reference operator[](size_type idx) const noexcept
+    {
+        assert(idx < size_);
+        (void) idx;
+        return *value_;
+    }
+
+    constexpr reference front() noexcept
+    {
+        assert(!empty());
+        return *value_;
+    }
+
+    constexpr const_reference front() const noexcept
+    {
+        assert(!empty());
+        return *value_;
+    }
+
+    constexpr reference back() noexcept
+    {
+        assert(!empty());
+        return *value_;
+    }
+
+    constexpr const_reference back() const noexcept
+    {
+        assert(!empty());
+        return *value_;
+    }
+
+    /// the instance every row refers to, see `matter::is_storage_broadcast`
+    constexpr pointer broadcast_data() noexcept
+    {
+        assert(!empty());
+        return instance();
+    }
+
+    constexpr const_pointer broadcast_data() const noexcept
+    {
+        assert(!empty());
+        return instance();
+    }
+
+    /// only the first row added to the storage is constructed from args
+    template<typename... Args>
+    constexpr reference emplace_back(Args&&... args) noexcept(
+        std::is_nothrow_constructible_v<T, Args&&...>)
+    {
+        static_assert(std::is_constructible_v<T, Args&&...>,
+                      "T is not constructible from Args");
+
+        if (!value_)
+        {
+            value_.emplace(std::forward<Args>(args)...);
+        }
+
+        grow(1);
+        return *value_;
+    }
+
+    constexpr void push_back(const T& value) noexcept(
+        std::is_nothrow_copy_constructible_v<T>)
+    {
+        emplace_back(value);
+    }
+
+    constexpr void pop_back() noexcept
+    {
+        assert(!empty());
+        --size_;
+    }
+
+    template<typename InputIt>
+    constexpr iterator
+    insert(const_iterator pos, InputIt first, InputIt last) noexcept(
+        std::is_nothrow_copy_constructible_v<T>)
+    {
+        assert(pos.index() <= size_);
+
+        if (first != last && !value_)
+        {
+            value_.emplace(*first);
+        }
+
+        grow(static_cast<size_type>(std::distance(first, last)));
+        return iterator{instance(), pos.index()};
+    }
+
+    /// append count elements, only the first one of src may be read
+    constexpr void append(const T* src, size_type count) noexcept(
+        std::is_nothrow_copy_constructible_v<T>)
+    {
+        if (count != 0 && !value_)
+        {
+            value_.emplace(*src);
+        }
+
+        grow(count);
+    }
+
+    constexpr iterator erase(const_iterator pos) noexcept
+    {
+        assert(pos.index() < size_);
+        --size_;
+        return iterator{instance(), pos.index()};
+    }
+
+    constexpr iterator erase(const_iterator first, const_iterator last) noexcept
+    {
+        assert(first <= last && last.index() <= size_);
+        size_ -= static_cast<size_type>(last - first);
+        return iterator{instance(), first.index()};
+    }
+
+    constexpr void resize(size_type new_size, const T& value = T()) noexcept(
+        std::is_nothrow_copy_constructible_v<T>)
+    {
+        if (new_size > size_ && !value_)
+        {
+            value_.emplace(value);
+        }
+
+        size_ = new_size;
+        reserve(new_size);
+    }
+
+    constexpr void clear() noexcept
+    {
+        size_ = 0;
+    }
+
+private:
+    constexpr pointer instance() noexcept
+    {
+        return value_ ? std::addressof(*value_) : nullptr;
+    }
+
+    constexpr const_pointer instance() const noexcept
+    {
+        return value_ ? std::addressof(*value_) : nullptr;
+    }
+
+    constexpr void grow(size_type count) noexcept
+    {
+        size_ += count;
+        reserve(size_);
+    }
+};
+} // namespace matter
+
+#endif
@@ -3,6 +3,13 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <memory_resource>
+
 #include "matter/component/traits.hpp"
 #include "matter/id/typed_id.hpp"
 #include "matter/util/id_erased.hpp"
@@ -47,6 +54,38 @@ public:
 
 namespace detail
 {
+/// construct Storage in an id_erased, storages which accept a polymorphic
+/// allocator get one using resource.
+template<typename Storage, typename Id>
+matter::id_erased<Id>
+make_erased_storage(const Id& id, std::pmr::memory_resource* resource)
+{
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+    if constexpr (!std::uses_allocator_v<Storage, allocator_type>)
+    {
+        return matter::id_erased<Id>{
+            std::allocator_arg, resource, id, std::in_place_type_t<Storage>{}};
+    }
+    else if constexpr (std::is_constructible_v<Storage, allocator_type>)
+    {
+        return matter::id_erased<Id>{std::allocator_arg,
+                                     resource,
+                                     id,
+                                     std::in_place_type_t<Storage>{},
+                                     allocator_type{resource}};
+    }
+    else
+    {
+        return matter::id_erased<Id>{std::allocator_arg,
+                                     resource,
+                                     id,
+                                     std::in_place_type_t<Storage>{},
+                                     std::allocator_arg,
+                                     allocator_type{resource}};
+    }
+}
+
 template<typename Id>
 struct erased_storage_vtable
 {
@@ -58,20 +97,55 @@ struct erased_storage_vtable
         std::add_pointer_t<void*(matter::erased&, size_type)>;
     using push_back_function_type =
         std::add_pointer_t<void(matter::erased&, const void*)>;
+    // returns the index of the element which was moved into `idx`
     using erase_function_type =
-        std::add_pointer_t<void(matter::erased&, size_type idx)>;
+        std::add_pointer_t<size_type(matter::erased&, size_type idx)>;
     using size_function_type =
         std::add_pointer_t<std::size_t(const matter::erased&)>;
+    using swap_function_type =
+        std::add_pointer_t<void(matter::erased&, size_type, size_type)>;
+    // makes room for `count` more elements
+    using reserve_more_function_type =
+        std::add_pointer_t<void(matter::erased&, size_type)>;
+    // appends `count` elements of src starting at `first` to dst
+    using append_function_type = std::add_pointer_t<
+        void(matter::erased&, const matter::erased&, size_type, size_type)>;
+    // removes the last `count` elements
+    using pop_back_function_type =
+        std::add_pointer_t<void(matter::erased&, size_type)>;
+    // moves sources[i] into holes[i] for `count` elements, then shrinks the
+    // storage to new_size
+    using compact_function_type =
+        std::add_pointer_t<void(matter::erased&,
+                                const size_type* holes,
+                                const size_type* sources,
+                                size_type        count,
+                                size_type        new_size)>;
+    // the value of a shared storage, nullptr for every other storage
+    using shared_value_function_type =
+        std::add_pointer_t<const void*(const matter::erased&)>;
+    // copies shared_size() bytes into the value of a shared storage
+    using assign_shared_function_type =
+        std::add_pointer_t<void(matter::erased&, const void*)>;
     // needed to create a new storage when it's not available beforehand
-    using create_function_type =
-        std::add_pointer_t<matter::id_erased<id_type>(id_type)>;
+    using create_function_type = std::add_pointer_t<matter::id_erased<id_type>(
+        id_type, std::pmr::memory_resource*)>;
 
 private:
     get_function_type       get_fn_;
     push_back_function_type pb_fn_;
     erase_function_type     erase_fn_;
     size_function_type      size_fn_;
-    create_function_type    create_fn_;
+    swap_function_type         swap_fn_;
+    reserve_more_function_type reserve_more_fn_;
+    append_function_type       append_fn_;
+    pop_back_function_type     pop_back_fn_;
+    compact_function_type      compact_fn_;
+    create_function_type       create_fn_;
+
+    shared_value_function_type  shared_value_fn_;
+    assign_shared_function_type assign_shared_fn_;
+    size_type                   shared_size_;
 
 public:
     template<typename C>
@@ -79,7 +153,10 @@ public:
         : get_fn_{[](matter::erased& er_storage, size_type idx) {
               auto& storage =
                   er_storage.template get<matter::component_storage_t<C>>();
-              return static_cast<void*>(std::addressof(storage[idx]));
+              // shared storages only hand out their value as const, writing
+              // through it is prevented by the queries
+              return const_cast<void*>(
+                  static_cast<const void*>(std::addressof(storage[idx])));
           }},
           pb_fn_{[](matter::erased& er_storage, const void* obj) {
               auto& storage =
@@ -91,9 +168,17 @@ public:
               auto& storage =
                   er_storage.template get<matter::component_storage_t<C>>();
 
-              // use swap and pop to efficiently erase without mass moving
-              auto last_idx = storage.size() - 1;
-              storage[idx]  = std::move(storage[last_idx]);
+              // use swap and pop to efficiently erase without mass moving,
+              // every row of a shared storage has the same value already
+              size_type last_idx = storage.size() - 1;
+              if constexpr (!matter::is_component_shared_v<C>)
+              {
+                  storage[idx] = std::move(storage[last_idx]);
+              }
+              else
+              {
+                  (void) idx;
+              }
 
               if constexpr (matter::has_erase_for<
                                 matter::component_storage_t<C>,
@@ -105,16 +190,130 @@ public:
               {
                   storage.erase(std::begin(storage) + last_idx);
               }
+
+              return last_idx;
           }},
           size_fn_{[](const matter::erased& er_storage) {
               const auto& storage =
                   er_storage.template get<matter::component_storage_t<C>>();
               return storage.size();
           }},
-          create_fn_{[](id_type id) {
-              return id_erased{
-                  id, std::in_place_type_t<matter::component_storage_t<C>>{}};
-          }}
+          swap_fn_{[](matter::erased& er_storage,
+                      size_type       lhs,
+                      size_type       rhs) {
+              // every row of a shared storage has the same value
+              if constexpr (!matter::is_component_shared_v<C>)
+              {
+                  auto& storage = er_storage.template get<
+                      matter::component_storage_t<C>>();
+
+                  using std::swap;
+                  swap(storage[lhs], storage[rhs]);
+              }
+              else
+              {
+                  (void) er_storage;
+                  (void) lhs;
+                  (void) rhs;
+              }
+          }},
+          reserve_more_fn_{[](matter::erased& er_storage, size_type count) {
+              auto& storage =
+                  er_storage.template get<matter::component_storage_t<C>>();
+
+              // keep the geometric growth, repeated migrations of single rows
+              // would reallocate every time otherwise
+              auto required = storage.size() + count;
+              if (required > storage.capacity())
+              {
+                  storage.reserve(std::max(required, 2 * storage.capacity()));
+              }
+          }},
+          append_fn_{[](matter::erased&       er_dst,
+                        const matter::erased& er_src,
+                        size_type             first,
+                        size_type             count) {
+              auto& dst = er_dst.template get<matter::component_storage_t<C>>();
+              const auto& src =
+                  er_src.template get<matter::component_storage_t<C>>();
+
+              // components are trivially copyable, for contiguous storage
+              // this becomes a single memcpy
+              auto src_first = std::begin(src) + first;
+              dst.insert(std::end(dst), src_first, src_first + count);
+          }},
+          pop_back_fn_{[](matter::erased& er_storage, size_type count) {
+              auto& storage =
+                  er_storage.template get<matter::component_storage_t<C>>();
+
+              assert(count <= storage.size());
+              storage.erase(std::end(storage) - count, std::end(storage));
+          }},
+          compact_fn_{[](matter::erased&  er_storage,
+                         const size_type* holes,
+                         const size_type* sources,
+                         size_type        count,
+                         size_type        new_size) {
+              auto& storage =
+                  er_storage.template get<matter::component_storage_t<C>>();
+
+              assert(new_size <= storage.size());
+
+              if constexpr (!matter::is_component_shared_v<C>)
+              {
+                  for (size_type i = 0; i < count; ++i)
+                  {
+                      storage[holes[i]] = std::move(storage[sources[i]]);
+                  }
+              }
+              else
+              {
+                  (void) holes;
+                  (void) sources;
+                  (void) count;
+              }
+
+              storage.erase(std::begin(storage) + new_size, std::end(storage));
+          }},
+          create_fn_{[](id_type id, std::pmr::memory_resource* resource) {
+              return make_erased_storage<matter::component_storage_t<C>>(
+                  id, resource);
+          }},
+          shared_value_fn_{[](const matter::erased& er_storage) {
+              if constexpr (matter::is_component_shared_v<C>)
+              {
+                  const auto& storage =
+                      er_storage
+                          .template get<matter::component_storage_t<C>>();
+                  return static_cast<const void*>(
+                      std::addressof(storage.value()));
+              }
+              else
+              {
+                  (void) er_storage;
+                  return static_cast<const void*>(nullptr);
+              }
+          }},
+          assign_shared_fn_{[](matter::erased& er_storage, const void* value) {
+              if constexpr (matter::is_component_shared_v<C>)
+              {
+                  auto& storage =
+                      er_storage
+                          .template get<matter::component_storage_t<C>>();
+
+                  // shared components are trivially copyable
+                  C comp;
+                  std::memcpy(std::addressof(comp), value, sizeof(C));
+                  storage.set_value(comp);
+              }
+              else
+              {
+                  (void) er_storage;
+                  (void) value;
+                  assert(false && "Only shared storages hold a value");
+              }
+          }},
+          shared_size_{matter::is_component_shared_v<C> ? sizeof(C) : 0}
     {
         static_assert(matter::is_component_v<C>,
                       "C does not fulfil the component contract");
@@ -132,7 +331,10 @@ public:
         return pb_fn_(er_storage, obj);
     }
 
-    constexpr void erase(matter::erased& er_storage, size_type idx) noexcept
+    /// swap and pop the element at idx, returns the index of the element
+    /// which now resides at idx.
+    constexpr size_type erase(matter::erased& er_storage,
+                              size_type       idx) noexcept
     {
         return erase_fn_(er_storage, idx);
     }
@@ -142,9 +344,61 @@ public:
         return size_fn_(er_storage);
     }
 
-    matter::id_erased<id_type> create_storage(id_type id) const noexcept
+    constexpr void
+    swap(matter::erased& er_storage, size_type lhs, size_type rhs) noexcept
+    {
+        swap_fn_(er_storage, lhs, rhs);
+    }
+
+    constexpr void reserve_more(matter::erased& er_storage, size_type count)
+    {
+        reserve_more_fn_(er_storage, count);
+    }
+
+    constexpr void append(matter::erased&       er_dst,
+                          const matter::erased& er_src,
+                          size_type             first,
+                          size_type             count) noexcept
+    {
+        append_fn_(er_dst, er_src, first, count);
+    }
+
+    constexpr void pop_back(matter::erased& er_storage,
+                            size_type       count) noexcept
+    {
+        pop_back_fn_(er_storage, count);
+    }
+
+    constexpr void compact(matter::erased&  er_storage,
+                           const size_type* holes,
+                           const size_type* sources,
+                           size_type        count,
+                           size_type        new_size) noexcept
+    {
+        compact_fn_(er_storage, holes, sources, count, new_size);
+    }
+
+    constexpr const void* shared_value(const matter::erased& er_storage) const
+        noexcept
+    {
+        return shared_value_fn_(er_storage);
+    }
+
+    constexpr void assign_shared(matter::erased& er_storage,
+                                 const void*     value) noexcept
+    {
+        assign_shared_fn_(er_storage, value);
+    }
+
+    constexpr size_type shared_size() const noexcept
     {
-        return create_fn_(id);
+        return shared_size_;
+    }
+
+    matter::id_erased<id_type>
+    create_storage(id_type id, std::pmr::memory_resource* resource) const
+    {
+        return create_fn_(id, resource);
     }
 };
 } // namespace detail
@@ -164,12 +418,13 @@ private:
     detail::erased_storage_vtable<id_type>* vptr_;
 
 public:
+    /// create an empty storage for T, which allocates from resource
     template<typename T>
-    explicit erased_storage(const matter::typed_id<id_type, T>& tid) noexcept(
-        std::is_nothrow_constructible_v<matter::id_erased<id_type>,
-                                        matter::component_storage_t<T>,
-                                        std::in_place_type_t<T>>)
-        : erased_{tid, std::in_place_type_t<matter::component_storage_t<T>>{}},
+    explicit erased_storage(
+        const matter::typed_id<id_type, T>& tid,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : erased_{detail::make_erased_storage<matter::component_storage_t<T>>(
+              tid.base(), resource)},
           vptr_{[]() {
               static detail::erased_storage_vtable<id_type> vobj{
                   std::in_place_type_t<T>{}};
@@ -211,7 +466,10 @@ public:
         return vptr_->push_back(erased_.base(), erased_comp.get());
     }
 
-    constexpr void erase(size_type idx) noexcept
+    /// swap and pop the element at idx, returns the index of the element
+    /// which was moved into idx. This is equal to idx when the last element
+    /// was erased.
+    constexpr size_type erase(size_type idx) noexcept
     {
         return vptr_->erase(erased_.base(), idx);
     }
@@ -221,11 +479,75 @@ public:
         return vptr_->size(erased_.base());
     }
 
+    /// swap the elements at lhs and rhs
+    constexpr void swap(size_type lhs, size_type rhs) noexcept
+    {
+        vptr_->swap(erased_.base(), lhs, rhs);
+    }
+
+    /// make room for `count` more elements, so appending them afterwards
+    /// doesn't allocate
+    constexpr void reserve_more(size_type count)
+    {
+        vptr_->reserve_more(erased_.base(), count);
+    }
+
+    /// append `count` elements of other, starting at `first`, in a single
+    /// call. Both must store the same component.
+    constexpr void append(const erased_storage& other,
+                          size_type             first,
+                          size_type             count) noexcept
+    {
+        assert(id() == other.id());
+        assert(first + count <= other.size());
+        vptr_->append(erased_.base(), other.erased_.base(), first, count);
+    }
+
+    /// remove the last `count` elements
+    constexpr void pop_back(size_type count) noexcept
+    {
+        vptr_->pop_back(erased_.base(), count);
+    }
+
+    /// move the element at sources[i] into holes[i] for every i < count, then
+    /// drop all elements past new_size. All of it happens in a single call.
+    constexpr void compact(const size_type* holes,
+                           const size_type* sources,
+                           size_type        count,
+                           size_type        new_size) noexcept
+    {
+        vptr_->compact(erased_.base(), holes, sources, count, new_size);
+    }
+
+    /// the size of the value of a shared component, 0 for every other
+    /// component
+    constexpr size_type shared_size() const noexcept
+    {
+        return vptr_->shared_size();
+    }
+
+    /// the value shared by every row, nullptr unless this stores a shared
+    /// component. It is `shared_size()` bytes large.
+    constexpr const void* shared_value() const noexcept
+    {
+        return vptr_->shared_value(erased_.base());
+    }
+
+    /// copy `shared_size()` bytes from value into the value shared by every
+    /// row, this must store a shared component
+    constexpr void assign_shared(const void* value) noexcept
+    {
+        assert(shared_size() != 0);
+        vptr_->assign_shared(erased_.base(), value);
+    }
+
     /// create another storage of this type, the contents are not copied
-    matter::erased_storage<id_type> duplicate_storage() const noexcept
+    matter::erased_storage<id_type> duplicate_storage(
+        std::pmr::memory_resource* resource =
+            std::pmr::get_default_resource()) const
     {
-        return matter::erased_storage<id_type>{vptr_->create_storage(id()),
-                                               vptr_};
+        return matter::erased_storage<id_type>{
+            vptr_->create_storage(id(), resource), vptr_};
     }
 
     constexpr auto operator==(const erased_storage& other) const noexcept
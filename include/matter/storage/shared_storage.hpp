@@ -0,0 +1,230 @@
+#ifndef MATTER_STORAGE_SHARED_STORAGE_HPP
+#define MATTER_STORAGE_SHARED_STORAGE_HPP
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+
+#include "matter/storage/empty_storage.hpp"
+
+namespace matter
+{
+/// \brief a storage holding a single value for all of its rows
+/// Components with this as their `storage_type` are shared: every entity of a
+/// group has the same value, which is stored once for the group. Entities with
+/// different values are put into different groups, a group is found by its
+/// ids together with the values of its shared components.
+/// Like `empty_storage` the rows are only counted, growing, erasing and moving
+/// rows never touches the value. Rows appended to the storage are expected to
+/// hold its value already, the `registry` picks the group accordingly.
+/// The value is read only, every accessor hands it out as const, so do
+/// `registry::get` and queries. Writing to it would change the value of every
+/// row while the group stays keyed on the value it was created with, use
+/// `registry::set_shared` to move an entity to another value instead.
+/// Groups are compared by the bytes of their shared values, so T must have a
+/// unique object representation, which rules out padding and floating point
+/// members.
+/// The storage is a broadcast, `for_each_chunk` hands kernels a
+/// `broadcast_ptr` to the value once per block and the blocks follow the per
+/// row columns next to it.
+template<typename T>
+class shared_storage {
+    static_assert(std::is_trivially_copyable_v<T> &&
+                      std::is_default_constructible_v<T>,
+                  "Shared components must be trivially copyable and default "
+                  "constructible");
+    static_assert(std::has_unique_object_representations_v<T>,
+                  "Shared components are compared by their bytes, they may not "
+                  "contain padding or floating point members");
+
+public:
+    using value_type      = T;
+    using size_type       = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference       = const T&;
+    using const_reference = const T&;
+    using pointer         = const T*;
+    using const_pointer   = const T*;
+
+    using iterator               = matter::detail::repeat_iterator<T, true>;
+    using const_iterator         = matter::detail::repeat_iterator<T, true>;
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+private:
+    T         value_{};
+    size_type size_{0};
+    // only kept so reserving behaves like it does for other storages
+    size_type capacity_{0};
+
+public:
+    constexpr shared_storage() noexcept = default;
+
+    /// the value of every row
+    constexpr const T& value() const noexcept
+    {
+        return value_;
+    }
+
+    /// change the value of every row, only used while the group is created
+    constexpr void set_value(const T& value) noexcept
+    {
+        value_ = value;
+    }
+
+    constexpr const_iterator begin() const noexcept
+    {
+        return const_iterator{&value_, 0};
+    }
+
+    constexpr const_iterator end() const noexcept
+    {
+        return const_iterator{&value_, size_};
+    }
+
+    constexpr const_reverse_iterator rbegin() const noexcept
+    {
+        return const_reverse_iterator{end()};
+    }
+
+    constexpr const_reverse_iterator rend() const noexcept
+    {
+        return const_reverse_iterator{begin()};
+    }
+
+    constexpr size_type size() const noexcept
+    {
+        return size_;
+    }
+
+    constexpr bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    constexpr size_type capacity() const noexcept
+    {
+        return capacity_;
+    }
+
+    constexpr void reserve(size_type new_capacity) noexcept
+    {
+        capacity_ = std::max(capacity_, new_capacity);
+    }
+
+    constexpr void shrink_to_fit() noexcept
+    {
+        capacity_ = size_;
+    }
+
+    constexpr const_reference operator[](size_type idx) const noexcept
+    {
+        assert(idx < size_);
+        (void) idx;
+        return value_;
+    }
+
+    constexpr const_reference front() const noexcept
+    {
+        assert(!empty());
+        return value_;
+    }
+
+    constexpr const_reference back() const noexcept
+    {
+        assert(!empty());
+        return value_;
+    }
+
+    /// the value every row refers to, see `matter::is_storage_broadcast`
+    constexpr const_pointer broadcast_data() const noexcept
+    {
+        return &value_;
+    }
+
+    /// the row isn't stored, the value constructed from args has to be the
+    /// value of the storage
+    template<typename... Args>
+    constexpr const_reference emplace_back(Args&&... args) noexcept
+    {
+        static_assert(std::is_constructible_v<T, Args&&...>,
+                      "T is not constructible from Args");
+        assert(holds(T(std::forward<Args>(args)...)));
+        grow(1);
+        return value_;
+    }
+
+    /// the row isn't stored, value has to be the value of the storage
+    constexpr void push_back(const T& value) noexcept
+    {
+        assert(holds(value));
+        (void) value;
+        grow(1);
+    }
+
+    constexpr void pop_back() noexcept
+    {
+        assert(!empty());
+        --size_;
+    }
+
+    template<typename InputIt>
+    constexpr iterator
+    insert(const_iterator pos, InputIt first, InputIt last) noexcept
+    {
+        assert(pos.index() <= size_);
+        grow(static_cast<size_type>(std::distance(first, last)));
+        return iterator{&value_, pos.index()};
+    }
+
+    /// append count rows, src is never read
+    constexpr void append(const T*, size_type count) noexcept
+    {
+        grow(count);
+    }
+
+    constexpr iterator erase(const_iterator pos) noexcept
+    {
+        assert(pos.index() < size_);
+        --size_;
+        return iterator{&value_, pos.index()};
+    }
+
+    constexpr iterator erase(const_iterator first, const_iterator last) noexcept
+    {
+        assert(first <= last && last.index() <= size_);
+        size_ -= static_cast<size_type>(last - first);
+        return iterator{&value_, first.index()};
+    }
+
+    constexpr void resize(size_type new_size, const T& = T()) noexcept
+    {
+        size_ = new_size;
+        reserve(new_size);
+    }
+
+    constexpr void clear() noexcept
+    {
+        size_ = 0;
+    }
+
+private:
+    bool holds(const T& value) const noexcept
+    {
+        return std::memcmp(&value_, &value, sizeof(T)) == 0;
+    }
+
+    constexpr void grow(size_type count) noexcept
+    {
+        size_ += count;
+        reserve(size_);
+    }
+};
+} // namespace matter
+
+#endif
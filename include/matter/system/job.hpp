@@ -7,9 +7,11 @@
 
 #include <boost/hana/ext/std/tuple.hpp>
 #include <boost/hana/type.hpp>
+#include <nameof.hpp>
 
 #include "matter/query/processor.hpp"
 #include "matter/util/meta.hpp"
+#include "matter/util/profiler.hpp"
 
 namespace matter
 {
@@ -18,6 +20,8 @@ constexpr void invoke_job(Job& job, World&& world) noexcept
 {
     using boost::hana::type_c;
 
+    MATTER_PROFILE_SCOPE(job_scope, "job", ::nameof::nameof_type<Job>());
+
     // retrieve the instantiated queries
     auto& queries = job.queries();
 
@@ -3,6 +3,12 @@
 
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
 #include <boost/hana.hpp>
 #include <boost/hana/ext/std/tuple.hpp>
 #include <boost/hana/for_each.hpp>
@@ -11,10 +17,167 @@
 
 #include "matter/id/id_cache.hpp"
 #include "matter/query/category.hpp"
+#include "matter/query/primitives/concurrency.hpp"
+#include "matter/query/runtime_entities.hpp"
 #include "matter/query/type_traits.hpp"
 
 namespace matter
 {
+/// \brief jobs split into stages which don't conflict
+/// The jobs of a stage may all run at the same time, the stages run one after
+/// another. Every job is put into the stage after the last earlier job it
+/// conflicts with, so conflicting jobs still run in the order they were given.
+/// Jobs are referred to by their index in that order.
+template<std::size_t JobCount>
+struct stage_plan
+{
+    /// the stage of every job
+    std::array<std::size_t, JobCount> stage_of{};
+    /// every job ordered by stage, jobs of the same stage by index
+    std::array<std::size_t, JobCount> jobs{};
+    /// the jobs of stage s are jobs[offsets[s]] up to jobs[offsets[s + 1]]
+    std::array<std::size_t, JobCount + 1> offsets{};
+    std::size_t                           stage_count{0};
+
+    static constexpr std::size_t job_count() noexcept
+    {
+        return JobCount;
+    }
+
+    constexpr std::size_t stage_size(std::size_t stage) const noexcept
+    {
+        return offsets[stage + 1] - offsets[stage];
+    }
+
+    /// the index-th job of stage
+    constexpr std::size_t job(std::size_t stage, std::size_t index) const
+        noexcept
+    {
+        return jobs[offsets[stage] + index];
+    }
+};
+
+namespace detail
+{
+template<typename Job>
+using job_queries_t = std::decay_t<decltype(std::declval<Job&>().queries())>;
+
+template<typename TypeQuery, typename... TypeQueries>
+constexpr bool type_query_conflicts(std::tuple<TypeQueries...>*) noexcept
+{
+    return (!matter::can_access_concurrent(
+                boost::hana::type_c<TypeQuery>,
+                boost::hana::type_c<TypeQueries>) ||
+            ...);
+}
+
+template<typename... LhsTypeQueries, typename... RhsTypeQueries>
+constexpr bool
+type_queries_conflict(std::tuple<LhsTypeQueries...>*,
+                      std::tuple<RhsTypeQueries...>* rhs) noexcept
+{
+    return (type_query_conflicts<LhsTypeQueries>(rhs) || ...);
+}
+
+template<typename LhsQuery, typename... RhsQueries>
+constexpr bool query_conflicts(std::tuple<RhsQueries...>*) noexcept
+{
+    return (type_queries_conflict(
+                static_cast<typename LhsQuery::query_types*>(nullptr),
+                static_cast<typename RhsQueries::query_types*>(nullptr)) ||
+            ...);
+}
+
+// only entity queries describe what they access at compile time, any other
+// query could access everything, runtime queries included
+template<typename... Queries>
+constexpr bool is_exclusive(std::tuple<Queries...>*) noexcept
+{
+    return ((matter::is_runtime_query_v<Queries> ||
+             !matter::traits::is_entity_query(boost::hana::type_c<Queries>)) ||
+            ...);
+}
+
+template<typename... LhsQueries, typename... RhsQueries>
+constexpr bool queries_conflict(std::tuple<LhsQueries...>*,
+                                std::tuple<RhsQueries...>* rhs) noexcept
+{
+    if constexpr (is_exclusive(static_cast<std::tuple<LhsQueries...>*>(
+                      nullptr)) ||
+                  is_exclusive(static_cast<std::tuple<RhsQueries...>*>(
+                      nullptr)))
+    {
+        return true;
+    }
+    else
+    {
+        return (query_conflicts<LhsQueries>(rhs) || ...);
+    }
+}
+
+template<typename Job, typename... Jobs>
+constexpr auto job_conflicts() noexcept
+{
+    return std::array<bool, sizeof...(Jobs)>{queries_conflict(
+        static_cast<job_queries_t<Job>*>(nullptr),
+        static_cast<job_queries_t<Jobs>*>(nullptr))...};
+}
+} // namespace detail
+
+/// \brief assigns Jobs to stages, see `matter::stage_plan`
+/// Two jobs conflict when any of their type queries can't access
+/// concurrently, a job with any query other than an entity query conflicts
+/// with every other job. Runtime queries are only described at runtime, so
+/// they count as exclusive as well. Each job goes into the earliest stage
+/// possible, the plan has as few stages as the order of conflicting jobs
+/// allows.
+template<typename... Jobs>
+constexpr auto make_stage_plan() noexcept
+{
+    constexpr auto job_count = sizeof...(Jobs);
+    constexpr auto conflicts =
+        std::array<std::array<bool, job_count>, job_count>{
+            detail::job_conflicts<Jobs, Jobs...>()...};
+
+    auto plan = matter::stage_plan<job_count>{};
+
+    for (std::size_t job = 0; job < job_count; ++job)
+    {
+        std::size_t stage = 0;
+        for (std::size_t before = 0; before < job; ++before)
+        {
+            if (conflicts[before][job] && plan.stage_of[before] >= stage)
+            {
+                stage = plan.stage_of[before] + 1;
+            }
+        }
+
+        plan.stage_of[job] = stage;
+        if (stage >= plan.stage_count)
+        {
+            plan.stage_count = stage + 1;
+        }
+    }
+
+    // counting sort of the jobs by stage
+    for (std::size_t job = 0; job < job_count; ++job)
+    {
+        ++plan.offsets[plan.stage_of[job] + 1];
+    }
+    for (std::size_t stage = 0; stage < job_count; ++stage)
+    {
+        plan.offsets[stage + 1] += plan.offsets[stage];
+    }
+
+    auto next = plan.offsets;
+    for (std::size_t job = 0; job < job_count; ++job)
+    {
+        plan.jobs[next[plan.stage_of[job]]++] = job;
+    }
+
+    return plan;
+}
+
 // collects information to speed up statically known information for queries and
 // handles all the registration of required components
 template<typename World, typename... Queries>
@@ -30,10 +193,11 @@ private:
 
         auto types              = boost::hana::tuple_t<Queries...>;
         auto entity_query_types = boost::hana::filter(types, [](auto t) {
+            using query_type = typename decltype(t)::type;
             return boost::hana::integral_c<
                 bool,
-                matter::traits::is_entity_query(
-                    type_c<typename decltype(t)::type>)>;
+                !matter::is_runtime_query_v<query_type> &&
+                    matter::traits::is_entity_query(type_c<query_type>)>;
         });
 
         auto type_queries =
@@ -70,6 +234,11 @@ private:
         decltype(create_id_cache(std::declval<World&>(),
                                  std::declval<component_type_list_type>()));
 
+public:
+    /// the stages to run Jobs in, computed at compile time
+    template<typename... Jobs>
+    static constexpr auto stages = matter::make_stage_plan<Jobs...>();
+
 private:
     World* world_;
 
@@ -124,6 +293,13 @@ public:
     {
         return world_->group_range();
     }
+
+    template<typename W = World>
+    auto advance_version() noexcept
+        -> decltype(std::declval<W&>().advance_version())
+    {
+        return world_->advance_version();
+    }
 };
 } // namespace matter
 
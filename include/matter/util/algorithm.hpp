@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <array>
 #include <iterator>
+#include <memory>
 #include <utility>
 
 #include "matter/util/iterator.hpp"
@@ -13,6 +14,7 @@
 
 namespace matter
 {
+class thread_pool;
 
 template<typename T, typename U = T>
 struct less
@@ -47,6 +49,27 @@ struct unsequenced_policy
 {};
 
 constexpr auto unseq = matter::execution::unsequenced_policy{};
+
+/// distributes the work over a `matter::thread_pool`, the default pool unless
+/// another one is given with `on`. Work is split into tasks of `grain_size`
+/// elements, 0 picks a size giving a few tasks per thread.
+struct parallel_policy
+{
+    matter::thread_pool* pool{nullptr};
+    std::size_t          grain_size{0};
+
+    constexpr parallel_policy on(matter::thread_pool& p) const noexcept
+    {
+        return parallel_policy{std::addressof(p), grain_size};
+    }
+
+    constexpr parallel_policy grain(std::size_t size) const noexcept
+    {
+        return parallel_policy{pool, size};
+    }
+};
+
+constexpr auto par = matter::execution::parallel_policy{};
 } // namespace execution
 
 template<typename ExecutionPolicy>
@@ -62,7 +85,22 @@ struct is_execution_policy<matter::execution::unsequenced_policy>
     : std::true_type
 {};
 
-template<typename ForwardIt, typename Sentinel, typename UnaryFunction>
+template<>
+struct is_execution_policy<matter::execution::parallel_policy> : std::true_type
+{};
+
+template<typename ExecutionPolicy>
+constexpr bool is_execution_policy_v =
+    is_execution_policy<ExecutionPolicy>::value;
+
+/// overloads taking an execution policy as first argument are provided for
+/// the containers they apply to, `unseq` visits groups through raw column
+/// pointers, see `group_slice` and `process_query`.
+template<typename ForwardIt,
+         typename Sentinel,
+         typename UnaryFunction,
+         typename = std::enable_if_t<
+             !matter::is_execution_policy_v<std::decay_t<ForwardIt>>>>
 constexpr UnaryFunction
 for_each(ForwardIt first, Sentinel last, UnaryFunction f) noexcept(
     std::is_nothrow_invocable_v<UnaryFunction,
@@ -5,6 +5,10 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
 #include <type_traits>
 #include <utility>
 
@@ -13,46 +17,86 @@ namespace matter
 /// \brief allow erasing a type for generic storage
 /// Upon destruction the destructor of the object will be run.
 /// Unlike `std::any` no mechanism to identify the correct type is provided.
+/// Objects which fit in `inline_size` and are nothrow move constructible are
+/// stored inline, this covers the standard containers and every storage
+/// provided by matter, so accessing a column's header doesn't require
+/// following a pointer to the heap. The buffer is sized so an erased takes up
+/// exactly one cache line on 64 bit platforms. Larger objects are allocated
+/// from a `std::pmr::memory_resource`, the default resource unless one is
+/// passed with `std::allocator_arg`.
 class erased {
 public:
-    using deleter_type = std::add_pointer_t<void(void*)>;
+    static constexpr std::size_t inline_size      = 6 * sizeof(void*);
+    static constexpr std::size_t inline_alignment = alignof(void*);
+
+    template<typename T>
+    static constexpr bool is_stored_inline_v =
+        sizeof(T) <= inline_size && alignof(T) <= inline_alignment &&
+        std::is_nothrow_move_constructible_v<T>;
+
+    /// constructing T throws only if its constructor does, unless it gets
+    /// allocated
+    template<typename T, typename... Args>
+    static constexpr bool is_nothrow_emplaceable_v =
+        is_stored_inline_v<T> && std::is_nothrow_constructible_v<T, Args...>;
 
 private:
+    enum class operation
+    {
+        destroy,
+        move
+    };
+
+    // destroys the object of self or moves it into dest, which is empty
+    using manager_type =
+        std::add_pointer_t<void(operation, erased& self, erased* dest)>;
+
     void*        obj_{nullptr};
-    deleter_type deleter_{nullptr};
+    manager_type manager_{nullptr};
+
+    alignas(inline_alignment) unsigned char buffer_[inline_size];
 
 public:
     erased() noexcept = default;
 
     template<typename T, typename... Args>
     erased(std::in_place_type_t<T>,
-           Args&&... args) noexcept(std::is_nothrow_constructible_v<T, Args...>)
-        : obj_{new T(std::forward<Args>(args)...)}, deleter_{[](void* obj) {
-              auto* t = static_cast<T*>(obj);
-              delete t;
-          }}
+           Args&&... args) noexcept(is_nothrow_emplaceable_v<T, Args...>)
+    {
+        static_assert(std::is_constructible_v<T, Args...>,
+                      "Cannot construct T from Args...");
+        construct<T>(std::pmr::get_default_resource(),
+                     std::forward<Args>(args)...);
+    }
+
+    /// construct the object, allocating it from resource if it doesn't fit
+    /// inline
+    template<typename T, typename... Args>
+    erased(std::allocator_arg_t,
+           std::pmr::memory_resource* resource,
+           std::in_place_type_t<T>,
+           Args&&... args) noexcept(is_nothrow_emplaceable_v<T, Args...>)
     {
         static_assert(std::is_constructible_v<T, Args...>,
                       "Cannot construct T from Args...");
+        construct<T>(resource, std::forward<Args>(args)...);
     }
 
     erased(const erased&) = delete;
     erased& operator=(const erased&) = delete;
 
     erased(erased&& other) noexcept
-        : obj_{std::move(other.obj_)}, deleter_{std::move(other.deleter_)}
     {
-        // ensure we don't delete our object
-        other.obj_ = nullptr;
+        take(other);
     }
 
     erased& operator=(erased&& other) noexcept
     {
-        clear();
-        obj_     = other.obj_;
-        deleter_ = other.deleter_;
-
-        other.obj_ = nullptr;
+        if (this != &other)
+        {
+            clear();
+            take(other);
+        }
 
         return *this;
     }
@@ -76,24 +120,23 @@ public:
     {
         if (!empty())
         {
-            deleter_(obj_);
+            manager_(operation::destroy, *this, nullptr);
             obj_ = nullptr;
         }
     }
 
     template<typename T, typename... Args>
-    T& emplace(Args&&... args) noexcept(
-        std::is_nothrow_constructible_v<T, Args...>)
+    T& emplace(Args&&... args) noexcept(is_nothrow_emplaceable_v<T, Args...>)
     {
         clear();
-        auto* obj = new T(std::forward<Args>(args)...);
-        obj_      = obj;
-        deleter_  = [](void* obj) {
-            auto* t = static_cast<T*>(obj);
-            delete t;
-        };
+        return construct<T>(std::pmr::get_default_resource(),
+                            std::forward<Args>(args)...);
+    }
 
-        return *obj;
+    /// whether the object lives within this erased rather than on the heap
+    bool is_inline() const noexcept
+    {
+        return obj_ == static_cast<const void*>(buffer_);
     }
 
     constexpr void* get_void() noexcept
@@ -131,21 +174,115 @@ public:
     }
 
     friend void swap(erased& lhs, erased& rhs) noexcept;
-}; // namespace matter
 
-void swap(erased& lhs, erased& rhs) noexcept
+private:
+    // heap objects keep the resource they were allocated from in the buffer
+    std::pmr::memory_resource*& heap_resource() noexcept
+    {
+        return *reinterpret_cast<std::pmr::memory_resource**>(buffer_);
+    }
+
+    template<typename T, typename... Args>
+    T& construct(std::pmr::memory_resource* resource, Args&&... args) noexcept(
+        is_nothrow_emplaceable_v<T, Args...>)
+    {
+        T* obj;
+
+        if constexpr (is_stored_inline_v<T>)
+        {
+            obj = ::new (static_cast<void*>(buffer_))
+                T(std::forward<Args>(args)...);
+            manager_ = [](operation op, erased& self, erased* dest) {
+                auto* t = static_cast<T*>(self.obj_);
+
+                if (op == operation::move)
+                {
+                    auto* buf  = static_cast<void*>(dest->buffer_);
+                    dest->obj_ = ::new (buf) T(std::move(*t));
+                }
+
+                t->~T();
+            };
+        }
+        else
+        {
+            assert(resource);
+
+            auto* mem = resource->allocate(sizeof(T), alignof(T));
+            try
+            {
+                obj = ::new (mem) T(std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                resource->deallocate(mem, sizeof(T), alignof(T));
+                throw;
+            }
+            ::new (static_cast<void*>(buffer_))
+                std::pmr::memory_resource*(resource);
+
+            manager_ = [](operation op, erased& self, erased* dest) {
+                auto* t = static_cast<T*>(self.obj_);
+
+                if (op == operation::move)
+                {
+                    // heap objects simply change owner
+                    dest->obj_ = t;
+                    ::new (static_cast<void*>(dest->buffer_))
+                        std::pmr::memory_resource*(self.heap_resource());
+                }
+                else
+                {
+                    t->~T();
+                    self.heap_resource()->deallocate(t, sizeof(T), alignof(T));
+                }
+            };
+        }
+
+        obj_ = obj;
+        return *obj;
+    }
+
+    /// take the object from other, this must be empty
+    void take(erased& other) noexcept
+    {
+        assert(empty());
+
+        if (!other.empty())
+        {
+            other.manager_(operation::move, other, this);
+            manager_ = other.manager_;
+
+            // ensure the object doesn't get destroyed again
+            other.obj_ = nullptr;
+        }
+    }
+};
+
+inline void swap(erased& lhs, erased& rhs) noexcept
 {
-    using std::swap;
-    swap(lhs.obj_, rhs.obj_);
-    swap(lhs.deleter_, rhs.deleter_);
+    erased tmp{std::move(lhs)};
+    lhs = std::move(rhs);
+    rhs = std::move(tmp);
 }
 
 template<typename T, typename... Args>
 erased make_erased(Args&&... args) noexcept(
-    std::is_nothrow_constructible_v<T, Args...>)
+    erased::is_nothrow_emplaceable_v<T, Args...>)
 {
     return erased{std::in_place_type_t<T>{}, std::forward<Args>(args)...};
 }
+
+template<typename T, typename... Args>
+erased allocate_erased(std::pmr::memory_resource* resource,
+                       Args&&... args) noexcept(
+    erased::is_nothrow_emplaceable_v<T, Args...>)
+{
+    return erased{std::allocator_arg,
+                  resource,
+                  std::in_place_type_t<T>{},
+                  std::forward<Args>(args)...};
+}
 } // namespace matter
 
 #endif
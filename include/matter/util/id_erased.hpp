@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <memory>
+#include <memory_resource>
 #include <numeric>
 
 #include "matter/id/id.hpp"
@@ -36,6 +38,26 @@ public:
           id_{id}
     {}
 
+    /// same as above, T gets allocated from resource when not stored inline
+    template<typename T, typename... Args>
+    id_erased(std::allocator_arg_t,
+              std::pmr::memory_resource* resource,
+              const id_type&             id,
+              std::in_place_type_t<T>,
+              Args&&... args) noexcept(std::
+                                           is_nothrow_constructible_v<
+                                               erased,
+                                               std::allocator_arg_t,
+                                               std::pmr::memory_resource*,
+                                               std::in_place_type_t<T>,
+                                               Args&&...>)
+        : base_type{std::allocator_arg,
+                    resource,
+                    std::in_place_type_t<T>{},
+                    std::forward<Args>(args)...},
+          id_{id}
+    {}
+
     id_erased(id_erased&& other) noexcept
         : base_type{std::move(other)}, id_{std::move(other.id_)}
     {}
@@ -0,0 +1,425 @@
+#ifndef MATTER_UTIL_PROFILER_HPP
+#define MATTER_UTIL_PROFILER_HPP
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace matter
+{
+/// whether matter was built with `MATTER_PROFILER`, without it every
+/// `MATTER_PROFILE_*` macro expands to nothing.
+#ifdef MATTER_PROFILER
+constexpr bool profiler_enabled = true;
+#else
+constexpr bool profiler_enabled = false;
+#endif
+
+/// a named value attached to a profiled event
+struct profile_arg
+{
+    std::string_view name;
+    std::uint64_t    value;
+};
+
+/// \brief records what happens inside matter for a trace viewer
+/// Events go to a ring buffer of the recording thread, which only that thread
+/// writes to. Recording takes no lock, only the first event of each thread
+/// registers its buffer under one. A `profile_scope` registers it when it is
+/// constructed, so its destructor never allocates. Once a buffer is full the
+/// oldest events get overwritten.
+/// `write_chrome_trace` exports the events of every thread in the trace event
+/// format read by chrome://tracing and Perfetto, it must not run while any
+/// thread records. Names and categories aren't copied, they must outlive the
+/// profiler, string literals and names from `nameof` do.
+class profiler {
+    friend class profile_scope;
+
+public:
+    static constexpr std::size_t max_args         = 3;
+    static constexpr std::size_t default_capacity = 1 << 14;
+
+    enum struct event_kind : std::uint8_t
+    {
+        /// spans [start, start + duration)
+        complete,
+        /// happens at start
+        instant
+    };
+
+    struct event
+    {
+        std::string_view                  name;
+        std::string_view                  category;
+        std::uint64_t                     start{0};
+        std::uint64_t                     duration{0};
+        std::array<profile_arg, max_args> args{};
+        std::uint8_t                      arg_count{0};
+        event_kind                        kind{event_kind::instant};
+    };
+
+private:
+    class thread_buffer {
+    private:
+        std::vector<event>         events_;
+        std::atomic<std::uint64_t> written_{0};
+        std::thread::id            owner_;
+        std::size_t                thread_;
+
+    public:
+        thread_buffer(std::size_t     capacity,
+                      std::thread::id owner,
+                      std::size_t     thread)
+            : events_(capacity), owner_{owner}, thread_{thread}
+        {}
+
+        std::thread::id owner() const noexcept
+        {
+            return owner_;
+        }
+
+        // only called by the owning thread
+        void push(const event& e) noexcept
+        {
+            auto index = written_.load(std::memory_order_relaxed);
+            events_[index % events_.size()] = e;
+            written_.store(index + 1, std::memory_order_release);
+        }
+
+        std::size_t thread() const noexcept
+        {
+            return thread_;
+        }
+
+        /// the number of events still held
+        std::size_t size() const noexcept
+        {
+            auto written = written_.load(std::memory_order_acquire);
+            return written < events_.size() ? written : events_.size();
+        }
+
+        /// invoke f with every event held, oldest first
+        template<typename F>
+        void for_each(F&& f) const
+        {
+            auto written = written_.load(std::memory_order_acquire);
+            auto first   = written - size();
+
+            for (auto i = first; i < written; ++i)
+            {
+                f(events_[i % events_.size()]);
+            }
+        }
+
+        void clear() noexcept
+        {
+            written_.store(0, std::memory_order_release);
+        }
+    };
+
+    // the last buffer used by a thread, see `command_buffers`
+    struct cache
+    {
+        std::uint64_t  owner{0};
+        thread_buffer* buffer{nullptr};
+    };
+
+    static std::uint64_t next_instance() noexcept
+    {
+        static std::atomic<std::uint64_t> next{1};
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::uint64_t instance_{next_instance()};
+    std::size_t   capacity_;
+
+    std::chrono::steady_clock::time_point epoch_{
+        std::chrono::steady_clock::now()};
+
+    mutable std::mutex mutex_;
+    // a deque keeps the buffers in place while others get added
+    std::deque<thread_buffer> buffers_;
+
+public:
+    /// every thread keeps the last `capacity` events it recorded
+    explicit profiler(std::size_t capacity = default_capacity)
+        : capacity_{capacity > 0 ? capacity : 1}
+    {}
+
+    profiler(const profiler&) = delete;
+    profiler& operator=(const profiler&) = delete;
+
+    /// the profiler the `MATTER_PROFILE_*` macros record to
+    static profiler& global()
+    {
+        static profiler prof{};
+        return prof;
+    }
+
+    /// nanoseconds since the profiler was created
+    std::uint64_t now() const noexcept
+    {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - epoch_)
+                .count());
+    }
+
+    void record(const event& e)
+    {
+        local().push(e);
+    }
+
+    /// record an event without duration happening now
+    void instant(std::string_view                   category,
+                 std::string_view                   name,
+                 std::initializer_list<profile_arg> args = {})
+    {
+        auto e = event{name, category, now()};
+        for (auto& arg : args)
+        {
+            if (e.arg_count < max_args)
+            {
+                e.args[e.arg_count++] = arg;
+            }
+        }
+
+        record(e);
+    }
+
+    /// the number of events held by all threads
+    std::size_t size() const
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+
+        std::size_t count = 0;
+        for (auto& buffer : buffers_)
+        {
+            count += buffer.size();
+        }
+        return count;
+    }
+
+    /// drop every recorded event, must not run while any thread records
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+
+        for (auto& buffer : buffers_)
+        {
+            buffer.clear();
+        }
+    }
+
+    /// write every recorded event as a chrome trace event JSON object, must
+    /// not run while any thread records
+    void write_chrome_trace(std::ostream& os) const
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+
+        os << "{\"traceEvents\":[";
+
+        auto first = true;
+        auto next  = [&]() {
+            if (!first)
+            {
+                os << ",\n";
+            }
+            first = false;
+        };
+
+        for (auto& buffer : buffers_)
+        {
+            next();
+            os << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":0,\"tid\":"
+               << buffer.thread() << ",\"args\":{\"name\":\"thread "
+               << buffer.thread() << "\"}}";
+
+            buffer.for_each([&](const event& e) {
+                next();
+                write_event(os, e, buffer.thread());
+            });
+        }
+
+        os << "],\"displayTimeUnit\":\"ns\"}\n";
+    }
+
+private:
+    thread_buffer& local()
+    {
+        thread_local cache last{};
+
+        if (last.owner != instance_)
+        {
+            last.owner  = instance_;
+            last.buffer = std::addressof(
+                find_or_add(std::this_thread::get_id()));
+        }
+
+        return *last.buffer;
+    }
+
+    thread_buffer& find_or_add(std::thread::id thread)
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+
+        for (auto& buffer : buffers_)
+        {
+            if (buffer.owner() == thread)
+            {
+                return buffer;
+            }
+        }
+
+        return buffers_.emplace_back(capacity_, thread, buffers_.size());
+    }
+
+    static void write_string(std::ostream& os, std::string_view str)
+    {
+        constexpr char hex[] = "0123456789abcdef";
+
+        os << '"';
+        for (char c : str)
+        {
+            auto uc = static_cast<unsigned char>(c);
+
+            if (c == '"' || c == '\\')
+            {
+                os << '\\' << c;
+            }
+            else if (uc < 0x20)
+            {
+                os << "\\u00" << hex[uc >> 4] << hex[uc & 0xf];
+            }
+            else
+            {
+                os << c;
+            }
+        }
+        os << '"';
+    }
+
+    // trace event timestamps are in microseconds
+    static void write_microseconds(std::ostream& os, std::uint64_t ns)
+    {
+        auto fraction = ns % 1000;
+
+        os << ns / 1000 << '.' << fraction / 100 << fraction / 10 % 10
+           << fraction % 10;
+    }
+
+    static void
+    write_event(std::ostream& os, const event& e, std::size_t thread)
+    {
+        os << "{\"name\":";
+        write_string(os, e.name);
+        os << ",\"cat\":";
+        write_string(os, e.category);
+
+        if (e.kind == event_kind::complete)
+        {
+            os << ",\"ph\":\"X\",\"ts\":";
+            write_microseconds(os, e.start);
+            os << ",\"dur\":";
+            write_microseconds(os, e.duration);
+        }
+        else
+        {
+            os << ",\"ph\":\"i\",\"s\":\"t\",\"ts\":";
+            write_microseconds(os, e.start);
+        }
+
+        os << ",\"pid\":0,\"tid\":" << thread;
+
+        if (e.arg_count > 0)
+        {
+            os << ",\"args\":{";
+            for (std::size_t i = 0; i < e.arg_count; ++i)
+            {
+                if (i != 0)
+                {
+                    os << ',';
+                }
+                write_string(os, e.args[i].name);
+                os << ':' << e.args[i].value;
+            }
+            os << '}';
+        }
+
+        os << '}';
+    }
+};
+
+/// \brief records a complete event spanning its own lifetime
+class profile_scope {
+private:
+    profiler*                profiler_;
+    profiler::thread_buffer* buffer_;
+    profiler::event          event_;
+
+public:
+    /// registers the buffer of the calling thread with prof if this is its
+    /// first event, which may throw
+    profile_scope(std::string_view category,
+                  std::string_view name,
+                  profiler&        prof = profiler::global())
+        : profiler_{std::addressof(prof)},
+          buffer_{std::addressof(prof.local())},
+          event_{name, category, prof.now()}
+    {
+        event_.kind = profiler::event_kind::complete;
+    }
+
+    profile_scope(const profile_scope&) = delete;
+    profile_scope& operator=(const profile_scope&) = delete;
+
+    ~profile_scope()
+    {
+        event_.duration = profiler_->now() - event_.start;
+        buffer_->push(event_);
+    }
+
+    /// attach a value to the event, only the first `profiler::max_args` are
+    /// kept
+    void arg(std::string_view name, std::uint64_t value) noexcept
+    {
+        if (event_.arg_count < profiler::max_args)
+        {
+            event_.args[event_.arg_count++] = profile_arg{name, value};
+        }
+    }
+};
+} // namespace matter
+
+#ifdef MATTER_PROFILER
+/// record a complete event named var spanning the rest of the enclosing scope
+#define MATTER_PROFILE_SCOPE(var, category, name)                              \
+    ::matter::profile_scope var                                                \
+    {                                                                          \
+        category, name                                                         \
+    }
+/// attach a value to the event of a `MATTER_PROFILE_SCOPE`
+#define MATTER_PROFILE_ARG(var, name, value)                                   \
+    var.arg(name, static_cast<std::uint64_t>(value))
+/// record an instant event, followed by up to 3 `{name, value}` pairs
+#define MATTER_PROFILE_INSTANT(category, name, ...)                            \
+    ::matter::profiler::global().instant(category, name, {__VA_ARGS__})
+#else
+#define MATTER_PROFILE_SCOPE(var, category, name) static_cast<void>(0)
+#define MATTER_PROFILE_ARG(var, name, value) static_cast<void>(0)
+#define MATTER_PROFILE_INSTANT(category, name, ...) static_cast<void>(0)
+#endif
+
+#endif
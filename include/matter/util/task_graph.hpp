@@ -0,0 +1,319 @@
+#ifndef MATTER_UTIL_TASK_GRAPH_HPP
+#define MATTER_UTIL_TASK_GRAPH_HPP
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "matter/util/thread_pool.hpp"
+
+namespace matter
+{
+/// \brief tasks with dependencies between them, run on a `thread_pool`
+/// A task starts once every task it depends on finished, tasks without a
+/// dependency between them run concurrently.
+/// The graph is built once, `run` only resets counters so running it every
+/// frame doesn't allocate as long as the pool used doesn't grow.
+/// Every thread keeps a deque of ready tasks, a finished task pushes the tasks
+/// it made ready to the deque of its thread. Threads run their newest task
+/// first and steal the oldest task of another thread when theirs is empty.
+/// Workers finding no ready task return to the pool, which lets them help
+/// with parallel work started by a running task, and are offered the graph
+/// again once a task becomes ready. The thread calling `run` sleeps until
+/// then instead.
+class task_graph {
+private:
+    // tasks pushed to a deque during a single run, as every task becomes ready
+    // exactly once per run no deque ever holds more than every task.
+    struct deque
+    {
+        std::mutex               mutex;
+        std::vector<std::size_t> tasks;
+        std::size_t              head{0};
+        std::size_t              tail{0};
+    };
+
+    std::vector<std::vector<std::size_t>> successors_;
+    std::vector<std::size_t>              predecessors_;
+
+    // state of a run
+    std::unique_ptr<deque[]>                    deques_;
+    std::size_t                                 deque_count_{0};
+    std::unique_ptr<std::atomic<std::size_t>[]> pending_;
+    std::atomic<std::size_t>                    claimed_{0};
+    // tasks sitting in a deque
+    std::atomic<std::size_t> ready_{0};
+
+    // the thread calling run waits here for a task to become ready
+    std::mutex               park_mutex_;
+    std::condition_variable  unparked_;
+    std::atomic<std::size_t> parked_{0};
+
+    template<typename F>
+    class runner final : public matter::thread_pool::task_set {
+    private:
+        task_graph&          graph_;
+        matter::thread_pool& pool_;
+        F&                   f_;
+
+        // a worker left while tasks remained to be claimed
+        std::atomic<bool> idle_{false};
+
+        std::mutex         error_mutex_;
+        std::exception_ptr error_;
+
+    public:
+        runner(task_graph& graph, matter::thread_pool& pool, F& f) noexcept
+            : graph_{graph}, pool_{pool}, f_{f}
+        {}
+
+        void work(std::size_t slot) noexcept override
+        {
+            while (graph_.claimed_.load(std::memory_order_acquire) <
+                   graph_.size())
+            {
+                std::size_t task;
+                if (!graph_.pop(slot, task) && !graph_.steal(slot, task))
+                {
+                    // the remaining tasks wait on tasks running elsewhere
+                    if (slot != 0)
+                    {
+                        idle_.store(true);
+                        return;
+                    }
+
+                    graph_.park();
+                    continue;
+                }
+
+                if (graph_.claimed_.fetch_add(1) == graph_.size() - 1)
+                {
+                    // the caller of run may leave now
+                    graph_.unpark();
+                }
+
+                try
+                {
+                    f_(task);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock{error_mutex_};
+                    if (!error_)
+                    {
+                        error_ = std::current_exception();
+                    }
+                }
+
+                bool pushed = false;
+                for (auto next : graph_.successors_[task])
+                {
+                    if (graph_.pending_[next].fetch_sub(
+                            1, std::memory_order_acq_rel) == 1)
+                    {
+                        graph_.push(slot, next);
+                        pushed = true;
+                    }
+                }
+
+                if (pushed && idle_.exchange(false))
+                {
+                    pool_.offer(*this);
+                }
+            }
+        }
+
+        const std::exception_ptr& error() const noexcept
+        {
+            return error_;
+        }
+    };
+
+public:
+    explicit task_graph(std::size_t tasks = 0)
+        : successors_(tasks), predecessors_(tasks),
+          pending_{std::make_unique<std::atomic<std::size_t>[]>(tasks)}
+    {}
+
+    task_graph(task_graph&& other) noexcept
+        : successors_{std::move(other.successors_)},
+          predecessors_{std::move(other.predecessors_)},
+          deques_{std::move(other.deques_)},
+          deque_count_{std::exchange(other.deque_count_, 0)},
+          pending_{std::move(other.pending_)}
+    {}
+
+    /// the number of tasks
+    std::size_t size() const noexcept
+    {
+        return successors_.size();
+    }
+
+    /// task after only starts once task before finished
+    void add_dependency(std::size_t before, std::size_t after)
+    {
+        assert(before < size() && after < size() && before != after);
+
+        successors_[before].push_back(after);
+        ++predecessors_[after];
+    }
+
+    /// the tasks depending directly on task
+    const std::vector<std::size_t>& successors(std::size_t task) const
+        noexcept
+    {
+        return successors_[task];
+    }
+
+    /// the number of tasks task depends on directly
+    std::size_t predecessors(std::size_t task) const noexcept
+    {
+        return predecessors_[task];
+    }
+
+    /// \brief invokes `f(task)` for every task respecting the dependencies
+    /// Returns once every task finished. If any of them throws the first
+    /// exception is rethrown here, the tasks depending on it still run. A
+    /// graph may only be run by one thread at a time.
+    template<typename F>
+    void run(matter::thread_pool& pool, F&& f)
+    {
+        if (size() == 0)
+        {
+            return;
+        }
+
+        prepare(pool.concurrency());
+
+        auto r = runner<std::remove_reference_t<F>>{*this, pool, f};
+        pool.run(r);
+
+        if (r.error())
+        {
+            std::rethrow_exception(r.error());
+        }
+    }
+
+private:
+    void prepare(std::size_t concurrency)
+    {
+        if (deque_count_ < concurrency)
+        {
+            deques_      = std::make_unique<deque[]>(concurrency);
+            deque_count_ = concurrency;
+
+            for (std::size_t i = 0; i < deque_count_; ++i)
+            {
+                deques_[i].tasks.resize(size());
+            }
+        }
+
+        for (std::size_t i = 0; i < deque_count_; ++i)
+        {
+            deques_[i].head = 0;
+            deques_[i].tail = 0;
+        }
+
+        claimed_.store(0, std::memory_order_relaxed);
+        ready_.store(0, std::memory_order_relaxed);
+
+        // the initial tasks are spread so every thread starts with its own
+        std::size_t roots = 0;
+        for (std::size_t i = 0; i < size(); ++i)
+        {
+            pending_[i].store(predecessors_[i], std::memory_order_relaxed);
+            if (predecessors_[i] == 0)
+            {
+                auto& d           = deques_[roots++ % concurrency];
+                d.tasks[d.tail++] = i;
+            }
+        }
+
+        ready_.store(roots, std::memory_order_relaxed);
+    }
+
+    void push(std::size_t slot, std::size_t task)
+    {
+        {
+            auto&                       d = deques_[slot];
+            std::lock_guard<std::mutex> lock{d.mutex};
+            d.tasks[d.tail++] = task;
+        }
+
+        ready_.fetch_add(1);
+        unpark();
+    }
+
+    /// sleep until a task got pushed or every task is claimed
+    void park()
+    {
+        std::unique_lock<std::mutex> lock{park_mutex_};
+        parked_.fetch_add(1);
+
+        unparked_.wait(lock, [&]() {
+            return ready_.load() != 0 || claimed_.load() == size();
+        });
+
+        parked_.fetch_sub(1);
+    }
+
+    void unpark()
+    {
+        // parked_ is raised before checking, either it is seen here or the
+        // parked thread sees what changed
+        if (parked_.load() != 0)
+        {
+            {
+                std::lock_guard<std::mutex> lock{park_mutex_};
+            }
+            unparked_.notify_all();
+        }
+    }
+
+    // the newest task of the own deque
+    bool pop(std::size_t slot, std::size_t& task)
+    {
+        auto&                       d = deques_[slot];
+        std::lock_guard<std::mutex> lock{d.mutex};
+
+        if (d.head == d.tail)
+        {
+            return false;
+        }
+
+        task = d.tasks[--d.tail];
+        ready_.fetch_sub(1);
+        return true;
+    }
+
+    // the oldest task of any other deque
+    bool steal(std::size_t slot, std::size_t& task)
+    {
+        for (std::size_t i = 1; i < deque_count_; ++i)
+        {
+            auto&                       d = deques_[(slot + i) % deque_count_];
+            std::lock_guard<std::mutex> lock{d.mutex};
+
+            if (d.head != d.tail)
+            {
+                task = d.tasks[d.head++];
+                ready_.fetch_sub(1);
+                return true;
+            }
+        }
+
+        return false;
+    }
+};
+} // namespace matter
+
+#endif
@@ -0,0 +1,350 @@
+#ifndef MATTER_UTIL_THREAD_POOL_HPP
+#define MATTER_UTIL_THREAD_POOL_HPP
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "matter/util/algorithm.hpp"
+
+namespace matter
+{
+/// \brief a fixed set of worker threads for fork-join parallelism
+/// Work is described by a `task_set`, which the workers and the calling
+/// thread of `run` claim tasks from until none are left. Several threads may
+/// call `run` on the same pool at once, tasks may do so as well.
+class thread_pool {
+    struct entry;
+
+public:
+    /// \brief work any number of threads can take part in at once
+    class task_set {
+        friend class thread_pool;
+
+    public:
+        /// claim and run tasks until none are left to claim. `slot` is unique
+        /// among the threads in `work` at the same time and less than the
+        /// `concurrency()` of the pool, 0 is the thread which called `run`.
+        /// Workers may also return while tasks remain to be claimed, the set
+        /// then has to be handed to `offer` once there is work again.
+        virtual void work(std::size_t slot) noexcept = 0;
+
+    protected:
+        ~task_set() = default;
+
+    private:
+        // guarded by the mutex of the pool, set while `run` is in progress
+        entry* entry_{nullptr};
+    };
+
+private:
+    // a task_set being run, lives on the stack of the caller of run and is
+    // linked into the queue of the pool without allocating
+    struct entry
+    {
+        task_set* set;
+        // guarded by the mutex of the pool
+        std::size_t users{0};
+        entry*      prev{nullptr};
+        entry*      next{nullptr};
+        bool        queued{false};
+        // offered again while queued, the next worker leaving keeps it queued
+        bool offered{false};
+    };
+
+    // runs f(i) for every index in [0, count)
+    template<typename F>
+    class index_set final : public task_set {
+    private:
+        F&                       f_;
+        std::size_t              count_;
+        std::atomic<std::size_t> next_{0};
+
+        std::mutex         error_mutex_;
+        std::exception_ptr error_;
+
+    public:
+        index_set(F& f, std::size_t count) noexcept : f_{f}, count_{count}
+        {}
+
+        void work(std::size_t) noexcept override
+        {
+            for (auto i = next_.fetch_add(1, std::memory_order_relaxed);
+                 i < count_;
+                 i = next_.fetch_add(1, std::memory_order_relaxed))
+            {
+                try
+                {
+                    f_(i);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock{error_mutex_};
+                    if (!error_)
+                    {
+                        error_ = std::current_exception();
+                    }
+                }
+            }
+        }
+
+        const std::exception_ptr& error() const noexcept
+        {
+            return error_;
+        }
+    };
+
+    std::mutex              mutex_;
+    std::condition_variable wake_;
+    std::condition_variable finished_;
+    entry*                  first_{nullptr};
+    entry*                  last_{nullptr};
+    bool                    stop_{false};
+
+    std::vector<std::thread> workers_;
+
+public:
+    /// the number of workers used when none are specified, the calling thread
+    /// takes part in the work as well.
+    static std::size_t default_worker_count() noexcept
+    {
+        auto hardware = std::thread::hardware_concurrency();
+        return hardware > 1 ? hardware - 1 : 0;
+    }
+
+    explicit thread_pool(std::size_t workers = default_worker_count())
+    {
+        workers_.reserve(workers);
+        for (std::size_t i = 0; i < workers; ++i)
+        {
+            // slot 0 is the thread calling run
+            workers_.emplace_back([this, i]() { worker_loop(i + 1); });
+        }
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    ~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            stop_ = true;
+        }
+        wake_.notify_all();
+
+        for (auto& worker : workers_)
+        {
+            worker.join();
+        }
+    }
+
+    /// the pool used by `matter::execution::par` unless another one is passed
+    static thread_pool& default_pool()
+    {
+        static thread_pool pool{};
+        return pool;
+    }
+
+    /// the number of threads taking part in a `run`, including the calling
+    /// thread
+    std::size_t concurrency() const noexcept
+    {
+        return workers_.size() + 1;
+    }
+
+    /// \brief works on set with every idle worker of the pool
+    /// Returns once every thread has left `set.work`, the calling thread
+    /// works on the set as well.
+    void run(task_set& set)
+    {
+        if (workers_.empty())
+        {
+            set.work(0);
+            return;
+        }
+
+        entry e{std::addressof(set)};
+
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            set.entry_ = std::addressof(e);
+            push(e);
+        }
+        wake_.notify_all();
+
+        set.work(0);
+
+        std::unique_lock<std::mutex> lock{mutex_};
+        set.entry_ = nullptr;
+        remove(e);
+        finished_.wait(lock, [&]() { return e.users == 0; });
+    }
+
+    /// \brief queue set again for idle workers
+    /// For sets whose workers return from `work` when no task is ready yet,
+    /// instead of spinning until one is. Those workers are free to help with
+    /// other sets meanwhile, like the ones run by a task of this set. Does
+    /// nothing unless `run(set)` is in progress.
+    void offer(task_set& set)
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+
+            auto* e = set.entry_;
+            if (!e)
+            {
+                return;
+            }
+
+            if (e->queued)
+            {
+                // a worker might be about to leave, it must not dequeue it
+                e->offered = true;
+                return;
+            }
+
+            push(*e);
+        }
+        wake_.notify_all();
+    }
+
+    /// \brief invokes `f(i)` for every i in [0, count) across the pool
+    /// Returns once every invocation finished. Invocations run concurrently
+    /// and in no particular order, whoever is free claims the next one so
+    /// tasks of uneven cost balance out between threads. If any of them
+    /// throws the first exception is rethrown here after all tasks finished.
+    template<typename F>
+    void parallel_for(std::size_t count, F&& f)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        if (count == 1 || workers_.empty())
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                f(i);
+            }
+            return;
+        }
+
+        auto set = index_set<std::remove_reference_t<F>>{f, count};
+        run(set);
+
+        if (set.error())
+        {
+            std::rethrow_exception(set.error());
+        }
+    }
+
+private:
+    // the queue functions require the mutex to be locked
+    void push(entry& e) noexcept
+    {
+        e.prev   = last_;
+        e.queued = true;
+        (last_ ? last_->next : first_) = std::addressof(e);
+        last_                          = std::addressof(e);
+    }
+
+    void remove(entry& e) noexcept
+    {
+        if (!e.queued)
+        {
+            return;
+        }
+
+        (e.prev ? e.prev->next : first_) = e.next;
+        (e.next ? e.next->prev : last_)  = e.prev;
+        e.prev                           = nullptr;
+        e.next                           = nullptr;
+        e.queued                         = false;
+    }
+
+    void worker_loop(std::size_t slot)
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+
+        while (true)
+        {
+            wake_.wait(lock, [&]() { return stop_ || first_; });
+
+            if (!first_)
+            {
+                return;
+            }
+
+            // a worker only enters a set once at a time, so its slot is unique
+            // among the threads in work
+            auto& e = *first_;
+            ++e.users;
+
+            lock.unlock();
+            e.set->work(slot);
+            lock.lock();
+
+            // nothing left to claim for other workers, unless the set got
+            // offered again in the meantime
+            if (std::exchange(e.offered, false))
+            {
+                if (!e.queued && e.set->entry_)
+                {
+                    push(e);
+                }
+            }
+            else
+            {
+                remove(e);
+            }
+
+            if (--e.users == 0)
+            {
+                finished_.notify_all();
+            }
+        }
+    }
+};
+
+/// \brief invokes `f(first, last)` on consecutive ranges covering [0, count)
+/// The ranges are spread over the pool of the policy, see
+/// `matter::execution::parallel_policy`. Unless a grain size is given each
+/// thread gets a few ranges, so threads finishing early take over the rest,
+/// but no range is shorter than 1024 elements to keep scheduling cheap.
+template<typename F>
+void parallel_for(matter::execution::parallel_policy policy,
+                  std::size_t                        count,
+                  F&&                                f)
+{
+    constexpr std::size_t tasks_per_thread = 4;
+    constexpr std::size_t min_grain_size   = 1024;
+
+    auto& pool =
+        policy.pool ? *policy.pool : matter::thread_pool::default_pool();
+
+    auto grain = policy.grain_size;
+    if (grain == 0)
+    {
+        auto tasks = pool.concurrency() * tasks_per_thread;
+        grain      = std::max((count + tasks - 1) / tasks, min_grain_size);
+    }
+
+    pool.parallel_for((count + grain - 1) / grain, [&](std::size_t task) {
+        auto first = task * grain;
+        f(first, std::min(first + grain, count));
+    });
+}
+} // namespace matter
+
+#endif
@@ -1,6 +1,9 @@
 #ifndef MATTER_WORLD_HPP
 #define MATTER_WORLD_HPP
 
+#include <cstdint>
+
+#include "matter/component/command_buffer.hpp"
 #include "matter/component/registry.hpp"
 #include "matter/id/default_component_identifier.hpp"
 #include "matter/util/meta.hpp"
@@ -14,6 +17,10 @@ public:
     using registry_type   = Registry;
     using identifier_type = typename registry_type::identifier_type;
     using id_type         = typename identifier_type::id_type;
+    using entity_type     = typename registry_type::entity_type;
+
+    using command_buffer_type  = matter::command_buffer<registry_type>;
+    using command_buffers_type = matter::command_buffers<registry_type>;
 
 private:
     registry_type registry_;
@@ -21,6 +28,12 @@ private:
 public:
     world() noexcept = default;
 
+    /// all entity and component memory of this world gets allocated from
+    /// resource. See `registry` for using it as an arena.
+    explicit world(std::pmr::memory_resource* resource) noexcept
+        : registry_{resource}
+    {}
+
     template<typename T>
     constexpr auto component_id() const
         noexcept(noexcept(registry_.template component_id<T>()))
@@ -53,13 +66,69 @@ public:
         return registry_.group_container().range();
     }
 
+    /// identifies the groups of this world, see `group_container::instance`
+    std::uint64_t instance() const noexcept
+    {
+        return registry_.instance();
+    }
+
+    /// take the next version for marking changed columns, see
+    /// `change_clock`
+    std::uint64_t advance_version() noexcept
+    {
+        return registry_.group_container().advance_version();
+    }
+
     /// create an entity composed of the given components
-    /// TODO add a handle to the entity as a return value
+    /// \returns a handle which stays valid until the entity is destroyed
     template<typename... Ts, typename... Args>
-    constexpr decltype(auto) create_entity(Args&&... args) noexcept(
+    constexpr entity_type create_entity(Args&&... args) noexcept(
         noexcept(registry_.template create<Ts...>(std::forward<Args>(args)...)))
     {
-        registry_.template create<Ts...>(std::forward<Args>(args)...);
+        return registry_.template create<Ts...>(std::forward<Args>(args)...);
+    }
+
+    bool contains_entity(const entity_type& ent) const noexcept
+    {
+        return registry_.contains(ent);
+    }
+
+    bool destroy_entity(const entity_type& ent) noexcept
+    {
+        return registry_.destroy(ent);
+    }
+
+    /// destroy every alive entity in [first, last) in a single batch
+    /// \returns the number of destroyed entities
+    template<typename InputIt>
+    std::size_t destroy_entities(InputIt first, InputIt last)
+    {
+        return registry_.destroy(first, last);
+    }
+
+    /// a buffer recording structural changes to apply to this world later,
+    /// see `command_buffer`
+    command_buffer_type make_command_buffer()
+    {
+        return command_buffer_type{registry_};
+    }
+
+    /// a command buffer for every thread, see `command_buffers`
+    command_buffers_type make_command_buffers()
+    {
+        return command_buffers_type{registry_};
+    }
+
+    template<typename T>
+    matter::component_access_t<T>* try_get_component(const entity_type& ent)
+    {
+        return registry_.template try_get<T>(ent);
+    }
+
+    template<typename T>
+    matter::component_access_t<T>& get_component(const entity_type& ent)
+    {
+        return registry_.template get<T>(ent);
     }
 };
 } // namespace matter
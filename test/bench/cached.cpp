@@ -0,0 +1,111 @@
+#include <benchmark/benchmark.h>
+
+#include <utility>
+
+#include "matter/component/registry.hpp"
+#include "matter/id/default_component_identifier.hpp"
+#include "matter/query/cached_entities.hpp"
+#include "matter/query/entities.hpp"
+#include "matter/query/processor.hpp"
+#include "matter/world.hpp"
+
+struct position
+{
+    float x;
+    float y;
+    float z;
+};
+
+template<std::size_t I>
+struct tag
+{};
+
+constexpr std::size_t tag_count = 32;
+
+template<std::size_t... Is>
+auto world_type(std::index_sequence<Is...>)
+    -> matter::world<matter::registry<
+        matter::default_component_identifier<matter::unsigned_id<std::size_t>,
+                                             position,
+                                             tag<Is>...>>>;
+
+using world_t = decltype(world_type(std::make_index_sequence<tag_count>{}));
+
+// a group for every pair of tags, only those with tag<0> hold positions. This
+// gives 496 groups of which 31 match a query for positions.
+template<std::size_t I, std::size_t... Js>
+void fill_pairs(world_t& w, std::index_sequence<Js...>)
+{
+    [[maybe_unused]] auto create = [&](auto tag_c) {
+        using tag_type = decltype(tag_c);
+        if constexpr (I == 0)
+        {
+            w.create_entity<position, tag<I>, tag_type>(
+                position{1.f, 2.f, 3.f}, tag<I>{}, tag_type{});
+        }
+        else
+        {
+            w.create_entity<tag<I>, tag_type>(tag<I>{}, tag_type{});
+        }
+    };
+
+    (create(tag<I + 1 + Js>{}), ...);
+}
+
+template<std::size_t... Is>
+void fill(world_t& w, std::index_sequence<Is...>)
+{
+    (fill_pairs<Is>(w, std::make_index_sequence<tag_count - 1 - Is>{}), ...);
+}
+
+template<typename Query>
+float sum_positions(Query& q, world_t& w)
+{
+    auto sum = 0.f;
+    for (auto [positions] : matter::process_query(q, w))
+    {
+        for (auto& pos : positions)
+        {
+            sum += pos.x;
+        }
+    }
+    return sum;
+}
+
+// every group is filtered each frame
+void query_uncached(benchmark::State& state)
+{
+    world_t w;
+    fill(w, std::make_index_sequence<tag_count>{});
+
+    auto eq = matter::entities{boost::hana::type_c<matter::read<position>>};
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(sum_positions(eq, w));
+    }
+}
+
+// only the matching groups are visited each frame
+void query_cached(benchmark::State& state)
+{
+    world_t w;
+    fill(w, std::make_index_sequence<tag_count>{});
+
+    auto eq =
+        matter::cached_entities{boost::hana::type_c<matter::read<position>>};
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(sum_positions(eq, w));
+    }
+}
+
+BENCHMARK(query_uncached)->Unit(benchmark::kMicrosecond);
+BENCHMARK(query_cached)->Unit(benchmark::kMicrosecond);
+
+int main(int argc, char** argv)
+{
+    ::benchmark::Initialize(&argc, argv);
+    ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,145 @@
+#include <benchmark/benchmark.h>
+
+#include <utility>
+
+#include "matter/component/registry.hpp"
+#include "matter/id/default_component_identifier.hpp"
+#include "matter/query/entities.hpp"
+#include "matter/query/processor.hpp"
+#include "matter/world.hpp"
+
+struct position
+{
+    float x;
+    float y;
+    float z;
+};
+
+struct velocity
+{
+    float x;
+    float y;
+    float z;
+};
+
+template<std::size_t I>
+struct tag
+{};
+
+constexpr std::size_t group_count = 64;
+
+template<std::size_t... Is>
+auto world_type(std::index_sequence<Is...>)
+    -> matter::world<matter::registry<
+        matter::default_component_identifier<matter::unsigned_id<std::size_t>,
+                                             position,
+                                             velocity,
+                                             tag<Is>...>>>;
+
+using world_t = decltype(world_type(std::make_index_sequence<group_count>{}));
+
+template<std::size_t... Is>
+void fill(world_t& w, std::size_t count, std::index_sequence<Is...>)
+{
+    auto create = [&](auto tag_c) {
+        for (std::size_t i = 0; i < count / group_count; ++i)
+        {
+            auto f = static_cast<float>(i);
+            w.create_entity<position, velocity, decltype(tag_c)>(
+                position{f, f, f}, velocity{1.f, 2.f, 3.f}, decltype(tag_c){});
+        }
+    };
+
+    (create(tag<Is>{}), ...);
+}
+
+template<typename Query>
+float sum_positions(Query& q, world_t& w)
+{
+    auto sum = 0.f;
+    for (auto [positions, velocities] : matter::process_query(q, w))
+    {
+        for (std::size_t i = 0; i < positions.size(); ++i)
+        {
+            sum += positions[i].x * velocities[i].x;
+        }
+    }
+    return sum;
+}
+
+// touches the positions of a single group, the only change per frame
+void touch_one_group(world_t& w)
+{
+    auto eq = matter::entities{boost::hana::type_c<matter::write<position>>,
+                               boost::hana::type_c<matter::has<tag<0>>>};
+
+    for (auto [positions, tags] : matter::process_query(eq, w))
+    {
+        (void) tags;
+        for (auto& pos : positions)
+        {
+            pos.x += 1.f;
+        }
+    }
+}
+
+// visit every group each frame
+void read_all(benchmark::State& state)
+{
+    auto    count = static_cast<std::size_t>(state.range(0));
+    world_t w;
+    fill(w, count, std::make_index_sequence<group_count>{});
+
+    auto eq = matter::entities{boost::hana::type_c<matter::read<position>>,
+                               boost::hana::type_c<matter::read<velocity>>};
+
+    for (auto _ : state)
+    {
+        if (state.range(1))
+        {
+            touch_one_group(w);
+        }
+        benchmark::DoNotOptimize(sum_positions(eq, w));
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+// only visit the groups in which positions changed since the last frame
+void read_changed(benchmark::State& state)
+{
+    auto    count = static_cast<std::size_t>(state.range(0));
+    world_t w;
+    fill(w, count, std::make_index_sequence<group_count>{});
+
+    auto eq = matter::entities{boost::hana::type_c<matter::changed<position>>,
+                               boost::hana::type_c<matter::read<velocity>>};
+
+    // the first run sees every group as changed
+    benchmark::DoNotOptimize(sum_positions(eq, w));
+
+    for (auto _ : state)
+    {
+        if (state.range(1))
+        {
+            touch_one_group(w);
+        }
+        benchmark::DoNotOptimize(sum_positions(eq, w));
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+// {entities, whether one of the groups changes every frame}
+BENCHMARK(read_all)
+    ->ArgsProduct({{1 << 16, 1 << 20}, {0, 1}})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(read_changed)
+    ->ArgsProduct({{1 << 16, 1 << 20}, {0, 1}})
+    ->Unit(benchmark::kMicrosecond);
+
+int main(int argc, char** argv)
+{
+    ::benchmark::Initialize(&argc, argv);
+    ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,150 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <utility>
+#include <vector>
+
+#include "matter/component/group_slice.hpp"
+#include "matter/component/registry.hpp"
+#include "matter/id/default_component_identifier.hpp"
+
+// too large to be stored inline by erased, forcing the storage header onto
+// the heap like every storage used to be.
+template<typename T>
+struct heap_vector : std::vector<T>
+{
+    std::array<void*, 4> padding{};
+};
+
+template<template<typename> typename Storage>
+struct position
+{
+    using storage_type = Storage<position>;
+
+    float x;
+    float y;
+    float z;
+};
+
+template<template<typename> typename Storage>
+struct velocity
+{
+    using storage_type = Storage<velocity>;
+
+    float x;
+    float y;
+    float z;
+};
+
+template<template<typename> typename Storage>
+struct acceleration
+{
+    using storage_type = Storage<acceleration>;
+
+    float x;
+    float y;
+    float z;
+};
+
+template<std::size_t I>
+struct tag
+{};
+
+template<typename T>
+using inline_vector = std::vector<T>;
+
+// the number of groups containing all 3 columns
+constexpr std::size_t group_count = 64;
+
+template<template<typename> typename Storage, std::size_t... Is>
+auto make_registry(std::size_t group_entities, std::index_sequence<Is...>)
+{
+    using pos_type = position<Storage>;
+    using vel_type = velocity<Storage>;
+    using acc_type = acceleration<Storage>;
+
+    auto reg = matter::registry<
+        matter::default_component_identifier<matter::unsigned_id<std::size_t>,
+                                             pos_type,
+                                             vel_type,
+                                             acc_type,
+                                             tag<Is>...>>{};
+
+    auto fill = [&](auto tag_c) {
+        using tag_type = decltype(tag_c);
+
+        auto buffer = reg.template create_buffer_for<pos_type,
+                                                     vel_type,
+                                                     acc_type,
+                                                     tag_type>();
+        buffer.resize(group_entities,
+                      pos_type{0.f, 0.f, 0.f},
+                      vel_type{1.f, 1.f, 1.f},
+                      acc_type{0.1f, 0.1f, 0.1f},
+                      tag_type{});
+        reg.insert(buffer);
+    };
+
+    (fill(tag<Is>{}), ...);
+
+    return reg;
+}
+
+template<template<typename> typename Storage>
+void multi_column_iterate(benchmark::State& state)
+{
+    using pos_type = position<Storage>;
+    using vel_type = velocity<Storage>;
+    using acc_type = acceleration<Storage>;
+
+    auto group_entities = static_cast<std::size_t>(state.range(0));
+
+    auto reg = make_registry<Storage>(group_entities,
+                                      std::make_index_sequence<group_count>{});
+    auto ids = reg.template component_ids<pos_type, vel_type, acc_type>();
+
+    for (auto _ : state)
+    {
+        for (auto grp : reg.group_container().range())
+        {
+            auto slice = matter::make_group_slice(grp, ids);
+
+            if (!slice)
+            {
+                continue;
+            }
+
+            for (auto view : *slice)
+            {
+                auto& pos = view.template get<pos_type>();
+                auto& vel = view.template get<vel_type>();
+                auto& acc = view.template get<acc_type>();
+
+                vel.x += acc.x;
+                vel.y += acc.y;
+                vel.z += acc.z;
+                pos.x += vel.x;
+                pos.y += vel.y;
+                pos.z += vel.z;
+            }
+        }
+
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * group_count *
+                            group_entities);
+}
+
+BENCHMARK_TEMPLATE(multi_column_iterate, inline_vector)
+    ->RangeMultiplier(8)
+    ->Range(1, 4096);
+BENCHMARK_TEMPLATE(multi_column_iterate, heap_vector)
+    ->RangeMultiplier(8)
+    ->Range(1, 4096);
+
+int main(int argc, char** argv)
+{
+    ::benchmark::Initialize(&argc, argv);
+    ::benchmark::RunSpecifiedBenchmarks();
+}
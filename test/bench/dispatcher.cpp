@@ -0,0 +1,177 @@
+#include <benchmark/benchmark.h>
+
+#include <tuple>
+#include <utility>
+
+#include "matter/component/registry.hpp"
+#include "matter/dispatcher.hpp"
+#include "matter/id/default_component_identifier.hpp"
+#include "matter/query/entities.hpp"
+#include "matter/system/job.hpp"
+#include "matter/world.hpp"
+
+template<std::size_t I>
+struct value
+{
+    float v;
+};
+
+constexpr std::size_t component_count = 8;
+constexpr std::size_t job_count       = 24;
+constexpr std::size_t entity_count    = 1 << 16;
+
+template<std::size_t... Is>
+auto world_type(std::index_sequence<Is...>)
+    -> matter::world<matter::registry<
+        matter::default_component_identifier<matter::unsigned_id<std::size_t>,
+                                             value<Is>...>>>;
+
+using world_t =
+    decltype(world_type(std::make_index_sequence<component_count>{}));
+
+template<std::size_t... Is>
+void fill(world_t& w, std::index_sequence<Is...>)
+{
+    for (std::size_t i = 0; i < entity_count; ++i)
+    {
+        w.create_entity<value<Is>...>(value<Is>{1.f}...);
+    }
+}
+
+// every third job writes a component, the others only read two of them. This
+// gives chains of conflicting jobs on each component with readers in between
+// which may run alongside each other.
+template<std::size_t I>
+auto make_bench_job()
+{
+    using boost::hana::type_c;
+
+    using first_type  = value<I % component_count>;
+    using second_type = value<(I + 3) % component_count>;
+
+    if constexpr (I % 3 == 0)
+    {
+        return matter::make_job<
+            matter::entities<matter::write<first_type>,
+                             matter::read<second_type>>>([](auto&& groups) {
+            for (auto [firsts, seconds] : groups)
+            {
+                for (std::size_t i = 0; i < firsts.size(); ++i)
+                {
+                    firsts[i].v = firsts[i].v * 0.5f + seconds[i].v;
+                }
+            }
+        });
+    }
+    else
+    {
+        return matter::make_job<
+            matter::entities<matter::read<first_type>,
+                             matter::read<second_type>>>([](auto&& groups) {
+            auto sum = 0.f;
+            for (auto [firsts, seconds] : groups)
+            {
+                for (std::size_t i = 0; i < firsts.size(); ++i)
+                {
+                    sum += firsts[i].v * seconds[i].v;
+                }
+            }
+            benchmark::DoNotOptimize(sum);
+        });
+    }
+}
+
+template<std::size_t... Is>
+auto make_jobs(std::index_sequence<Is...>)
+{
+    return std::tuple{make_bench_job<Is>()...};
+}
+
+// every job one after another on the calling thread
+void jobs_sequential(benchmark::State& state)
+{
+    world_t w;
+    fill(w, std::make_index_sequence<component_count>{});
+
+    auto jobs = make_jobs(std::make_index_sequence<job_count>{});
+
+    for (auto _ : state)
+    {
+        std::apply([&](auto&... js) { (matter::invoke_job(js, w), ...); },
+                   jobs);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * job_count * entity_count);
+}
+
+BENCHMARK(jobs_sequential)->Unit(benchmark::kMicrosecond);
+
+// the calling thread takes part, so the pool gets threads - 1 workers
+void jobs_parallel(benchmark::State& state)
+{
+    auto threads = static_cast<std::size_t>(state.range(0));
+
+    world_t w;
+    fill(w, std::make_index_sequence<component_count>{});
+
+    auto disp = std::apply(
+        [&](auto&&... js) {
+            return matter::parallel_dispatcher{w, std::move(js)...};
+        },
+        make_jobs(std::make_index_sequence<job_count>{}));
+
+    matter::thread_pool pool{threads - 1};
+
+    for (auto _ : state)
+    {
+        disp(pool);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * job_count * entity_count);
+}
+
+BENCHMARK(jobs_parallel)
+    ->RangeMultiplier(2)
+    ->Range(1, 16)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+// the same jobs in the stages planned at compile time
+void jobs_staged(benchmark::State& state)
+{
+    auto threads = static_cast<std::size_t>(state.range(0));
+
+    world_t w;
+    fill(w, std::make_index_sequence<component_count>{});
+
+    auto disp = std::apply(
+        [&](auto&&... js) {
+            return matter::staged_dispatcher{w, std::move(js)...};
+        },
+        make_jobs(std::make_index_sequence<job_count>{}));
+
+    matter::thread_pool pool{threads - 1};
+
+    for (auto _ : state)
+    {
+        disp(pool);
+        benchmark::ClobberMemory();
+    }
+
+    state.counters["stages"] = decltype(disp)::plan.stage_count;
+    state.SetItemsProcessed(state.iterations() * job_count * entity_count);
+}
+
+BENCHMARK(jobs_staged)
+    ->RangeMultiplier(2)
+    ->Range(1, 16)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+int main(int argc, char** argv)
+{
+    ::benchmark::Initialize(&argc, argv);
+    ::benchmark::RunSpecifiedBenchmarks();
+}
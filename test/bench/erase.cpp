@@ -0,0 +1,115 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include "matter/component/registry.hpp"
+#include "matter/id/default_component_identifier.hpp"
+
+struct position
+{
+    float x;
+    float y;
+    float z;
+};
+
+struct velocity
+{
+    float x;
+    float y;
+    float z;
+};
+
+struct acceleration
+{
+    float x;
+    float y;
+    float z;
+};
+
+using registry_type = matter::registry<
+    matter::default_component_identifier<matter::unsigned_id<std::size_t>,
+                                         position,
+                                         velocity,
+                                         acceleration>>;
+
+// fill the registry and pick a scattered tenth of the entities to erase
+std::vector<matter::entity> make_doomed(registry_type& reg, std::size_t count)
+{
+    auto buffer = reg.create_buffer_for<position, velocity, acceleration>();
+    buffer.resize(count,
+                  position{0.f, 0.f, 0.f},
+                  velocity{1.f, 1.f, 1.f},
+                  acceleration{0.1f, 0.1f, 0.1f});
+    reg.insert(buffer);
+
+    auto grp = reg.group_container().find_group(
+        reg.component_ids<position, velocity, acceleration>());
+
+    std::vector<matter::entity> doomed;
+    std::mt19937                gen{42};
+    std::bernoulli_distribution dist{0.1};
+
+    for (std::size_t row = 0; row < count; ++row)
+    {
+        if (dist(gen))
+        {
+            doomed.push_back(grp->entity_at(row));
+        }
+    }
+
+    return doomed;
+}
+
+void erase_single(benchmark::State& state)
+{
+    auto count = static_cast<std::size_t>(state.range(0));
+
+    std::size_t erased{0};
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        registry_type reg;
+        auto          doomed = make_doomed(reg, count);
+        state.ResumeTiming();
+
+        for (const auto& ent : doomed)
+        {
+            reg.destroy(ent);
+        }
+
+        erased += doomed.size();
+    }
+
+    state.SetItemsProcessed(erased);
+}
+
+BENCHMARK(erase_single)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+void erase_bulk(benchmark::State& state)
+{
+    auto count = static_cast<std::size_t>(state.range(0));
+
+    std::size_t erased{0};
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        registry_type reg;
+        auto          doomed = make_doomed(reg, count);
+        state.ResumeTiming();
+
+        erased += reg.destroy(doomed.begin(), doomed.end());
+    }
+
+    state.SetItemsProcessed(erased);
+}
+
+BENCHMARK(erase_bulk)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+int main(int argc, char** argv)
+{
+    ::benchmark::Initialize(&argc, argv);
+    ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,164 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "matter/component/group_container.hpp"
+#include "matter/id/default_component_identifier.hpp"
+
+template<std::size_t I>
+struct tag_component
+{
+    int value;
+};
+
+using id_type = matter::unsigned_id<std::size_t>;
+
+// the number of distinct components, allows for 2^12 - 1 archetypes
+constexpr std::size_t component_count = 12;
+
+template<std::size_t... Is>
+auto make_identifier(std::index_sequence<Is...>)
+{
+    matter::default_component_identifier<id_type> ident;
+    (ident.template register_component<tag_component<Is>>(), ...);
+    return ident;
+}
+
+template<std::size_t... Is>
+auto make_source(matter::group_container<id_type>&              cont,
+                 matter::default_component_identifier<id_type>& ident,
+                 std::index_sequence<Is...>)
+{
+    cont.try_emplace_group(
+        ident.template component_ids<tag_component<Is>...>());
+    // copy the ids so the returned ids aren't viewing a temporary
+    auto ordered_ids =
+        ident.template ordered_component_ids<tag_component<Is>...>();
+    return std::vector<id_type>(ordered_ids.begin(), ordered_ids.end());
+}
+
+// the ids of every archetype, an archetype is a subset of all components
+std::vector<std::vector<id_type>>
+make_archetypes(const std::vector<id_type>& all_ids, std::size_t count)
+{
+    std::vector<std::vector<id_type>> archetypes;
+    archetypes.reserve(count);
+
+    for (std::size_t mask = 1; archetypes.size() < count; ++mask)
+    {
+        auto& ids = archetypes.emplace_back();
+
+        for (std::size_t i = 0; i < all_ids.size(); ++i)
+        {
+            if (mask & (std::size_t{1} << i))
+            {
+                ids.push_back(all_ids[i]);
+            }
+        }
+    }
+
+    return archetypes;
+}
+
+void fill_container(matter::group_container<id_type>&        cont,
+                    const std::vector<id_type>&              all_ids,
+                    const std::vector<std::vector<id_type>>& archetypes)
+{
+    auto source = *cont.find_group(matter::ordered_untyped_ids{all_ids});
+
+    for (const auto& ids : archetypes)
+    {
+        cont.try_emplace(source, matter::ordered_untyped_ids{ids});
+    }
+}
+
+void group_creation(benchmark::State& state)
+{
+    auto seq   = std::make_index_sequence<component_count>{};
+    auto ident = make_identifier(seq);
+
+    auto count = static_cast<std::size_t>(state.range(0));
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        matter::group_container<id_type> cont;
+        auto all_ids    = make_source(cont, ident, seq);
+        auto archetypes = make_archetypes(all_ids, count);
+        state.ResumeTiming();
+
+        fill_container(cont, all_ids, archetypes);
+        benchmark::DoNotOptimize(cont.size());
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK(group_creation)->RangeMultiplier(4)->Range(16, 4095);
+
+void group_lookup(benchmark::State& state)
+{
+    auto seq   = std::make_index_sequence<component_count>{};
+    auto ident = make_identifier(seq);
+
+    auto count = static_cast<std::size_t>(state.range(0));
+
+    matter::group_container<id_type> cont;
+    auto all_ids    = make_source(cont, ident, seq);
+    auto archetypes = make_archetypes(all_ids, count);
+    fill_container(cont, all_ids, archetypes);
+
+    // look up in random order to avoid favouring any layout
+    std::vector<std::size_t>                   order(1024);
+    std::mt19937                               gen{42};
+    std::uniform_int_distribution<std::size_t> dist{0, count - 1};
+    for (auto& o : order)
+    {
+        o = dist(gen);
+    }
+
+    for (auto _ : state)
+    {
+        for (auto o : order)
+        {
+            auto grp =
+                cont.find_group(matter::ordered_untyped_ids{archetypes[o]});
+            benchmark::DoNotOptimize(grp);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * order.size());
+}
+
+BENCHMARK(group_lookup)->RangeMultiplier(4)->Range(16, 4095);
+
+void group_try_emplace_existing(benchmark::State& state)
+{
+    auto seq   = std::make_index_sequence<component_count>{};
+    auto ident = make_identifier(seq);
+
+    auto count = static_cast<std::size_t>(state.range(0));
+
+    matter::group_container<id_type> cont;
+    auto all_ids    = make_source(cont, ident, seq);
+    auto archetypes = make_archetypes(all_ids, count);
+    fill_container(cont, all_ids, archetypes);
+
+    for (auto _ : state)
+    {
+        // the typed path, as taken by registry::create
+        auto grp = cont.try_emplace_group(
+            ident.component_ids<tag_component<1>, tag_component<3>>());
+        benchmark::DoNotOptimize(grp);
+    }
+}
+
+BENCHMARK(group_try_emplace_existing)->RangeMultiplier(4)->Range(16, 4095);
+
+int main(int argc, char** argv)
+{
+    ::benchmark::Initialize(&argc, argv);
+    ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,104 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "matter/component/registry.hpp"
+#include "matter/id/default_component_identifier.hpp"
+
+struct position
+{
+    float x;
+    float y;
+    float z;
+};
+
+struct velocity
+{
+    float x;
+    float y;
+    float z;
+};
+
+struct frozen
+{
+    int frames;
+};
+
+using registry_type = matter::registry<
+    matter::default_component_identifier<matter::unsigned_id<std::size_t>,
+                                         position,
+                                         velocity,
+                                         frozen>>;
+
+std::vector<matter::entity> make_entities(registry_type& reg,
+                                          std::size_t    count)
+{
+    std::vector<matter::entity> ents;
+    ents.reserve(count);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto f = static_cast<float>(i);
+        ents.push_back(reg.create<position, velocity>(position{f, f, f},
+                                                      velocity{1.f, 1.f, 1.f}));
+    }
+
+    return ents;
+}
+
+// toggle a component on every other entity, one entity at a time
+void migrate_single(benchmark::State& state)
+{
+    auto count = static_cast<std::size_t>(state.range(0));
+
+    registry_type reg;
+    auto          ents = make_entities(reg, count);
+
+    for (auto _ : state)
+    {
+        for (std::size_t i = 0; i < count; i += 2)
+        {
+            reg.add_component<frozen>(ents[i], frozen{1});
+        }
+
+        for (std::size_t i = 0; i < count; i += 2)
+        {
+            reg.remove_component<frozen>(ents[i]);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK(migrate_single)->RangeMultiplier(8)->Range(1 << 8, 1 << 20);
+
+// toggle a component on every other entity, all at once
+void migrate_batched(benchmark::State& state)
+{
+    auto count = static_cast<std::size_t>(state.range(0));
+
+    registry_type reg;
+    auto          ents = make_entities(reg, count);
+
+    std::vector<matter::entity> selected;
+    for (std::size_t i = 0; i < count; i += 2)
+    {
+        selected.push_back(ents[i]);
+    }
+
+    for (auto _ : state)
+    {
+        reg.add_component(selected.begin(), selected.end(), frozen{1});
+        reg.remove_component<frozen>(selected.begin(), selected.end());
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK(migrate_batched)->RangeMultiplier(8)->Range(1 << 8, 1 << 20);
+
+int main(int argc, char** argv)
+{
+    ::benchmark::Initialize(&argc, argv);
+    ::benchmark::RunSpecifiedBenchmarks();
+}
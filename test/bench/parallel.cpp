@@ -0,0 +1,140 @@
+#include <benchmark/benchmark.h>
+
+#include <map>
+#include <memory>
+#include <utility>
+
+#include "matter/component/registry.hpp"
+#include "matter/id/default_component_identifier.hpp"
+#include "matter/query/entities.hpp"
+#include "matter/query/processor.hpp"
+#include "matter/util/thread_pool.hpp"
+#include "matter/world.hpp"
+
+struct position
+{
+    float x;
+    float y;
+    float z;
+};
+
+struct velocity
+{
+    float x;
+    float y;
+    float z;
+};
+
+template<std::size_t I>
+struct tag
+{};
+
+// the number of small groups next to the one holding half of all entities
+constexpr std::size_t small_groups = 64;
+
+template<std::size_t... Is>
+auto world_type(std::index_sequence<Is...>)
+    -> matter::world<matter::registry<
+        matter::default_component_identifier<matter::unsigned_id<std::size_t>,
+                                             position,
+                                             velocity,
+                                             tag<Is>...>>>;
+
+using world_t = decltype(world_type(std::make_index_sequence<small_groups>{}));
+
+template<std::size_t... Is>
+void fill(world_t& w, std::size_t count, std::index_sequence<Is...>)
+{
+    auto create = [&](auto tag_c, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            auto f = static_cast<float>(i);
+            w.create_entity<position, velocity, decltype(tag_c)>(
+                position{f, f, f}, velocity{1.f, 2.f, 3.f}, decltype(tag_c){});
+        }
+    };
+
+    // one huge group and many small ones, the worst case for splitting the
+    // work per group
+    for (std::size_t i = 0; i < count / 2; ++i)
+    {
+        w.create_entity<position, velocity>(position{0.f, 0.f, 0.f},
+                                            velocity{1.f, 2.f, 3.f});
+    }
+    (create(tag<Is>{}, count / 2 / small_groups), ...);
+}
+
+// the worlds are expensive to fill so they're shared between runs
+world_t& make_world(std::size_t count)
+{
+    static std::map<std::size_t, std::unique_ptr<world_t>> worlds;
+
+    auto& w = worlds[count];
+    if (!w)
+    {
+        w = std::make_unique<world_t>();
+        fill(*w, count, std::make_index_sequence<small_groups>{});
+    }
+
+    return *w;
+}
+
+constexpr auto movement = [](position& pos, const velocity& vel) {
+    pos.x += vel.x;
+    pos.y += vel.y;
+    pos.z += vel.z;
+};
+
+void movement_seq(benchmark::State& state)
+{
+    auto  count = static_cast<std::size_t>(state.range(0));
+    auto& w     = make_world(count);
+    auto  eq    = matter::entities{boost::hana::type_c<matter::write<position>>,
+                               boost::hana::type_c<matter::read<velocity>>};
+
+    for (auto _ : state)
+    {
+        matter::for_each(matter::execution::unseq, eq, w, movement);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK(movement_seq)
+    ->Arg(1 << 16)
+    ->Arg(1 << 20)
+    ->Arg(5'000'000)
+    ->Unit(benchmark::kMicrosecond);
+
+// the calling thread takes part, so the pool gets threads - 1 workers
+void movement_par(benchmark::State& state)
+{
+    auto  count   = static_cast<std::size_t>(state.range(0));
+    auto  threads = static_cast<std::size_t>(state.range(1));
+    auto& w       = make_world(count);
+    auto  eq      = matter::entities{boost::hana::type_c<matter::write<position>>,
+                               boost::hana::type_c<matter::read<velocity>>};
+
+    matter::thread_pool pool{threads - 1};
+    auto                policy = matter::execution::par.on(pool);
+
+    for (auto _ : state)
+    {
+        matter::for_each(policy, eq, w, movement);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK(movement_par)
+    ->ArgsProduct({{1 << 16, 1 << 20, 5'000'000}, {1, 2, 4, 8, 16}})
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+int main(int argc, char** argv)
+{
+    ::benchmark::Initialize(&argc, argv);
+    ::benchmark::RunSpecifiedBenchmarks();
+}
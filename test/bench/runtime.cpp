@@ -0,0 +1,143 @@
+#include <benchmark/benchmark.h>
+
+#include <utility>
+
+#include "matter/component/registry.hpp"
+#include "matter/id/default_component_identifier.hpp"
+#include "matter/query/entities.hpp"
+#include "matter/query/processor.hpp"
+#include "matter/query/runtime_entities.hpp"
+#include "matter/world.hpp"
+
+struct position
+{
+    float x;
+    float y;
+    float z;
+};
+
+struct velocity
+{
+    float x;
+    float y;
+    float z;
+};
+
+template<std::size_t I>
+struct tag
+{};
+
+constexpr std::size_t group_count = 64;
+
+template<std::size_t... Is>
+auto world_type(std::index_sequence<Is...>)
+    -> matter::world<matter::registry<
+        matter::default_component_identifier<matter::unsigned_id<std::size_t>,
+                                             position,
+                                             velocity,
+                                             tag<Is>...>>>;
+
+using world_t = decltype(world_type(std::make_index_sequence<group_count>{}));
+
+// half of the groups have velocities
+template<std::size_t... Is>
+void fill(world_t& w, std::size_t count, std::index_sequence<Is...>)
+{
+    auto create = [&](auto tag_c) {
+        using tag_type = tag<decltype(tag_c)::value>;
+
+        for (std::size_t i = 0; i < count / group_count; ++i)
+        {
+            auto f = static_cast<float>(i);
+            if constexpr (decltype(tag_c)::value % 2 == 0)
+            {
+                w.create_entity<position, velocity, tag_type>(
+                    position{f, f, f}, velocity{1.f, 2.f, 3.f}, tag_type{});
+            }
+            else
+            {
+                w.create_entity<position, tag_type>(position{f, f, f},
+                                                    tag_type{});
+            }
+        }
+    };
+
+    (create(std::integral_constant<std::size_t, Is>{}), ...);
+}
+
+void integrate(matter::component_storage_t<position>&       positions,
+               const matter::component_storage_t<velocity>& velocities)
+{
+    for (std::size_t i = 0; i < positions.size(); ++i)
+    {
+        positions[i].x += velocities[i].x;
+        positions[i].y += velocities[i].y;
+        positions[i].z += velocities[i].z;
+    }
+}
+
+void query_static(benchmark::State& state)
+{
+    auto    count = static_cast<std::size_t>(state.range(0));
+    world_t w;
+    fill(w, count, std::make_index_sequence<group_count>{});
+
+    auto eq = matter::entities{boost::hana::type_c<matter::write<position>>,
+                               boost::hana::type_c<matter::read<velocity>>};
+
+    for (auto _ : state)
+    {
+        for (auto [positions, velocities] : matter::process_query(eq, w))
+        {
+            integrate(positions, velocities);
+        }
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * count / 2);
+}
+
+// the same query built from component ids, the loop is typed again as a
+// script binding would hand the columns to a typed kernel
+void query_runtime(benchmark::State& state)
+{
+    using description = matter::component_query_description<world_t::id_type>;
+
+    auto    count = static_cast<std::size_t>(state.range(0));
+    world_t w;
+    fill(w, count, std::make_index_sequence<group_count>{});
+
+    auto rq = matter::runtime_entities{
+        description{w.component_id<position>(),
+                    matter::access::write,
+                    matter::presence::require},
+        description{w.component_id<velocity>(),
+                    matter::access::read,
+                    matter::presence::require}};
+
+    for (auto _ : state)
+    {
+        for (auto& res : matter::process_query(rq, w))
+        {
+            integrate(res[0]->get<position>(), res[1]->get<velocity>());
+        }
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * count / 2);
+}
+
+BENCHMARK(query_static)
+    ->RangeMultiplier(16)
+    ->Range(1 << 8, 1 << 20)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(query_runtime)
+    ->RangeMultiplier(16)
+    ->Range(1 << 8, 1 << 20)
+    ->Unit(benchmark::kMicrosecond);
+
+int main(int argc, char** argv)
+{
+    ::benchmark::Initialize(&argc, argv);
+    ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,219 @@
+#include <benchmark/benchmark.h>
+
+#include <utility>
+#include <vector>
+
+#include "matter/component/registry.hpp"
+#include "matter/id/default_component_identifier.hpp"
+#include "matter/query/processor.hpp"
+#include "matter/query/runtime_entities.hpp"
+
+struct position
+{
+    float x;
+    float y;
+    float z;
+};
+
+template<std::size_t I>
+struct tag
+{};
+
+constexpr std::size_t tag_count       = 64;
+constexpr std::size_t archetype_count = 10000;
+
+template<std::size_t... Is>
+auto registry_type(std::index_sequence<Is...>)
+    -> matter::registry<
+        matter::default_component_identifier<matter::unsigned_id<std::size_t>,
+                                             position,
+                                             tag<Is>...>>;
+
+using registry_t =
+    decltype(registry_type(std::make_index_sequence<tag_count>{}));
+using id_type     = registry_t::id_type;
+using description = matter::component_query_description<id_type>;
+
+template<std::size_t... Is>
+void add_tag(registry_t&                  reg,
+             const registry_t::entity_type& ent,
+             std::size_t                  index,
+             std::index_sequence<Is...>)
+{
+    ((index == Is ? (void) reg.add_component<tag<Is>>(ent) : (void) 0), ...);
+}
+
+// archetype k holds a position and a tag for every bit set in k, adding the
+// tags one by one creates every archetype below archetype_count.
+void fill(registry_t& reg)
+{
+    for (std::size_t k = 0; k < archetype_count; ++k)
+    {
+        auto ent = reg.create<position>(position{1.f, 2.f, 3.f});
+
+        for (std::size_t bit = 0; bit < tag_count; ++bit)
+        {
+            if (k & (std::size_t{1} << bit))
+            {
+                add_tag(reg, ent, bit, std::make_index_sequence<tag_count>{});
+            }
+        }
+    }
+}
+
+using boost::hana::type_c;
+
+constexpr auto static_query = std::tuple{type_c<matter::read<position>>,
+                                         type_c<matter::has<tag<3>>>,
+                                         type_c<matter::has<tag<7>>>,
+                                         type_c<matter::has_not<tag<12>>>};
+
+// searching the stores of every group for each component
+void static_sorted_ids(benchmark::State& state)
+{
+    registry_t reg;
+    fill(reg);
+
+    for (auto _ : state)
+    {
+        std::size_t matches = 0;
+        for (auto grp : reg.group_container().range())
+        {
+            auto res = std::apply(
+                [&](auto... tqs) {
+                    return matter::filter_group(
+                        grp, reg, matter::query_versions{}, tqs...);
+                },
+                static_query);
+            matches += res.has_value();
+        }
+        benchmark::DoNotOptimize(matches);
+    }
+
+    state.SetItemsProcessed(state.iterations() *
+                            reg.group_container().group_count());
+}
+
+// rejecting groups by their signature first
+void static_signature(benchmark::State& state)
+{
+    registry_t reg;
+    fill(reg);
+
+    auto mask = std::apply(
+        [&](auto... tqs) { return matter::query_signature_mask(reg, tqs...); },
+        static_query);
+
+    for (auto _ : state)
+    {
+        std::size_t matches = 0;
+        for (auto grp : reg.group_container().range())
+        {
+            auto res = std::apply(
+                [&](auto... tqs) {
+                    return matter::filter_group(
+                        grp, reg, mask, matter::query_versions{}, tqs...);
+                },
+                static_query);
+            matches += res.has_value();
+        }
+        benchmark::DoNotOptimize(matches);
+    }
+
+    state.SetItemsProcessed(state.iterations() *
+                            reg.group_container().group_count());
+}
+
+// a query over all 65 components, requiring position and two tags and
+// excluding every other tag
+template<std::size_t... Is>
+std::vector<description> wide_descriptions(const registry_t& reg,
+                                           std::index_sequence<Is...>)
+{
+    std::vector<description> descriptions{
+        description{reg.component_id<position>(),
+                    matter::access::read,
+                    matter::presence::require}};
+
+    (descriptions.push_back(
+         description{reg.component_id<tag<Is>>(),
+                     matter::access::inaccessible,
+                     Is == 3 || Is == 7 ? matter::presence::require
+                                        : matter::presence::exclude}),
+     ...);
+
+    return descriptions;
+}
+
+// the sorted ids of each group are merged with the required and excluded ids
+void runtime_sorted_ids(benchmark::State& state)
+{
+    registry_t reg;
+    fill(reg);
+
+    auto descriptions =
+        wide_descriptions(reg, std::make_index_sequence<tag_count>{});
+
+    std::vector<id_type> required;
+    std::vector<id_type> excluded;
+    for (auto& descr : descriptions)
+    {
+        (descr.is_required() ? required : excluded).push_back(descr.id());
+    }
+    std::sort(required.begin(), required.end());
+    std::sort(excluded.begin(), excluded.end());
+
+    for (auto _ : state)
+    {
+        std::size_t matches = 0;
+        for (auto grp : reg.group_container().range())
+        {
+            if (!grp.contains(matter::ordered_untyped_ids<id_type>{required}))
+            {
+                continue;
+            }
+
+            auto has_excluded = std::any_of(
+                excluded.begin(), excluded.end(), [&](const id_type& id) {
+                    return grp.contains(id);
+                });
+            matches += !has_excluded;
+        }
+        benchmark::DoNotOptimize(matches);
+    }
+
+    state.SetItemsProcessed(state.iterations() *
+                            reg.group_container().group_count());
+}
+
+void runtime_signature(benchmark::State& state)
+{
+    registry_t reg;
+    fill(reg);
+
+    auto descriptions =
+        wide_descriptions(reg, std::make_index_sequence<tag_count>{});
+    auto rq = matter::runtime_entities<id_type>{descriptions.begin(),
+                                                descriptions.end()};
+
+    for (auto _ : state)
+    {
+        auto& res = matter::process_entity_query(
+            rq, reg.group_container().range(), reg);
+        benchmark::DoNotOptimize(res.size());
+    }
+
+    state.SetItemsProcessed(state.iterations() *
+                            reg.group_container().group_count());
+}
+
+BENCHMARK(static_sorted_ids)->Unit(benchmark::kMicrosecond);
+BENCHMARK(static_signature)->Unit(benchmark::kMicrosecond);
+BENCHMARK(runtime_sorted_ids)->Unit(benchmark::kMicrosecond);
+BENCHMARK(runtime_signature)->Unit(benchmark::kMicrosecond);
+
+int main(int argc, char** argv)
+{
+    ::benchmark::Initialize(&argc, argv);
+    ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,186 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "matter/component/group_slice.hpp"
+#include "matter/component/registry.hpp"
+#include "matter/id/default_component_identifier.hpp"
+#include "matter/storage/chunked_storage.hpp"
+
+struct vec_position
+{
+    float x;
+    float y;
+    float z;
+};
+
+struct chunked_position
+{
+    using storage_type = matter::chunked_storage<chunked_position>;
+
+    float x;
+    float y;
+    float z;
+};
+
+template<typename Storage>
+Storage make_filled(std::size_t count)
+{
+    Storage storage;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto f = static_cast<float>(i);
+        storage.push_back({f, f, f});
+    }
+
+    return storage;
+}
+
+template<typename Storage>
+void storage_push_back(benchmark::State& state)
+{
+    auto count = static_cast<std::size_t>(state.range(0));
+
+    for (auto _ : state)
+    {
+        auto storage = make_filled<Storage>(count);
+        benchmark::DoNotOptimize(storage.size());
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK_TEMPLATE(storage_push_back, std::vector<vec_position>)
+    ->RangeMultiplier(16)
+    ->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(storage_push_back, matter::chunked_storage<vec_position>)
+    ->RangeMultiplier(16)
+    ->Range(1 << 10, 1 << 22);
+
+template<typename Storage>
+void storage_iterate(benchmark::State& state)
+{
+    auto count   = static_cast<std::size_t>(state.range(0));
+    auto storage = make_filled<Storage>(count);
+
+    for (auto _ : state)
+    {
+        float sum = 0.f;
+        for (const auto& pos : storage)
+        {
+            sum += pos.x + pos.y + pos.z;
+        }
+
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK_TEMPLATE(storage_iterate, std::vector<vec_position>)
+    ->RangeMultiplier(16)
+    ->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(storage_iterate, matter::chunked_storage<vec_position>)
+    ->RangeMultiplier(16)
+    ->Range(1 << 10, 1 << 22);
+
+template<typename Storage>
+void storage_index(benchmark::State& state)
+{
+    auto count   = static_cast<std::size_t>(state.range(0));
+    auto storage = make_filled<Storage>(count);
+
+    for (auto _ : state)
+    {
+        float sum = 0.f;
+        for (std::size_t i = 0; i < storage.size(); ++i)
+        {
+            sum += storage[i].x + storage[i].y + storage[i].z;
+        }
+
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK_TEMPLATE(storage_index, std::vector<vec_position>)
+    ->RangeMultiplier(16)
+    ->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(storage_index, matter::chunked_storage<vec_position>)
+    ->RangeMultiplier(16)
+    ->Range(1 << 10, 1 << 22);
+
+void chunked_storage_iterate_chunks(benchmark::State& state)
+{
+    auto count   = static_cast<std::size_t>(state.range(0));
+    auto storage = make_filled<matter::chunked_storage<vec_position>>(count);
+
+    for (auto _ : state)
+    {
+        float sum = 0.f;
+        for (std::size_t c = 0; c < storage.chunk_count(); ++c)
+        {
+            const auto* data   = storage.chunk_data(c);
+            auto        extent = storage.chunk_extent(c);
+
+            for (std::size_t i = 0; i < extent; ++i)
+            {
+                sum += data[i].x + data[i].y + data[i].z;
+            }
+        }
+
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK(chunked_storage_iterate_chunks)
+    ->RangeMultiplier(16)
+    ->Range(1 << 10, 1 << 22);
+
+template<typename Position>
+void group_iterate(benchmark::State& state)
+{
+    auto count = static_cast<std::size_t>(state.range(0));
+
+    auto reg = matter::registry<matter::default_component_identifier<
+        matter::unsigned_id<std::size_t>,
+        Position>>{};
+
+    auto buffer = reg.template create_buffer_for<Position>();
+    buffer.resize(count, Position{1.f, 2.f, 3.f});
+    reg.insert(buffer);
+
+    auto grp = *reg.group_container().find_group(
+        reg.template component_ids<Position>());
+
+    for (auto _ : state)
+    {
+        float sum = 0.f;
+        for (auto view : grp)
+        {
+            const auto& pos = view.template get<Position>();
+            sum += pos.x + pos.y + pos.z;
+        }
+
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK_TEMPLATE(group_iterate, vec_position)
+    ->RangeMultiplier(16)
+    ->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(group_iterate, chunked_position)
+    ->RangeMultiplier(16)
+    ->Range(1 << 10, 1 << 22);
+
+int main(int argc, char** argv)
+{
+    ::benchmark::Initialize(&argc, argv);
+    ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,587 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstring>
+#include <random>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "matter/component/registry.hpp"
+#include "matter/id/default_component_identifier.hpp"
+#include "matter/query/entities.hpp"
+#include "matter/query/processor.hpp"
+#include "matter/util/thread_pool.hpp"
+
+// The benchmarks tracked for regressions, covering creation, bulk insertion,
+// iteration, query matching, erasure and group creation over entity counts
+// from 1e3 to 1e7, component widths and archetype counts.
+// Results are written as JSON unless another --benchmark_format is passed, use
+// --benchmark_filter to run a subset.
+
+struct position
+{
+    float x;
+    float y;
+    float z;
+};
+
+struct velocity
+{
+    float x;
+    float y;
+    float z;
+};
+
+// a component Bytes wide, only its first value is read
+template<std::size_t Bytes>
+struct payload
+{
+    std::array<float, Bytes / sizeof(float)> values;
+};
+
+template<std::size_t I>
+struct tag
+{};
+
+// 2^12 archetypes can be made from the tags
+constexpr std::size_t tag_count = 12;
+
+template<std::size_t... Is>
+auto registry_type(std::index_sequence<Is...>)
+    -> matter::registry<
+        matter::default_component_identifier<matter::unsigned_id<std::size_t>,
+                                             position,
+                                             velocity,
+                                             payload<16>,
+                                             payload<64>,
+                                             payload<256>,
+                                             tag<Is>...>>;
+
+using registry_t =
+    decltype(registry_type(std::make_index_sequence<tag_count>{}));
+using entity_t = registry_t::entity_type;
+
+using boost::hana::type_c;
+
+constexpr std::int64_t min_entities = 1000;
+constexpr std::int64_t max_entities = 10000000;
+
+// insert count entities holding Cs... at once and return their handles
+template<typename... Cs>
+std::vector<entity_t>
+fill(registry_t& reg, std::size_t count, const Cs&... values)
+{
+    auto buffer = reg.create_buffer_for<Cs...>();
+    buffer.resize(count, values...);
+    reg.insert(buffer);
+
+    auto grp = *reg.group_container().find_group(reg.component_ids<Cs...>());
+
+    std::vector<entity_t> ents;
+    ents.reserve(count);
+    for (auto row = grp.size() - count; row < grp.size(); ++row)
+    {
+        ents.push_back(grp.entity_at(row));
+    }
+
+    return ents;
+}
+
+template<std::size_t... Is>
+void add_tag(registry_t&                  reg,
+             std::vector<entity_t>&       ents,
+             std::size_t                  index,
+             std::index_sequence<Is...>)
+{
+    ((index == Is ? reg.add_component<tag<Is>>(ents.begin(), ents.end())
+                  : void()),
+     ...);
+}
+
+// spread count entities round robin over archetypes groups, which must be a
+// power of two. Archetype k holds a position, a velocity and a tag for every
+// bit set in k.
+std::vector<entity_t>
+fill_archetypes(registry_t& reg, std::size_t count, std::size_t archetypes)
+{
+    auto ents =
+        fill(reg, count, position{0.f, 0.f, 0.f}, velocity{1.f, 1.f, 1.f});
+
+    std::vector<entity_t> tagged;
+    for (std::size_t bit = 0; (std::size_t{1} << bit) < archetypes; ++bit)
+    {
+        tagged.clear();
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if ((i % archetypes) & (std::size_t{1} << bit))
+            {
+                tagged.push_back(ents[i]);
+            }
+        }
+
+        add_tag(reg, tagged, bit, std::make_index_sequence<tag_count>{});
+    }
+
+    return ents;
+}
+
+// a scattered tenth of ents
+std::vector<entity_t> pick_doomed(const std::vector<entity_t>& ents)
+{
+    std::vector<entity_t>       doomed;
+    std::mt19937                gen{42};
+    std::bernoulli_distribution dist{0.1};
+
+    for (const auto& ent : ents)
+    {
+        if (dist(gen))
+        {
+            doomed.push_back(ent);
+        }
+    }
+
+    return doomed;
+}
+
+// integrate every matching position, returns the number of visited rows
+template<typename Query>
+std::size_t integrate(Query& eq, registry_t& reg)
+{
+    std::size_t rows = 0;
+
+    for (auto [positions, velocities] : matter::process_entity_query(
+             eq, reg.group_container().range(), reg))
+    {
+        auto size = std::size(positions);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            positions[i].x += velocities[i].x;
+            positions[i].y += velocities[i].y;
+            positions[i].z += velocities[i].z;
+        }
+        rows += size;
+    }
+
+    return rows;
+}
+
+void create_single(benchmark::State& state)
+{
+    auto count = static_cast<std::size_t>(state.range(0));
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        {
+            registry_t reg;
+            state.ResumeTiming();
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                reg.create<position, velocity>(position{0.f, 0.f, 0.f},
+                                               velocity{1.f, 1.f, 1.f});
+            }
+
+            state.PauseTiming();
+        }
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(create_single)
+    ->RangeMultiplier(10)
+    ->Range(min_entities, max_entities)
+    ->Unit(benchmark::kMillisecond);
+
+// every entity gets a copy of the same components
+void create_n_fill(benchmark::State& state)
+{
+    auto count = static_cast<std::size_t>(state.range(0));
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        {
+            registry_t reg;
+            state.ResumeTiming();
+
+            reg.create_n<position, velocity>(
+                count, position{0.f, 0.f, 0.f}, velocity{1.f, 1.f, 1.f});
+
+            state.PauseTiming();
+        }
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(create_n_fill)
+    ->RangeMultiplier(10)
+    ->Range(min_entities, max_entities)
+    ->Unit(benchmark::kMillisecond);
+
+// every entity is constructed from a generator
+void create_n_generate(benchmark::State& state)
+{
+    auto count = static_cast<std::size_t>(state.range(0));
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        {
+            registry_t reg;
+            state.ResumeTiming();
+
+            reg.create_n<position, velocity>(count, [](std::size_t i) {
+                auto f = static_cast<float>(i);
+                return std::tuple{position{f, f, f}, velocity{1.f, 1.f, 1.f}};
+            });
+
+            state.PauseTiming();
+        }
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(create_n_generate)
+    ->RangeMultiplier(10)
+    ->Range(min_entities, max_entities)
+    ->Unit(benchmark::kMillisecond);
+
+// only the copy from an already filled insert_buffer into the group
+void insert_bulk(benchmark::State& state)
+{
+    auto count = static_cast<std::size_t>(state.range(0));
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        {
+            registry_t reg;
+            auto       buffer = reg.create_buffer_for<position, velocity>();
+            buffer.resize(
+                count, position{0.f, 0.f, 0.f}, velocity{1.f, 1.f, 1.f});
+            state.ResumeTiming();
+
+            reg.insert(buffer);
+
+            state.PauseTiming();
+        }
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * state.range(0) *
+                            (sizeof(position) + sizeof(velocity)));
+}
+
+BENCHMARK(insert_bulk)
+    ->RangeMultiplier(10)
+    ->Range(min_entities, max_entities)
+    ->Unit(benchmark::kMillisecond);
+
+// fill an insert_buffer like a level loader, on one thread and on the pool
+template<typename Policy>
+void fill_buffer(benchmark::State& state)
+{
+    auto count = static_cast<std::size_t>(state.range(0));
+
+    registry_t reg;
+    auto       buffer = reg.create_buffer_for<position, velocity>();
+
+    auto row = [](std::size_t i) {
+        auto f = static_cast<float>(i);
+        return std::tuple{position{f, f, f}, velocity{1.f, 1.f, 1.f}};
+    };
+
+    for (auto _ : state)
+    {
+        buffer.clear();
+
+        if constexpr (std::is_same_v<Policy,
+                                     matter::execution::parallel_policy>)
+        {
+            buffer.generate(matter::execution::par, count, row);
+        }
+        else
+        {
+            buffer.generate(count, row);
+        }
+
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(fill_buffer, matter::execution::sequenced_policy)
+    ->RangeMultiplier(10)
+    ->Range(min_entities, max_entities)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(fill_buffer, matter::execution::parallel_policy)
+    ->RangeMultiplier(10)
+    ->Range(min_entities, max_entities)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+// all entities in a single group
+void iterate(benchmark::State& state)
+{
+    auto count = static_cast<std::size_t>(state.range(0));
+
+    registry_t reg;
+    fill(reg, count, position{0.f, 0.f, 0.f}, velocity{1.f, 1.f, 1.f});
+
+    auto eq = matter::entities{type_c<matter::write<position>>,
+                               type_c<matter::read<velocity>>};
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(integrate(eq, reg));
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(iterate)
+    ->RangeMultiplier(10)
+    ->Range(min_entities, max_entities)
+    ->Unit(benchmark::kMicrosecond);
+
+// read a component Bytes wide into the position of each entity
+template<std::size_t Bytes>
+void iterate_width(benchmark::State& state)
+{
+    auto count = static_cast<std::size_t>(state.range(0));
+
+    registry_t reg;
+    fill(reg, count, position{0.f, 0.f, 0.f}, payload<Bytes>{});
+
+    auto eq = matter::entities{type_c<matter::write<position>>,
+                               type_c<matter::read<payload<Bytes>>>};
+
+    for (auto _ : state)
+    {
+        for (auto [positions, payloads] : matter::process_entity_query(
+                 eq, reg.group_container().range(), reg))
+        {
+            auto size = std::size(positions);
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                positions[i].x += payloads[i].values[0];
+            }
+        }
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * state.range(0) *
+                            (sizeof(position) + Bytes));
+}
+
+BENCHMARK_TEMPLATE(iterate_width, 16)
+    ->RangeMultiplier(10)
+    ->Range(min_entities, max_entities / 10)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(iterate_width, 64)
+    ->RangeMultiplier(10)
+    ->Range(min_entities, max_entities / 10)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(iterate_width, 256)
+    ->RangeMultiplier(10)
+    ->Range(min_entities, max_entities / 10)
+    ->Unit(benchmark::kMicrosecond);
+
+// the same entities spread over more and more groups, each group iterated
+// is shorter and adds filtering and a jump to other memory
+void iterate_fragmented(benchmark::State& state)
+{
+    auto count      = static_cast<std::size_t>(state.range(0));
+    auto archetypes = static_cast<std::size_t>(state.range(1));
+
+    registry_t reg;
+    fill_archetypes(reg, count, archetypes);
+
+    auto eq = matter::entities{type_c<matter::write<position>>,
+                               type_c<matter::read<velocity>>};
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(integrate(eq, reg));
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(iterate_fragmented)
+    ->ArgNames({"entities", "archetypes"})
+    ->RangeMultiplier(16)
+    ->Ranges({{100000, 1000000}, {1, 1 << tag_count}})
+    ->Unit(benchmark::kMicrosecond);
+
+// matching groups among many others, where only tag<0> groups match. The rows
+// are barely touched, so this is mostly the cost of filtering groups.
+void query_groups(benchmark::State& state)
+{
+    auto archetypes = static_cast<std::size_t>(state.range(0));
+
+    registry_t reg;
+    fill_archetypes(reg, archetypes, archetypes);
+
+    auto eq = matter::entities{type_c<matter::write<position>>,
+                               type_c<matter::read<velocity>>,
+                               type_c<matter::has<tag<0>>>};
+
+    for (auto _ : state)
+    {
+        std::size_t matched = 0;
+        for (auto&& res : matter::process_entity_query(
+                 eq, reg.group_container().range(), reg))
+        {
+            (void) res;
+            ++matched;
+        }
+        benchmark::DoNotOptimize(matched);
+    }
+
+    state.counters["groups"] = static_cast<double>(archetypes);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(query_groups)
+    ->RangeMultiplier(4)
+    ->Range(4, 1 << tag_count)
+    ->Unit(benchmark::kMicrosecond);
+
+// destroy a scattered tenth of the entities one by one
+void erase_single(benchmark::State& state)
+{
+    auto count = static_cast<std::size_t>(state.range(0));
+
+    std::size_t erased = 0;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        {
+            registry_t reg;
+            auto       doomed = pick_doomed(fill(reg,
+                                           count,
+                                           position{0.f, 0.f, 0.f},
+                                           velocity{1.f, 1.f, 1.f}));
+            state.ResumeTiming();
+
+            for (const auto& ent : doomed)
+            {
+                reg.destroy(ent);
+            }
+            erased += doomed.size();
+
+            state.PauseTiming();
+        }
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(erased));
+}
+
+BENCHMARK(erase_single)
+    ->RangeMultiplier(10)
+    ->Range(min_entities, max_entities)
+    ->Unit(benchmark::kMillisecond);
+
+// destroy a scattered tenth of the entities spread over archetypes at once
+void erase_bulk(benchmark::State& state)
+{
+    auto count      = static_cast<std::size_t>(state.range(0));
+    auto archetypes = static_cast<std::size_t>(state.range(1));
+
+    std::size_t erased = 0;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        {
+            registry_t reg;
+            auto doomed = pick_doomed(fill_archetypes(reg, count, archetypes));
+            state.ResumeTiming();
+
+            erased += reg.destroy(doomed.begin(), doomed.end());
+
+            state.PauseTiming();
+        }
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(erased));
+}
+
+BENCHMARK(erase_bulk)
+    ->ArgNames({"entities", "archetypes"})
+    ->Args({min_entities, 1})
+    ->Args({100000, 1})
+    ->Args({1000000, 1})
+    ->Args({max_entities, 1})
+    ->Args({1000000, 64})
+    ->Args({1000000, 1 << tag_count})
+    ->Unit(benchmark::kMillisecond);
+
+// create a group for every archetype, one entity each
+void create_groups(benchmark::State& state)
+{
+    auto archetypes = static_cast<std::size_t>(state.range(0));
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        {
+            registry_t reg;
+            state.ResumeTiming();
+
+            fill_archetypes(reg, archetypes, archetypes);
+
+            state.PauseTiming();
+        }
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(create_groups)
+    ->RangeMultiplier(4)
+    ->Range(4, 1 << tag_count)
+    ->Unit(benchmark::kMicrosecond);
+
+int main(int argc, char** argv)
+{
+    // default to JSON so the output can be tracked without extra flags
+    std::vector<char*> args(argv, argv + argc);
+    std::string        json_format{"--benchmark_format=json"};
+
+    auto has_format = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        has_format = has_format ||
+                     std::strncmp(argv[i], "--benchmark_format", 18) == 0;
+    }
+
+    if (!has_format)
+    {
+        args.insert(args.begin() + 1, json_format.data());
+    }
+
+    auto arg_count = static_cast<int>(args.size());
+    ::benchmark::Initialize(&arg_count, args.data());
+    ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,245 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+
+#include "matter/component/registry.hpp"
+#include "matter/id/default_component_identifier.hpp"
+#include "matter/storage/aligned_vector.hpp"
+#include "matter/storage/chunked_storage.hpp"
+
+// the position/velocity pair of test_entt, as floats so kernels vectorize
+template<template<typename> typename Storage>
+struct position
+{
+    using storage_type = Storage<position>;
+
+    float x;
+    float y;
+};
+
+template<template<typename> typename Storage>
+struct velocity
+{
+    using storage_type = Storage<velocity>;
+
+    float x;
+    float y;
+};
+
+template<typename T>
+using vector = std::pmr::vector<T>;
+
+template<typename T>
+using aligned = matter::aligned_vector<T>;
+
+template<typename T>
+using chunked = matter::chunked_storage<T>;
+
+template<template<typename> typename Storage>
+struct fixture
+{
+    using pos_type = position<Storage>;
+    using vel_type = velocity<Storage>;
+
+    matter::registry<
+        matter::default_component_identifier<matter::unsigned_id<std::size_t>,
+                                             pos_type,
+                                             vel_type>>
+        reg;
+
+    Storage<pos_type>* positions;
+    Storage<vel_type>* velocities;
+
+    explicit fixture(std::size_t count)
+    {
+        auto buffer = reg.template create_buffer_for<pos_type, vel_type>();
+        buffer.resize(count, pos_type{0.f, 0.f}, vel_type{1.f, 2.f});
+        reg.insert(buffer);
+
+        auto grp = *reg.group_container().find_group(
+            reg.template component_ids<pos_type, vel_type>());
+        auto any_grp = reg.group_container().locate(grp.entity_at(0))->first;
+
+        positions =
+            any_grp.maybe_storage(reg.template component_id<pos_type>());
+        velocities =
+            any_grp.maybe_storage(reg.template component_id<vel_type>());
+    }
+};
+
+// iterate through the component_view proxy of each row
+template<template<typename> typename Storage>
+void update_proxy(benchmark::State& state)
+{
+    using pos_type = position<Storage>;
+    using vel_type = velocity<Storage>;
+
+    auto count = static_cast<std::size_t>(state.range(0));
+
+    fixture<Storage> fix{count};
+    auto             grp = *fix.reg.group_container().find_group(
+        fix.reg.template component_ids<pos_type, vel_type>());
+
+    for (auto _ : state)
+    {
+        for (auto view : grp)
+        {
+            auto&       pos = view.template get<pos_type>();
+            const auto& vel = view.template get<vel_type>();
+
+            pos.x += vel.x;
+            pos.y += vel.y;
+        }
+
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK_TEMPLATE(update_proxy, vector)
+    ->RangeMultiplier(16)
+    ->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(update_proxy, chunked)
+    ->RangeMultiplier(16)
+    ->Range(1 << 10, 1 << 20);
+
+// the same kernel per row, walked over the raw columns of each block
+template<template<typename> typename Storage>
+void update_unseq(benchmark::State& state)
+{
+    using pos_type = position<Storage>;
+    using vel_type = velocity<Storage>;
+
+    auto count = static_cast<std::size_t>(state.range(0));
+
+    fixture<Storage> fix{count};
+    auto             grp = *fix.reg.group_container().find_group(
+        fix.reg.template component_ids<pos_type, vel_type>());
+
+    for (auto _ : state)
+    {
+        matter::for_each(matter::execution::unseq,
+                         grp,
+                         [](pos_type& pos, const vel_type& vel) {
+                             pos.x += vel.x;
+                             pos.y += vel.y;
+                         });
+
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK_TEMPLATE(update_unseq, vector)
+    ->RangeMultiplier(16)
+    ->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(update_unseq, chunked)
+    ->RangeMultiplier(16)
+    ->Range(1 << 10, 1 << 20);
+
+// a kernel written against the blocks, telling the compiler the columns
+// don't alias
+template<template<typename> typename Storage>
+void update_chunks(benchmark::State& state)
+{
+    using pos_type = position<Storage>;
+    using vel_type = velocity<Storage>;
+
+    auto count = static_cast<std::size_t>(state.range(0));
+
+    fixture<Storage> fix{count};
+    auto             grp = *fix.reg.group_container().find_group(
+        fix.reg.template component_ids<pos_type, vel_type>());
+
+    for (auto _ : state)
+    {
+        grp.for_each_chunk([](std::size_t                count,
+                              pos_type* __restrict       pos,
+                              const vel_type* __restrict vel) {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                pos[i].x += vel[i].x;
+                pos[i].y += vel[i].y;
+            }
+        });
+
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK_TEMPLATE(update_chunks, vector)
+    ->RangeMultiplier(16)
+    ->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(update_chunks, chunked)
+    ->RangeMultiplier(16)
+    ->Range(1 << 10, 1 << 20);
+
+// raw loop over the columns, up to the size with a scalar tail
+template<template<typename> typename Storage>
+void update_raw(benchmark::State& state)
+{
+    auto count = static_cast<std::size_t>(state.range(0));
+
+    fixture<Storage> fix{count};
+
+    for (auto _ : state)
+    {
+        auto* __restrict pos = fix.positions->data();
+        auto* __restrict vel = fix.velocities->data();
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            pos[i].x += vel[i].x;
+            pos[i].y += vel[i].y;
+        }
+
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK_TEMPLATE(update_raw, vector)
+    ->RangeMultiplier(16)
+    ->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(update_raw, aligned)
+    ->RangeMultiplier(16)
+    ->Range(1 << 10, 1 << 20);
+
+// raw loop over the aligned columns including the padding, no scalar tail
+void update_padded(benchmark::State& state)
+{
+    // an odd count so the vector storage would need a tail
+    auto count = static_cast<std::size_t>(state.range(0)) + 3;
+
+    fixture<aligned> fix{count};
+    auto             padded = matter::padded_size(*fix.positions);
+
+    for (auto _ : state)
+    {
+        auto* __restrict pos = std::assume_aligned<64>(fix.positions->data());
+        auto* __restrict vel = std::assume_aligned<64>(fix.velocities->data());
+
+        for (std::size_t i = 0; i < padded; ++i)
+        {
+            pos[i].x += vel[i].x;
+            pos[i].y += vel[i].y;
+        }
+
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK(update_padded)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+
+int main(int argc, char** argv)
+{
+    ::benchmark::Initialize(&argc, argv);
+    ::benchmark::RunSpecifiedBenchmarks();
+}
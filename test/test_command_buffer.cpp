@@ -0,0 +1,155 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#include "matter/component/command_buffer.hpp"
+#include "matter/query/entities.hpp"
+#include "matter/query/processor.hpp"
+#include "matter/storage/shared_storage.hpp"
+#include "matter/util/thread_pool.hpp"
+#include "matter/world.hpp"
+
+struct team
+{
+    using storage_type = matter::shared_storage<team>;
+
+    int id;
+};
+
+TEST_CASE("command_buffer")
+{
+    using boost::hana::type_c;
+
+    auto world = matter::world{};
+    world.register_component<int>();
+    world.register_component<float>();
+    world.register_component<char>();
+
+    std::vector<matter::entity> ents;
+    for (int i = 0; i < 10; ++i)
+    {
+        ents.push_back(world.create_entity<int>(i));
+    }
+
+    // sums the ints of every entity having both components
+    auto sum_of = [&](auto other) {
+        auto eq = matter::entities{type_c<matter::read<int>>,
+                                   type_c<matter::read<decltype(other)>>};
+
+        int sum = 0;
+        for (auto [ints, others] : matter::process_query(eq, world))
+        {
+            for (auto i : ints)
+            {
+                sum += i;
+            }
+            (void) others;
+        }
+        return sum;
+    };
+
+    SECTION("record and apply")
+    {
+        auto cmds = world.make_command_buffer();
+
+        cmds.create<int, float>(100, 1.f);
+        cmds.create<char>('a');
+        cmds.create<int, float>(std::forward_as_tuple(200),
+                                std::forward_as_tuple(2.f));
+
+        for (int i = 0; i < 10; i += 2)
+        {
+            cmds.add_component<float>(ents[i], static_cast<float>(i));
+        }
+        cmds.remove_component<int>(ents[2]);
+        cmds.destroy(ents[8]);
+
+        // nothing happens until the buffer is applied
+        CHECK(world.try_get_component<float>(ents[0]) == nullptr);
+        CHECK(world.contains_entity(ents[8]));
+
+        cmds.apply();
+
+        // 0, 4 and 6 got a float, 2 lost its int and 8 is gone
+        CHECK(sum_of(float{}) == 100 + 200 + 0 + 4 + 6);
+        CHECK(sum_of(char{}) == 0);
+        for (int i = 0; i < 8; i += 2)
+        {
+            CHECK(world.get_component<float>(ents[i]) ==
+                  static_cast<float>(i));
+        }
+        CHECK(world.try_get_component<int>(ents[2]) == nullptr);
+        CHECK(world.get_component<int>(ents[4]) == 4);
+        CHECK_FALSE(world.contains_entity(ents[8]));
+
+        // the buffer is empty after applying
+        cmds.apply();
+        CHECK(sum_of(float{}) == 100 + 200 + 0 + 4 + 6);
+
+        cmds.add_component<char>(ents[1], 'c');
+        cmds.apply();
+        CHECK(sum_of(char{}) == 1);
+        CHECK(world.get_component<char>(ents[1]) == 'c');
+    }
+
+    SECTION("shared components")
+    {
+        world.register_component<team>();
+
+        auto cmds = world.make_command_buffer();
+        for (int i = 0; i < 10; ++i)
+        {
+            cmds.add_component<team>(ents[i], i % 3 == 0 ? 1 : 2);
+        }
+        cmds.apply();
+
+        // every value got its own group
+        for (int i = 0; i < 10; ++i)
+        {
+            CHECK(world.get_component<team>(ents[i]).id ==
+                  (i % 3 == 0 ? 1 : 2));
+            CHECK(world.get_component<int>(ents[i]) == i);
+        }
+        CHECK(sum_of(team{}) == 45);
+        CHECK(&world.get_component<team>(ents[0]) ==
+              &world.get_component<team>(ents[3]));
+        CHECK(&world.get_component<team>(ents[0]) !=
+              &world.get_component<team>(ents[1]));
+
+        // entities which already have it move to the recorded value
+        cmds.add_component<team>(ents[0], 2);
+        cmds.add_component<team>(ents[1], 3);
+        cmds.add_component<team>(ents[1], 1);
+        cmds.apply();
+
+        CHECK(world.get_component<team>(ents[0]).id == 2);
+        CHECK(world.get_component<team>(ents[1]).id == 1);
+        CHECK(&world.get_component<team>(ents[0]) ==
+              &world.get_component<team>(ents[2]));
+        CHECK(&world.get_component<team>(ents[1]) ==
+              &world.get_component<team>(ents[3]));
+        CHECK(sum_of(team{}) == 45);
+    }
+
+    SECTION("per thread")
+    {
+        auto cmds = world.make_command_buffers();
+
+        matter::thread_pool pool{3};
+        pool.parallel_for(1000, [&](std::size_t i) {
+            cmds.local().create<int, char>(static_cast<int>(i), 'b');
+        });
+
+        CHECK(cmds.size() >= 1);
+        CHECK(cmds.size() <= pool.concurrency());
+
+        cmds.apply();
+
+        CHECK(sum_of(char{}) == 999 * 1000 / 2);
+
+        // a new instance doesn't hand out the buffers of the old one
+        auto other = world.make_command_buffers();
+        CHECK(&other.local() != &cmds.local());
+    }
+}
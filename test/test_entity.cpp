@@ -0,0 +1,326 @@
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+#include "matter/component/registry.hpp"
+#include "matter/entity/entity.hpp"
+#include "matter/entity/entity_table.hpp"
+#include "matter/id/default_component_identifier.hpp"
+#include "matter/world.hpp"
+
+struct position
+{
+    int x;
+    int y;
+};
+
+struct velocity
+{
+    int dx;
+    int dy;
+};
+
+struct health
+{
+    int hp;
+};
+
+TEST_CASE("entity")
+{
+    SECTION("handle")
+    {
+        matter::entity invalid;
+        CHECK(!invalid);
+
+        matter::entity e{5, 2};
+        CHECK(e);
+        CHECK(e.index() == 5);
+        CHECK(e.generation() == 2);
+        CHECK(e != matter::entity{5, 3});
+        CHECK(e == matter::entity{5, 2});
+    }
+
+    SECTION("table")
+    {
+        int                       grp{};
+        matter::entity_table<int> table;
+
+        auto e1 = table.create(&grp, 0);
+        auto e2 = table.create(&grp, 1);
+        CHECK(table.size() == 2);
+        CHECK(table.contains(e1));
+
+        table.release(e1);
+        CHECK(!table.contains(e1));
+        CHECK(table.size() == 1);
+
+        // slot gets recycled with a new generation
+        auto e3 = table.create(&grp, 2);
+        CHECK(e3.index() == e1.index());
+        CHECK(e3.generation() != e1.generation());
+        CHECK(!table.contains(e1));
+        CHECK(table.contains(e3));
+
+        table.relocate(e2, 0);
+        CHECK(table.find(e2)->row == 0);
+    }
+}
+
+TEST_CASE("entity registry")
+{
+    auto reg = matter::registry<matter::default_component_identifier<
+        matter::unsigned_id<std::size_t>,
+        position,
+        velocity>>{};
+
+    SECTION("create and get")
+    {
+        auto e1 = reg.create<position>(position{1, 2});
+        auto e2 = reg.create<position, velocity>(position{3, 4},
+                                                 velocity{5, 6});
+
+        CHECK(reg.contains(e1));
+        CHECK(reg.contains(e2));
+
+        CHECK(reg.get<position>(e1).x == 1);
+        CHECK(reg.get<velocity>(e2).dy == 6);
+        CHECK(reg.try_get<velocity>(e1) == nullptr);
+
+        reg.get<position>(e2).x = 42;
+        CHECK(reg.get<position>(e2).x == 42);
+    }
+
+    SECTION("destroy patches moved rows")
+    {
+        std::vector<matter::entity> ents;
+
+        for (int i = 0; i < 100; ++i)
+        {
+            ents.push_back(reg.create<position>(position{i, i}));
+        }
+
+        // destroy every even entity, each causing a swap and pop
+        for (int i = 0; i < 100; i += 2)
+        {
+            CHECK(reg.destroy(ents[i]));
+        }
+
+        for (int i = 0; i < 100; ++i)
+        {
+            if (i % 2 == 0)
+            {
+                CHECK(!reg.contains(ents[i]));
+                CHECK(reg.try_get<position>(ents[i]) == nullptr);
+                CHECK(!reg.destroy(ents[i]));
+            }
+            else
+            {
+                REQUIRE(reg.contains(ents[i]));
+                CHECK(reg.get<position>(ents[i]).x == i);
+            }
+        }
+
+        // new entities reuse slots without reviving old handles
+        auto e = reg.create<position>(position{-1, -1});
+        CHECK(reg.get<position>(e).x == -1);
+        CHECK(!reg.contains(ents[0]));
+    }
+
+    SECTION("bulk destroy")
+    {
+        std::vector<matter::entity> ents;
+
+        for (int i = 0; i < 100; ++i)
+        {
+            ents.push_back(reg.create<position>(position{i, i}));
+            ents.push_back(reg.create<position, velocity>(position{i, i},
+                                                          velocity{i, i}));
+        }
+
+        // scattered rows of both groups, with duplicates and a dead entity
+        std::vector<matter::entity> doomed;
+        for (std::size_t i = 0; i < ents.size(); i += 3)
+        {
+            doomed.push_back(ents[i]);
+        }
+        doomed.push_back(ents[0]);
+        reg.destroy(ents[3]);
+
+        CHECK(reg.destroy(doomed.begin(), doomed.end()) ==
+              (ents.size() + 2) / 3 - 1);
+
+        for (std::size_t i = 0; i < ents.size(); ++i)
+        {
+            if (i % 3 == 0)
+            {
+                CHECK(!reg.contains(ents[i]));
+            }
+            else
+            {
+                REQUIRE(reg.contains(ents[i]));
+                CHECK(reg.get<position>(ents[i]).x == static_cast<int>(i / 2));
+            }
+        }
+
+        CHECK(reg.group_container().entities().size() ==
+              ents.size() - (ents.size() + 2) / 3);
+
+        // erase by predicate on the rows of a single group
+        auto grp    = reg.group_container().locate(ents[1])->first;
+        auto erased = grp.erase_if([&](std::size_t row) {
+            return reg.get<velocity>(grp.metadata()->entity_at(row)).dx < 50;
+        });
+
+        CHECK(erased > 0);
+        for (std::size_t i = 1; i < ents.size(); i += 2)
+        {
+            if (i % 3 == 0 || static_cast<int>(i / 2) < 50)
+            {
+                CHECK(!reg.contains(ents[i]));
+            }
+            else
+            {
+                REQUIRE(reg.contains(ents[i]));
+                CHECK(reg.get<position>(ents[i]).x ==
+                      reg.get<velocity>(ents[i]).dx);
+            }
+        }
+    }
+
+    SECTION("handles survive new groups")
+    {
+        auto e1 = reg.create<velocity>(velocity{1, 1});
+        reg.create<position>(position{0, 0});
+        reg.create<position, velocity>(position{0, 0}, velocity{0, 0});
+
+        CHECK(reg.get<velocity>(e1).dx == 1);
+    }
+
+    SECTION("insert buffer")
+    {
+        auto buffer = reg.create_buffer_for<position>();
+        buffer.resize(10, position{7, 7});
+        reg.insert(buffer);
+
+        CHECK(reg.group_container().entities().size() == 10);
+    }
+}
+
+TEST_CASE("component migration")
+{
+    auto reg = matter::registry<matter::default_component_identifier<
+        matter::unsigned_id<std::size_t>,
+        position,
+        velocity,
+        health>>{};
+
+    SECTION("add and remove")
+    {
+        auto e1 = reg.create<position>(position{1, 2});
+        auto e2 = reg.create<position>(position{3, 4});
+
+        auto* vel = reg.add_component<velocity>(e1, velocity{5, 6});
+        REQUIRE(vel);
+        CHECK(vel->dx == 5);
+
+        // like the bulk form, dead entities and those having it are skipped
+        CHECK(!reg.add_component<velocity>(e1, velocity{7, 8}));
+        CHECK(reg.get<velocity>(e1).dx == 5);
+
+        REQUIRE(reg.contains(e1));
+        CHECK(reg.get<position>(e1).x == 1);
+        CHECK(reg.get<velocity>(e1).dy == 6);
+
+        // e2 took the row of e1 in the source group
+        CHECK(reg.get<position>(e2).x == 3);
+        CHECK(reg.try_get<velocity>(e2) == nullptr);
+
+        CHECK(reg.remove_component<position>(e1));
+        CHECK(reg.try_get<position>(e1) == nullptr);
+        CHECK(reg.get<velocity>(e1).dx == 5);
+
+        // absent component and only component
+        CHECK(!reg.remove_component<position>(e1));
+        CHECK(!reg.remove_component<velocity>(e1));
+        CHECK(reg.contains(e1));
+
+        reg.destroy(e2);
+        CHECK(!reg.remove_component<position>(e2));
+        CHECK(!reg.add_component<velocity>(e2, velocity{1, 2}));
+    }
+
+    SECTION("batched")
+    {
+        std::vector<matter::entity> ents;
+
+        for (int i = 0; i < 50; ++i)
+        {
+            ents.push_back(reg.create<position>(position{i, i}));
+            ents.push_back(reg.create<position, health>(position{i, i},
+                                                        health{i}));
+        }
+
+        // every other entity from both groups, including duplicates
+        std::vector<matter::entity> selected;
+        for (std::size_t i = 0; i < ents.size(); i += 3)
+        {
+            selected.push_back(ents[i]);
+            selected.push_back(ents[i]);
+        }
+
+        reg.add_component(selected.begin(), selected.end(), velocity{7, 8});
+
+        auto is_selected = [&](std::size_t i) { return i % 3 == 0; };
+
+        for (std::size_t i = 0; i < ents.size(); ++i)
+        {
+            REQUIRE(reg.contains(ents[i]));
+            CHECK(reg.get<position>(ents[i]).x == static_cast<int>(i / 2));
+
+            if (i % 2 == 1)
+            {
+                CHECK(reg.get<health>(ents[i]).hp == static_cast<int>(i / 2));
+            }
+
+            auto* vel = reg.try_get<velocity>(ents[i]);
+            CHECK((vel != nullptr) == is_selected(i));
+            if (vel)
+            {
+                CHECK(vel->dx == 7);
+            }
+        }
+
+        reg.remove_component<position>(ents.begin(), ents.end());
+
+        for (std::size_t i = 0; i < ents.size(); ++i)
+        {
+            REQUIRE(reg.contains(ents[i]));
+
+            // position was the only component for unselected even entities
+            bool only_position = i % 2 == 0 && !is_selected(i);
+            CHECK((reg.try_get<position>(ents[i]) != nullptr) == only_position);
+
+            if (i % 2 == 1)
+            {
+                CHECK(reg.get<health>(ents[i]).hp == static_cast<int>(i / 2));
+            }
+
+            if (is_selected(i))
+            {
+                CHECK(reg.get<velocity>(ents[i]).dy == 8);
+            }
+        }
+    }
+}
+
+TEST_CASE("entity world")
+{
+    auto w = matter::world{};
+    w.register_component<int>();
+
+    auto e = w.create_entity<int>(5);
+    CHECK(w.contains_entity(e));
+    CHECK(w.get_component<int>(e) == 5);
+    CHECK(w.destroy_entity(e));
+    CHECK(!w.contains_entity(e));
+}
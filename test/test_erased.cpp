@@ -1,9 +1,14 @@
 #include <catch2/catch.hpp>
 
 #include <string>
+#include <vector>
 
 #include "matter/id/default_component_identifier.hpp"
+#include "matter/storage/aligned_vector.hpp"
+#include "matter/storage/chunked_storage.hpp"
+#include "matter/storage/empty_storage.hpp"
 #include "matter/storage/erased_storage.hpp"
+#include "matter/storage/shared_storage.hpp"
 #include "matter/util/erased.hpp"
 
 struct int_comp
@@ -20,6 +25,26 @@ struct float_comp
     {}
 };
 
+struct empty_comp
+{};
+
+struct shared_comp
+{
+    int group;
+};
+
+// every storage shipped with matter has to be reachable without a heap hop
+static_assert(matter::erased::is_stored_inline_v<std::vector<float>>);
+static_assert(matter::erased::is_stored_inline_v<std::pmr::vector<float>>);
+static_assert(
+    matter::erased::is_stored_inline_v<matter::chunked_storage<float>>);
+static_assert(
+    matter::erased::is_stored_inline_v<matter::aligned_vector<float>>);
+static_assert(
+    matter::erased::is_stored_inline_v<matter::empty_storage<empty_comp>>);
+static_assert(
+    matter::erased::is_stored_inline_v<matter::shared_storage<shared_comp>>);
+
 struct our_test
 {
     int& i;
@@ -98,6 +123,68 @@ TEST_CASE("erased")
 
         CHECK(er.get<std::string>().compare("hello world") == 0);
     }
+
+    SECTION("inline")
+    {
+        auto er = matter::make_erased<std::vector<int>>(3, 7);
+        CHECK(er.is_inline());
+
+        matter::erased er_move{std::move(er)};
+        CHECK(er_move.is_inline());
+        CHECK(er_move.get<std::vector<int>>().size() == 3);
+        CHECK(er_move.get<std::vector<int>>()[2] == 7);
+
+        int i{0};
+        {
+            auto er_dtor = matter::make_erased<our_test>(i);
+            i            = 0;
+
+            // moving an inline object destroys the moved from object
+            matter::erased er_dtor_move{std::move(er_dtor)};
+            CHECK(i == 5);
+        }
+        CHECK(i == 10);
+    }
+
+    SECTION("inline storages")
+    {
+        auto chunked = matter::make_erased<matter::chunked_storage<float>>();
+        CHECK(chunked.is_inline());
+        chunked.get<matter::chunked_storage<float>>().push_back(1.f);
+
+        matter::erased chunked_move{std::move(chunked)};
+        CHECK(chunked_move.is_inline());
+        CHECK(chunked_move.get<matter::chunked_storage<float>>()[0] == 1.f);
+
+        auto aligned = matter::make_erased<matter::aligned_vector<float>>();
+        CHECK(aligned.is_inline());
+
+        auto empty = matter::make_erased<matter::empty_storage<empty_comp>>();
+        CHECK(empty.is_inline());
+
+        auto shared =
+            matter::make_erased<matter::shared_storage<shared_comp>>();
+        CHECK(shared.is_inline());
+    }
+
+    SECTION("heap")
+    {
+        struct big
+        {
+            char c[128];
+        };
+
+        // allocating may throw even if constructing doesn't
+        static_assert(!noexcept(matter::make_erased<big>()));
+        static_assert(noexcept(matter::make_erased<int>(5)));
+
+        auto er = matter::make_erased<big>();
+        CHECK(!er.is_inline());
+
+        auto* addr = std::addressof(er.get<big>());
+        matter::erased er_move{std::move(er)};
+        CHECK(addr == std::addressof(er_move.get<big>()));
+    }
 }
 
 TEST_CASE("erased_storage")
@@ -93,4 +93,154 @@ TEST_CASE("group_container")
             CHECK(!bool(cont.find_group(ordered_untyped_ids)));
         }
     }
+
+    SECTION("index")
+    {
+        auto full_ids =
+            ident.ordered_component_ids<int, float, char, double>();
+        auto full_untyped = matter::ordered_untyped_ids{full_ids};
+
+        // emplace every subset of the full group
+        for (auto mask = 1u; mask < 16u; ++mask)
+        {
+            std::vector<matter::unsigned_id<std::size_t>> subset;
+            for (auto i = 0u; i < 4u; ++i)
+            {
+                if (mask & (1u << i))
+                {
+                    subset.push_back(full_untyped[i]);
+                }
+            }
+
+            auto source = *cont.find_group(full_untyped);
+            auto grp    = cont.try_emplace_group(
+                source, matter::ordered_untyped_ids{subset});
+            CHECK(grp.group_size() == subset.size());
+        }
+
+        CHECK(cont.range().size() == 15);
+
+        // every group in the range can be found by its own ids
+        for (auto grp : cont.range())
+        {
+            auto found = cont.find_group(grp.metadata()->ids());
+            REQUIRE(found);
+            CHECK(*found == grp);
+        }
+
+        // earlier groups are found again and kept their contents
+        auto fgrp3 = *cont.find_group(ident.component_ids<float>());
+        CHECK(fgrp3.size() == 1);
+    }
+
+    SECTION("signature")
+    {
+        using id_type = matter::unsigned_id<std::size_t>;
+
+        auto mask = matter::signature_mask{};
+        mask.require(ident.component_id<float>());
+        mask.exclude(ident.component_id<double>());
+
+        auto signature_of = [&](auto ids) {
+            return cont.find_group(ids)->metadata()->signature();
+        };
+
+        auto fsig    = signature_of(ident.component_ids<float>());
+        auto csig    = signature_of(ident.component_ids<char>());
+        auto ifcdsig = signature_of(
+            ident.component_ids<int, float, char, double>());
+
+        CHECK(fsig.exact());
+        CHECK(ifcdsig.includes(fsig));
+        CHECK(!fsig.includes(ifcdsig));
+        CHECK(!fsig.intersects(csig));
+
+        CHECK(mask.match(fsig) == matter::signature_match::accept);
+        CHECK(mask.match(csig) == matter::signature_match::reject);
+        CHECK(mask.match(ifcdsig) == matter::signature_match::reject);
+
+        // ids past the width share bits, a match must then be confirmed
+        auto wide = matter::component_signature{};
+        wide.insert(id_type{matter::signature_bits +
+                            ident.component_id<double>().value()});
+        CHECK(!wide.exact());
+        CHECK(mask.match(wide) == matter::signature_match::reject);
+
+        wide.insert(ident.component_id<float>());
+        CHECK(mask.match(wide) == matter::signature_match::maybe);
+
+        auto wide_mask = matter::signature_mask{};
+        wide_mask.require(id_type{matter::signature_bits +
+                                  ident.component_id<float>().value()});
+        CHECK(wide_mask.match(fsig) == matter::signature_match::maybe);
+        CHECK(wide_mask.match(csig) == matter::signature_match::reject);
+    }
+
+    SECTION("edges")
+    {
+        auto fany   = *cont.find(ident.ordered_component_ids<float>());
+        auto groups = cont.group_count();
+
+        // the first transition creates the group and links both ends
+        auto ifany =
+            cont.try_emplace_group_with(fany, ident.component_id<int>());
+        CHECK(cont.group_count() == groups + 1);
+        CHECK(ifany.contains(ident.component_id<int>()));
+        CHECK(ifany.contains(ident.component_id<float>()));
+        CHECK(fany.metadata()->edge_with(ident.component_id<int>()) ==
+              ifany.metadata());
+        CHECK(ifany.metadata()->edge_without(ident.component_id<int>()) ==
+              fany.metadata());
+        CHECK(!fany.metadata()->edge_with(ident.component_id<char>()));
+
+        CHECK(cont.try_emplace_group_with(fany, ident.component_id<int>()) ==
+              ifany);
+        CHECK(cont.try_emplace_group_without(
+                  ifany, ident.component_id<int>()) == fany);
+        CHECK(cont.group_count() == groups + 1);
+
+        // an existing group is linked without creating another one
+        auto ifcdany = *cont.find(
+            ident.ordered_component_ids<int, float, char, double>());
+        auto ifcany = cont.try_emplace_group_without(
+            ifcdany, ident.component_id<double>());
+        CHECK(cont.group_count() == groups + 2);
+        CHECK(cont.try_emplace_group_with(ifcany,
+                                          ident.component_id<double>()) ==
+              ifcdany);
+        CHECK(cont.group_count() == groups + 2);
+
+        // different paths lead to the same group
+        CHECK(cont.try_emplace_group_with(ifany, ident.component_id<char>()) ==
+              ifcany);
+        CHECK(cont.group_count() == groups + 2);
+    }
+    SECTION("stable handles")
+    {
+        auto it      = cont.find(ident.ordered_component_ids<float>());
+        auto any_grp = *it;
+        auto rng1    = cont.range(1);
+        auto old_sz  = rng1.size();
+
+        ident.register_component<long>();
+        ident.register_component<short>();
+
+        // create groups of every size, none of them may move existing groups
+        cont.try_emplace(ident.component_ids<long>());
+        cont.try_emplace(ident.component_ids<long, short>());
+        cont.try_emplace(ident.component_ids<int, long, short>());
+        cont.try_emplace(ident.component_ids<int, float, long, short, char>());
+
+        CHECK(*it == any_grp);
+        CHECK(any_grp.size() == 1);
+        CHECK(fgrp.size() == 1);
+        CHECK(*cont.find_group(ident.component_ids<float>()) == fgrp);
+
+        // the range sees the group created after obtaining it
+        CHECK(rng1.size() == old_sz + 1);
+
+        fgrp.emplace_back(std::forward_as_tuple(6.0f));
+        CHECK(any_grp.size() == 2);
+        CHECK(ifcdgrp.size() == 1);
+    }
 }
@@ -1,7 +1,11 @@
 #include <catch2/catch.hpp>
 
+#include <tuple>
+
 #include "matter/component/insert_buffer.hpp"
+#include "matter/component/registry.hpp"
 #include "matter/id/default_component_identifier.hpp"
+#include "matter/util/thread_pool.hpp"
 
 TEST_CASE("insert_buffer")
 {
@@ -23,4 +27,54 @@ TEST_CASE("insert_buffer")
         buf.emplace_back(5.5f, 50);
         CHECK(buf.size() == 2);
     }
+
+    SECTION("generate")
+    {
+        auto row = [](std::size_t i) {
+            return std::tuple{static_cast<float>(i), static_cast<int>(i)};
+        };
+
+        buf.emplace_back(-1.f, -1);
+        buf.generate(100, row);
+        CHECK(buf.size() == 101);
+
+        auto pool = matter::thread_pool{2};
+        buf.generate(matter::execution::par.on(pool).grain(64), 5000, row);
+        CHECK(buf.size() == 5101);
+
+        auto floats = buf.column<float>();
+        auto ints   = buf.column<int>();
+        CHECK(floats.size() == 5101);
+        CHECK(floats[0] == -1.f);
+        CHECK(ints[100] == 99);
+        CHECK(ints[101] == 0);
+        CHECK(ints[5100] == 4999);
+        CHECK(floats[5100] == 4999.f);
+    }
+
+    SECTION("insert")
+    {
+        using id_type = matter::unsigned_id<std::size_t>;
+
+        auto reg = matter::registry<
+            matter::default_component_identifier<id_type, float, int>>{};
+
+        auto filled = reg.create_buffer_for<float, int>();
+        filled.generate(3000, [](std::size_t i) {
+            return std::tuple{static_cast<float>(i), static_cast<int>(i)};
+        });
+        reg.insert(filled);
+        reg.insert(filled);
+
+        auto grp = *reg.group_container().find_group(
+            reg.component_ids<float, int>());
+        CHECK(grp.size() == 6000);
+
+        for (std::size_t row = 0; row < grp.size(); ++row)
+        {
+            auto ent = grp.entity_at(row);
+            CHECK(reg.get<int>(ent) == static_cast<int>(row % 3000));
+            CHECK(reg.get<float>(ent) == static_cast<float>(row % 3000));
+        }
+    }
 }
@@ -1,10 +1,48 @@
 #include <catch2/catch.hpp>
 
+#include <atomic>
+#include <memory>
+#include <tuple>
+
+#include "matter/dispatcher.hpp"
 #include "matter/system/job.hpp"
 #include "matter/system/world_compiler.hpp"
 #include "matter/world.hpp"
 
 #include "matter/query/entities.hpp"
+#include "matter/query/runtime_entities.hpp"
+
+// a job with a runtime query, sums the floats of every entity
+template<typename Id>
+struct runtime_job
+{
+    std::tuple<matter::runtime_entities<Id>> queries_;
+    float*                                   sum_;
+
+    runtime_job(const Id& float_id, float& sum)
+        : queries_{matter::runtime_entities{
+              matter::component_query_description<Id>{
+                  float_id, matter::access::read, matter::presence::require}}},
+          sum_{std::addressof(sum)}
+    {}
+
+    std::tuple<matter::runtime_entities<Id>>& queries()
+    {
+        return queries_;
+    }
+
+    template<typename Results>
+    void operator()(Results&& results)
+    {
+        for (auto& res : results)
+        {
+            for (auto f : res[0]->template get<float>())
+            {
+                *sum_ += f;
+            }
+        }
+    }
+};
 
 TEST_CASE("job")
 {
@@ -44,3 +82,248 @@ TEST_CASE("job")
 
     REQUIRE(count == 5);
 }
+
+TEST_CASE("parallel_dispatcher")
+{
+    using boost::hana::type_c;
+
+    auto world = matter::world{};
+    world.register_component<int>();
+    world.register_component<float>();
+
+    for (int i = 0; i < 100; ++i)
+    {
+        world.create_entity<int, float>(1, 1.f);
+    }
+
+    auto add = matter::make_job<matter::entities<matter::write<int>>>(
+        [](auto&& groups) {
+            for (auto [ints] : groups)
+            {
+                for (auto& i : ints)
+                {
+                    i += 1;
+                }
+            }
+        });
+
+    std::atomic<int> int_sum{0};
+    auto sum = matter::make_job<matter::entities<matter::read<int>>>(
+        [&](auto&& groups) {
+            for (auto [ints] : groups)
+            {
+                for (auto i : ints)
+                {
+                    int_sum += i;
+                }
+            }
+        });
+
+    auto scale = matter::make_job<matter::entities<matter::write<float>>>(
+        [](auto&& groups) {
+            for (auto [floats] : groups)
+            {
+                for (auto& f : floats)
+                {
+                    f *= 2.f;
+                }
+            }
+        });
+
+    auto twice = matter::make_job<matter::entities<matter::write<int>>>(
+        [](auto&& groups) {
+            for (auto [ints] : groups)
+            {
+                for (auto& i : ints)
+                {
+                    i *= 2;
+                }
+            }
+        });
+
+    using runtime_t = runtime_job<decltype(world)::id_type>;
+    float float_sum = 0.f;
+    auto  runtime   = runtime_t{world.component_id<float>(), float_sum};
+
+    auto disp = matter::parallel_dispatcher{world,
+                                            std::move(add),
+                                            std::move(sum),
+                                            std::move(scale),
+                                            std::move(twice),
+                                            std::move(runtime)};
+
+    // scale shares no component with the others, the runtime query reads what
+    // scale writes
+    const auto& graph = disp.graph();
+    CHECK(graph.successors(0) == std::vector<std::size_t>{1, 3});
+    CHECK(graph.successors(1) == std::vector<std::size_t>{3});
+    CHECK(graph.successors(2) == std::vector<std::size_t>{4});
+    CHECK(graph.predecessors(2) == 0);
+    CHECK(graph.predecessors(3) == 2);
+    CHECK(graph.predecessors(4) == 1);
+
+    matter::thread_pool pool{3};
+
+    // (1 + 1) * 2 then (4 + 1) * 2, the floats double every time
+    disp(pool);
+    CHECK(int_sum == 200);
+    CHECK(float_sum == 200.f);
+    disp(pool);
+    CHECK(int_sum == 200 + 500);
+    CHECK(float_sum == 200.f + 400.f);
+
+    auto ent = world.create_entity<int, float>(0, 1.f);
+    disp(pool);
+    CHECK(world.get_component<int>(ent) == 2);
+    CHECK(world.get_component<float>(ent) == 2.f);
+}
+
+// a job with a query which isn't an entity query, may access anything
+struct exclusive_job
+{
+    std::tuple<int>& queries();
+};
+
+TEST_CASE("stage_plan")
+{
+    using boost::hana::type_c;
+
+    auto world = matter::world{};
+    world.register_component<int>();
+    world.register_component<float>();
+
+    for (int i = 0; i < 100; ++i)
+    {
+        world.create_entity<int, float>(1, 1.f);
+    }
+
+    auto add = matter::make_job<matter::entities<matter::write<int>>>(
+        [](auto&& groups) {
+            for (auto [ints] : groups)
+            {
+                for (auto& i : ints)
+                {
+                    i += 1;
+                }
+            }
+        });
+
+    int  int_sum = 0;
+    auto sum     = matter::make_job<matter::entities<matter::read<int>>>(
+        [&](auto&& groups) {
+            for (auto [ints] : groups)
+            {
+                for (auto i : ints)
+                {
+                    int_sum += i;
+                }
+            }
+        });
+
+    auto scale = matter::make_job<matter::entities<matter::write<float>>>(
+        [](auto&& groups) {
+            for (auto [floats] : groups)
+            {
+                for (auto& f : floats)
+                {
+                    f *= 2.f;
+                }
+            }
+        });
+
+    float float_sum = 0.f;
+    auto  read_both =
+        matter::make_job<matter::entities<matter::read<int>>,
+                         matter::entities<matter::read<float>>>(
+            [&](auto&& int_groups, auto&& float_groups) {
+                for (auto [floats] : float_groups)
+                {
+                    for (auto f : floats)
+                    {
+                        float_sum += f;
+                    }
+                }
+                (void) int_groups;
+            });
+
+    using add_t   = decltype(add);
+    using sum_t   = decltype(sum);
+    using scale_t = decltype(scale);
+    using both_t  = decltype(read_both);
+
+    using runtime_t = runtime_job<decltype(world)::id_type>;
+
+    SECTION("plan")
+    {
+        using compiler_t =
+            matter::world_compiler<decltype(world),
+                                   matter::entities<matter::write<int>>>;
+
+        // add and scale share nothing, sum reads what add writes, read_both
+        // reads what scale writes
+        constexpr auto plan =
+            compiler_t::stages<add_t, sum_t, scale_t, both_t>;
+        static_assert(plan.job_count() == 4);
+        static_assert(plan.stage_count == 2);
+        static_assert(plan.stage_of == std::array<std::size_t, 4>{0, 1, 0, 1});
+        static_assert(plan.jobs == std::array<std::size_t, 4>{0, 2, 1, 3});
+        static_assert(plan.stage_size(0) == 2);
+        static_assert(plan.job(1, 1) == 3);
+
+        // conflicting jobs keep their order
+        constexpr auto chain = matter::make_stage_plan<sum_t, add_t, sum_t>();
+        static_assert(chain.stage_count == 3);
+
+        constexpr auto readers =
+            matter::make_stage_plan<sum_t, sum_t, both_t>();
+        static_assert(readers.stage_count == 1);
+        static_assert(readers.stage_size(0) == 3);
+
+        constexpr auto exclusive =
+            matter::make_stage_plan<scale_t, exclusive_job, sum_t>();
+        static_assert(exclusive.stage_of ==
+                      std::array<std::size_t, 3>{0, 1, 2});
+
+        // a runtime query could access anything
+        constexpr auto runtime =
+            matter::make_stage_plan<sum_t, runtime_t, sum_t>();
+        static_assert(runtime.stage_of == std::array<std::size_t, 3>{0, 1, 2});
+
+        constexpr auto none = matter::make_stage_plan<>();
+        static_assert(none.stage_count == 0);
+    }
+
+    SECTION("staged_dispatcher")
+    {
+        auto disp = matter::staged_dispatcher{world,
+                                              std::move(add),
+                                              std::move(sum),
+                                              std::move(scale),
+                                              std::move(read_both)};
+        static_assert(decltype(disp)::plan.stage_count == 2);
+
+        matter::thread_pool pool{3};
+
+        disp(pool);
+        CHECK(int_sum == 200);
+        CHECK(float_sum == 200.f);
+        disp(pool);
+        CHECK(int_sum == 200 + 300);
+        CHECK(float_sum == 200.f + 400.f);
+    }
+
+    SECTION("staged_dispatcher with a runtime query")
+    {
+        float runtime_sum = 0.f;
+        auto  disp        = matter::staged_dispatcher{
+            world,
+            std::move(scale),
+            runtime_t{world.component_id<float>(), runtime_sum}};
+        static_assert(decltype(disp)::plan.stage_count == 2);
+
+        matter::thread_pool pool{2};
+
+        disp(pool);
+        CHECK(runtime_sum == 200.f);
+    }
+}
@@ -0,0 +1,434 @@
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <limits>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+#include "matter/component/registry.hpp"
+#include "matter/entity/entity_table.hpp"
+#include "matter/id/default_component_identifier.hpp"
+#include "matter/storage/chunked_storage.hpp"
+#include "matter/util/erased.hpp"
+#include "matter/world.hpp"
+
+struct position
+{
+    float x;
+    float y;
+};
+
+struct velocity
+{
+    float dx;
+    float dy;
+};
+
+struct chunked_health
+{
+    using storage_type = matter::chunked_storage<chunked_health>;
+
+    int hp;
+};
+
+struct throwing_object
+{
+    std::array<double, 16> values;
+
+    throwing_object()
+    {
+        throw std::runtime_error{"construction failed"};
+    }
+};
+
+/// forwards to new_delete_resource while keeping track of outstanding memory,
+/// throws once `allocations` reaches `fail_after`
+class counting_resource : public std::pmr::memory_resource {
+public:
+    std::size_t allocations{0};
+    std::size_t outstanding{0};
+    std::size_t fail_after{std::numeric_limits<std::size_t>::max()};
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        if (allocations == fail_after)
+        {
+            throw std::bad_alloc{};
+        }
+
+        ++allocations;
+        outstanding += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void*       ptr,
+                       std::size_t bytes,
+                       std::size_t alignment) override
+    {
+        outstanding -= bytes;
+        std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const
+        noexcept override
+    {
+        return this == &other;
+    }
+};
+
+/// any allocation from the default resource throws while this is alive
+struct forbid_default_resource
+{
+    std::pmr::memory_resource* previous;
+
+    forbid_default_resource()
+        : previous{std::pmr::set_default_resource(
+              std::pmr::null_memory_resource())}
+    {}
+
+    ~forbid_default_resource()
+    {
+        std::pmr::set_default_resource(previous);
+    }
+};
+
+using registry_type = matter::registry<
+    matter::default_component_identifier<matter::unsigned_id<std::size_t>,
+                                         position,
+                                         velocity,
+                                         chunked_health>>;
+
+TEST_CASE("memory resource")
+{
+    SECTION("erased")
+    {
+        counting_resource resource;
+
+        {
+            auto er = matter::allocate_erased<std::array<double, 16>>(
+                &resource, std::array<double, 16>{1.0});
+            CHECK(!er.is_inline());
+            CHECK(resource.allocations == 1);
+
+            auto moved = std::move(er);
+            CHECK(moved.get<std::array<double, 16>>()[0] == 1.0);
+        }
+
+        CHECK(resource.outstanding == 0);
+
+        // inline objects never touch the resource
+        auto small = matter::allocate_erased<int>(&resource, 5);
+        CHECK(small.is_inline());
+        CHECK(resource.allocations == 1);
+
+        // the memory is returned if the object can't be constructed
+        CHECK_THROWS_AS(matter::allocate_erased<throwing_object>(&resource),
+                        std::runtime_error);
+        CHECK(resource.allocations == 2);
+        CHECK(resource.outstanding == 0);
+    }
+
+    SECTION("chunked storage")
+    {
+        counting_resource resource;
+
+        {
+            matter::chunked_storage<int, 8> storage{
+                std::pmr::polymorphic_allocator<int>{&resource}};
+
+            for (int i = 0; i < 20; ++i)
+            {
+                storage.push_back(i);
+            }
+
+            CHECK(storage.get_allocator().resource() == &resource);
+            CHECK(resource.outstanding >= 3 * 8 * sizeof(int));
+
+            // move assigning to a storage of another resource moves elements
+            matter::chunked_storage<int, 8> other;
+            other = std::move(storage);
+            CHECK(other.size() == 20);
+            CHECK(other[19] == 19);
+            CHECK(other.get_allocator().resource() != &resource);
+        }
+
+        CHECK(resource.outstanding == 0);
+
+        // no chunk leaks when growing the list of chunks fails
+        for (std::size_t budget = 0; budget < 8; ++budget)
+        {
+            {
+                matter::chunked_storage<int, 8> storage{
+                    std::pmr::polymorphic_allocator<int>{&resource}};
+
+                resource.allocations = 0;
+                resource.fail_after  = budget;
+
+                CHECK_THROWS_AS(
+                    [&]() {
+                        for (int i = 0; i < 100; ++i)
+                        {
+                            storage.push_back(i);
+                        }
+                    }(),
+                    std::bad_alloc);
+            }
+
+            CHECK(resource.outstanding == 0);
+        }
+
+        resource.fail_after = std::numeric_limits<std::size_t>::max();
+    }
+
+    SECTION("entity table")
+    {
+        counting_resource         resource;
+        int                       grp{};
+        matter::entity_table<int> table{&resource};
+
+        std::vector<matter::entity> ents;
+        for (std::size_t i = 0; i < 100; ++i)
+        {
+            ents.push_back(table.create(&grp, i));
+        }
+
+        // releasing handles never allocates, the free list has room already
+        resource.fail_after = resource.allocations;
+        for (auto ent : ents)
+        {
+            table.release(ent);
+        }
+
+        CHECK(table.empty());
+
+        // recycling the released slots doesn't allocate either
+        for (std::size_t i = 0; i < 100; ++i)
+        {
+            table.create(&grp, i);
+        }
+
+        CHECK(table.size() == 100);
+    }
+
+    SECTION("registry")
+    {
+        counting_resource resource;
+
+        {
+            forbid_default_resource forbid;
+
+            registry_type reg{&resource};
+
+            std::vector<matter::entity> ents;
+            for (int i = 0; i < 100; ++i)
+            {
+                ents.push_back(reg.create<position, chunked_health>(
+                    position{1.f, 2.f}, chunked_health{i}));
+            }
+
+            auto buffer = reg.create_buffer_for<position>();
+            buffer.resize(50, position{3.f, 4.f});
+            reg.insert(buffer);
+
+            reg.add_component(ents.begin(), ents.end(), velocity{0.f, 1.f});
+            reg.remove_component<velocity>(ents[0]);
+            reg.destroy(ents.begin() + 50, ents.end());
+
+            CHECK(reg.get<chunked_health>(ents[10]).hp == 10);
+            CHECK(reg.get<velocity>(ents[10]).dy == 1.f);
+            CHECK(resource.allocations > 0);
+
+            // erasing again reuses the scratch space of the group
+            auto allocations = resource.allocations;
+            reg.destroy(ents.begin() + 20, ents.begin() + 30);
+            CHECK(resource.allocations == allocations);
+
+            auto grp = reg.group_container().locate(ents[1])->first;
+            grp.erase_if([](std::size_t row) { return row % 4 == 3; });
+            allocations = resource.allocations;
+            grp.erase_if([](std::size_t row) { return row % 4 == 3; });
+            CHECK(resource.allocations == allocations);
+        }
+
+        CHECK(resource.outstanding == 0);
+    }
+
+    SECTION("group creation failing")
+    {
+        counting_resource resource;
+
+        {
+            registry_type reg{&resource};
+            auto&         cont = reg.group_container();
+            auto          ids  = reg.component_ids<position, velocity>();
+
+            // fail every allocation creating the group in turn
+            for (std::size_t budget = 0;; ++budget)
+            {
+                resource.allocations = 0;
+                resource.fail_after  = budget;
+
+                try
+                {
+                    cont.try_emplace(ids);
+                    break;
+                }
+                catch (const std::bad_alloc&)
+                {
+                    // nothing of the group may have been published
+                    CHECK(cont.group_count() == 0);
+                    CHECK(cont.size() == 0);
+                    CHECK(!cont.find_group(ids));
+                    CHECK(cont.range(2).size() == 0);
+                }
+            }
+
+            resource.fail_after = std::numeric_limits<std::size_t>::max();
+            CHECK(cont.group_count() == 1);
+            CHECK(cont.find_group(ids));
+            CHECK(cont.range(2).size() == 1);
+
+            auto ent = reg.create<position, velocity>(position{1.f, 2.f},
+                                                      velocity{3.f, 4.f});
+            CHECK(reg.get<velocity>(ent).dy == 4.f);
+
+            // a bulk insert creates every entity or none of them
+            auto buffer = reg.create_buffer_for<position, velocity>();
+            buffer.resize(100, position{5.f, 6.f}, velocity{7.f, 8.f});
+
+            for (std::size_t budget = 0;; ++budget)
+            {
+                resource.allocations = 0;
+                resource.fail_after  = budget;
+
+                try
+                {
+                    reg.insert(buffer);
+                    break;
+                }
+                catch (const std::bad_alloc&)
+                {
+                    CHECK(cont.find_group(ids)->size() == 1);
+                    CHECK(cont.entities().size() == 1);
+                    CHECK(reg.get<velocity>(ent).dy == 4.f);
+                }
+            }
+
+            resource.fail_after = std::numeric_limits<std::size_t>::max();
+            CHECK(cont.find_group(ids)->size() == 101);
+            CHECK(cont.entities().size() == 101);
+
+            // adding a component which needs a new group, the stores of which
+            // are duplicated from the entity's group
+            for (std::size_t budget = 0;; ++budget)
+            {
+                resource.allocations = 0;
+                resource.fail_after  = budget;
+
+                try
+                {
+                    reg.add_component<chunked_health>(ent, chunked_health{9});
+                    break;
+                }
+                catch (const std::bad_alloc&)
+                {
+                    auto grp = cont.find_group(
+                        reg.component_ids<position,
+                                          velocity,
+                                          chunked_health>());
+                    CHECK((!grp || grp->size() == 0));
+                    CHECK(reg.try_get<chunked_health>(ent) == nullptr);
+                    CHECK(reg.get<position>(ent).x == 1.f);
+                    CHECK(reg.get<velocity>(ent).dy == 4.f);
+                    CHECK(cont.find_group(ids)->size() == 101);
+                }
+            }
+
+            resource.fail_after = std::numeric_limits<std::size_t>::max();
+            CHECK(reg.get<chunked_health>(ent).hp == 9);
+            CHECK(reg.get<position>(ent).x == 1.f);
+            CHECK(reg.get<velocity>(ent).dy == 4.f);
+            CHECK(cont.find_group(ids)->size() == 100);
+        }
+
+        CHECK(resource.outstanding == 0);
+    }
+
+    SECTION("migration failing")
+    {
+        counting_resource resource;
+
+        {
+            registry_type reg{&resource};
+
+            std::vector<matter::entity> ents;
+            for (int i = 0; i < 10; ++i)
+            {
+                ents.push_back(reg.create<position, chunked_health>(
+                    position{static_cast<float>(i), 0.f}, chunked_health{i}));
+            }
+
+            // fail every allocation of the migration in turn
+            for (std::size_t budget = 0;; ++budget)
+            {
+                resource.allocations = 0;
+                resource.fail_after  = budget;
+
+                try
+                {
+                    reg.add_component(
+                        ents.begin(), ents.end(), velocity{0.f, 1.f});
+                    break;
+                }
+                catch (const std::bad_alloc&)
+                {
+                    // no row left its group
+                    for (int i = 0; i < 10; ++i)
+                    {
+                        CHECK(reg.try_get<velocity>(ents[i]) == nullptr);
+                        CHECK(reg.get<position>(ents[i]).x == i);
+                        CHECK(reg.get<chunked_health>(ents[i]).hp == i);
+                    }
+                }
+            }
+
+            resource.fail_after = std::numeric_limits<std::size_t>::max();
+            for (int i = 0; i < 10; ++i)
+            {
+                CHECK(reg.get<velocity>(ents[i]).dy == 1.f);
+                CHECK(reg.get<position>(ents[i]).x == i);
+                CHECK(reg.get<chunked_health>(ents[i]).hp == i);
+            }
+        }
+
+        CHECK(resource.outstanding == 0);
+    }
+
+    SECTION("arena")
+    {
+        counting_resource upstream;
+
+        {
+            std::pmr::monotonic_buffer_resource arena{&upstream};
+
+            {
+                matter::world<registry_type> world{&arena};
+
+                for (int i = 0; i < 1000; ++i)
+                {
+                    world.create_entity<position, velocity>(
+                        position{0.f, 0.f}, velocity{1.f, 1.f});
+                }
+            }
+
+            // destroying the world doesn't return anything to upstream
+            CHECK(upstream.outstanding > 0);
+            arena.release();
+        }
+
+        CHECK(upstream.outstanding == 0);
+    }
+}
@@ -0,0 +1,204 @@
+#include <catch2/catch.hpp>
+
+#define MATTER_PROFILER
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "matter/dispatcher.hpp"
+#include "matter/query/cached_entities.hpp"
+#include "matter/query/entities.hpp"
+#include "matter/query/processor.hpp"
+#include "matter/system/job.hpp"
+#include "matter/util/profiler.hpp"
+#include "matter/world.hpp"
+
+namespace
+{
+std::size_t count_of(const std::string& str, const std::string& pattern)
+{
+    std::size_t count = 0;
+    for (auto pos = str.find(pattern); pos != std::string::npos;
+         pos      = str.find(pattern, pos + pattern.size()))
+    {
+        ++count;
+    }
+    return count;
+}
+
+std::string chrome_trace(const matter::profiler& prof)
+{
+    std::ostringstream os;
+    prof.write_chrome_trace(os);
+    return os.str();
+}
+} // namespace
+
+TEST_CASE("profiler")
+{
+    static_assert(matter::profiler_enabled);
+
+    SECTION("ring buffer")
+    {
+        auto prof = matter::profiler{4};
+
+        for (int i = 0; i < 6; ++i)
+        {
+            prof.instant("test", "event", {{"index", std::uint64_t(i)}});
+        }
+
+        // only the last 4 are kept
+        CHECK(prof.size() == 4);
+
+        auto trace = chrome_trace(prof);
+        CHECK(count_of(trace, "\"index\":") == 4);
+        CHECK(count_of(trace, "\"index\":1}") == 0);
+        CHECK(count_of(trace, "\"index\":5}") == 1);
+
+        prof.clear();
+        CHECK(prof.size() == 0);
+    }
+
+    SECTION("chrome trace")
+    {
+        auto prof = matter::profiler{};
+
+        {
+            auto scope = matter::profile_scope{"test", "scope", prof};
+            scope.arg("a", 1);
+            scope.arg("b", 2);
+        }
+        prof.instant("test", "quote\"and\\backslash");
+
+        auto trace = chrome_trace(prof);
+
+        CHECK(trace.rfind("{\"traceEvents\":[", 0) == 0);
+        CHECK(count_of(trace, "\"ph\":\"M\"") == 1);
+        CHECK(count_of(trace, "\"name\":\"scope\",\"cat\":\"test\",\"ph\":"
+                              "\"X\"") == 1);
+        CHECK(count_of(trace, "\"args\":{\"a\":1,\"b\":2}") == 1);
+        CHECK(count_of(trace, "\"ph\":\"i\"") == 1);
+        CHECK(count_of(trace, "quote\\\"and\\\\backslash") == 1);
+    }
+
+    SECTION("threads")
+    {
+        auto prof = matter::profiler{};
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&]() {
+                for (int i = 0; i < 100; ++i)
+                {
+                    prof.instant("test", "event");
+                }
+            });
+        }
+
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+
+        CHECK(prof.size() == 400);
+
+        auto trace = chrome_trace(prof);
+        CHECK(count_of(trace, "\"thread_name\"") == 4);
+        for (auto tid : {"0", "1", "2", "3"})
+        {
+            CHECK(count_of(trace,
+                           std::string{"\"pid\":0,\"tid\":"} + tid + "}") ==
+                  100);
+        }
+    }
+
+    SECTION("scope registers its thread")
+    {
+        static_assert(std::is_nothrow_destructible_v<matter::profile_scope>);
+
+        auto prof = matter::profiler{};
+
+        std::size_t threads_in_scope{};
+        std::size_t events_in_scope{};
+
+        std::thread t{[&]() {
+            auto scope = matter::profile_scope{"test", "scope", prof};
+
+            // the buffer exists before the scope records anything
+            threads_in_scope = count_of(chrome_trace(prof), "\"thread_name\"");
+            events_in_scope  = prof.size();
+        }};
+        t.join();
+
+        CHECK(threads_in_scope == 1);
+        CHECK(events_in_scope == 0);
+        CHECK(prof.size() == 1);
+    }
+
+    SECTION("instrumentation")
+    {
+        using boost::hana::type_c;
+
+        auto& prof = matter::profiler::global();
+        prof.clear();
+
+        auto world = matter::world{};
+        world.register_component<int>();
+        world.register_component<float>();
+
+        for (int i = 0; i < 10; ++i)
+        {
+            world.create_entity<int>(i);
+        }
+        world.create_entity<int, float>(1, 1.f);
+        world.create_entity<float>(1.f);
+
+        auto trace = chrome_trace(prof);
+        CHECK(count_of(trace, "\"name\":\"create group\"") == 3);
+        CHECK(count_of(trace, "\"name\":\"reallocate\"") > 0);
+
+        prof.clear();
+
+        auto job = matter::make_job<matter::entities<matter::read<int>>>(
+            [](auto&& groups) {
+                for (auto&& res : groups)
+                {
+                    (void) res;
+                }
+            });
+        matter::invoke_job(job, world);
+
+        trace = chrome_trace(prof);
+        CHECK(count_of(trace, "\"cat\":\"job\",\"ph\":\"X\"") == 1);
+        CHECK(count_of(trace,
+                       "\"args\":{\"groups visited\":3,\"groups matched\":2,"
+                       "\"rows\":11}") == 1);
+        // the rows are counted in the same pass the query is walked in
+        prof.clear();
+
+        auto eq  = matter::entities{type_c<matter::read<int>>};
+        auto sum = 0;
+        matter::for_each(
+            matter::execution::seq, eq, world, [&](int i) { sum += i; });
+        CHECK(sum == 46);
+
+        auto cached = matter::cached_entities{type_c<matter::read<float>>};
+        for (auto&& res : matter::process_query(cached, world))
+        {
+            (void) res;
+        }
+
+        trace = chrome_trace(prof);
+        CHECK(count_of(trace, "\"cat\":\"query\"") == 2);
+        CHECK(count_of(trace,
+                       "\"args\":{\"groups visited\":3,\"groups matched\":2,"
+                       "\"rows\":11}") == 1);
+        CHECK(count_of(trace,
+                       "\"args\":{\"groups visited\":3,\"groups matched\":2,"
+                       "\"rows\":2}") == 1);
+    }
+}
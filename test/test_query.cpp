@@ -1,11 +1,15 @@
 #include <catch2/catch.hpp>
 
+#include <atomic>
+
 #include "matter/component/registry.hpp"
 #include "matter/id/default_component_identifier.hpp"
 #include "matter/id/id_cache.hpp"
+#include "matter/query/cached_entities.hpp"
 #include "matter/query/entities.hpp"
 #include "matter/query/primitives/concurrency.hpp"
 #include "matter/query/processor.hpp"
+#include "matter/query/runtime_entities.hpp"
 #include "matter/query/type_query.hpp"
 #include "matter/query/type_traits.hpp"
 #include "matter/world.hpp"
@@ -231,5 +235,397 @@ TEST_CASE("query")
             REQUIRE(matched == 2);
             REQUIRE(opt_present == 1);
         }
+
+        SECTION("for_each")
+        {
+            using boost::hana::type_c;
+
+            // [int] and [int, float]
+            auto eq = matter::entities{type_c<matter::write<int>>};
+
+            matter::for_each(matter::execution::unseq, eq, w, [](int& i) {
+                i *= 2;
+            });
+
+            auto sum = 0;
+            matter::for_each(
+                matter::execution::seq, eq, w, [&](int& i) { sum += i; });
+            REQUIRE(sum == 8);
+
+            // only [int], the excluded float is not passed
+            auto eq1 = matter::entities{type_c<matter::write<int>>,
+                                        type_c<matter::has_not<float>>};
+
+            sum = 0;
+            matter::for_each(
+                matter::execution::unseq, eq1, w, [&](int& i) { sum += i; });
+            REQUIRE(sum == 6);
+
+            // a large group and a few small ones, split into ranges of 100
+            w.register_component<char>();
+            for (int i = 0; i < 1000; ++i)
+            {
+                w.create_entity<int>(1);
+            }
+            for (int i = 0; i < 10; ++i)
+            {
+                w.create_entity<int, float, char>(1, 1.f, 'a');
+                w.create_entity<int, char>(1, 'a');
+            }
+
+            matter::thread_pool pool{3};
+            auto policy = matter::execution::par.on(pool).grain(100);
+
+            std::atomic<int> par_sum{0};
+            matter::for_each(policy, eq, w, [&](int& i) { par_sum += i; });
+            REQUIRE(par_sum == 8 + 1020);
+        }
+    }
+}
+
+TEST_CASE("changed")
+{
+    using boost::hana::type_c;
+
+    auto world = matter::world{};
+    world.register_component<int>();
+    world.register_component<float>();
+    world.register_component<char>();
+
+    for (int i = 0; i < 10; ++i)
+    {
+        world.create_entity<int>(i);
+        world.create_entity<int, float>(i, 1.f);
+    }
+
+    auto changed_ints = matter::entities{type_c<matter::changed<int>>};
+
+    // the number of ints in groups where they changed
+    auto count_changed = [&]() {
+        std::size_t count = 0;
+        for (auto [ints] : matter::process_query(changed_ints, world))
+        {
+            count += ints.size();
+        }
+        return count;
+    };
+
+    static_assert(decltype(changed_ints)::tracks_changes);
+    static_assert(!matter::entities<matter::read<int>>::tracks_changes);
+
+    // everything is new to the query at first
+    CHECK(count_changed() == 20);
+    CHECK(count_changed() == 0);
+
+    SECTION("write")
+    {
+        auto write_ints = matter::entities{type_c<matter::write<int>>,
+                                           type_c<matter::has<float>>};
+        for (auto [ints, floats] : matter::process_query(write_ints, world))
+        {
+            (void) ints;
+            (void) floats;
+        }
+
+        // only the group the write query visited changed
+        CHECK(count_changed() == 10);
+        CHECK(count_changed() == 0);
+
+        // reading doesn't change anything, neither does writing another
+        // component
+        auto read_ints    = matter::entities{type_c<matter::read<int>>};
+        auto write_floats = matter::entities{type_c<matter::write<float>>};
+        for (auto&& grp : matter::process_query(read_ints, world))
+        {
+            (void) grp;
+        }
+        for (auto&& grp : matter::process_query(write_floats, world))
+        {
+            (void) grp;
+        }
+        CHECK(count_changed() == 0);
+    }
+
+    SECTION("structural")
+    {
+        auto ent = world.create_entity<int, char>(5, 'a');
+        CHECK(count_changed() == 1);
+
+        world.create_entity<int>(0);
+        CHECK(count_changed() == 11);
+
+        // erasing rows isn't a change
+        world.destroy_entity(ent);
+        CHECK(count_changed() == 0);
+
+        // migrating marks the destination
+        auto cmds = world.make_command_buffer();
+        cmds.add_component<char>(world.create_entity<int>(1), 'b');
+        CHECK(count_changed() == 12);
+        cmds.apply();
+        CHECK(count_changed() == 1);
+    }
+
+    SECTION("multiple queries")
+    {
+        // a query created later sees everything once, independent of others
+        auto other = matter::entities{type_c<matter::changed<int>>,
+                                      type_c<matter::read<float>>};
+        std::size_t count = 0;
+        for (auto [ints, floats] : matter::process_query(other, world))
+        {
+            count += ints.size();
+            (void) floats;
+        }
+        CHECK(count == 10);
+        CHECK(count_changed() == 0);
+    }
+}
+
+TEST_CASE("cached_entities")
+{
+    using boost::hana::type_c;
+
+    auto world = matter::world{};
+    world.register_component<int>();
+    world.register_component<float>();
+    world.register_component<char>();
+
+    world.create_entity<int>(1);
+    world.create_entity<int, float>(2, 1.f);
+    world.create_entity<float>(3.f);
+
+    auto cached = matter::cached_entities{type_c<matter::write<int>>,
+                                          type_c<matter::opt_read<float>>};
+
+    auto sum = [&]() {
+        int total = 0;
+        for (auto [ints, floats] : matter::process_query(cached, world))
+        {
+            for (auto i : ints)
+            {
+                total += i;
+            }
+            (void) floats;
+        }
+        return total;
+    };
+
+    // the same results as the uncached query
+    using result_type = decltype(cached)::result_type;
+    auto uncached     = matter::entities{type_c<matter::write<int>>,
+                                     type_c<matter::opt_read<float>>};
+    for (auto&& res : matter::process_query(uncached, world))
+    {
+        static_assert(std::is_same_v<std::decay_t<decltype(res)>, result_type>);
+    }
+
+    CHECK(sum() == 3);
+    CHECK(cached.size() == 2);
+
+    // rows added to known groups show up without refiltering
+    world.create_entity<int>(10);
+    CHECK(sum() == 13);
+
+    // new groups are only tested once
+    world.create_entity<int, char>(100, 'a');
+    world.create_entity<float, char>(1.f, 'a');
+    CHECK(sum() == 113);
+    CHECK(cached.size() == 3);
+    CHECK(sum() == 113);
+    CHECK(cached.size() == 3);
+
+    SECTION("changed")
+    {
+        auto changed = matter::cached_entities{type_c<matter::changed<int>>};
+        auto count   = [&]() {
+            std::size_t groups = 0;
+            for (auto&& res : matter::process_query(changed, world))
+            {
+                (void) res;
+                ++groups;
+            }
+            return groups;
+        };
+
+        CHECK(count() == 3);
+        CHECK(count() == 0);
+
+        // the cached write query marks every group it matches
+        sum();
+        CHECK(count() == 3);
+
+        world.create_entity<int, float>(1, 1.f);
+        CHECK(count() == 1);
+        CHECK(count() == 0);
+    }
+
+    SECTION("another world")
+    {
+        auto other = matter::world{};
+        other.register_component<int>();
+        other.register_component<float>();
+        other.create_entity<int>(5);
+
+        int total = 0;
+        for (auto [ints, floats] : matter::process_query(cached, other))
+        {
+            total += ints[0];
+            (void) floats;
+        }
+        CHECK(total == 5);
+        CHECK(cached.size() == 1);
+    }
+
+    SECTION("assigned world")
+    {
+        // the address stays the same while the groups are gone
+        world = matter::world{};
+        world.register_component<int>();
+        world.register_component<float>();
+        world.create_entity<int>(7);
+
+        CHECK(sum() == 7);
+        CHECK(cached.size() == 1);
+    }
+
+    SECTION("for_each")
+    {
+        auto cached_rows =
+            matter::cached_entities{type_c<matter::write<int>>};
+        matter::for_each(
+            matter::execution::unseq, cached_rows, world, [](int& i) {
+                i *= 2;
+            });
+        CHECK(sum() == 226);
+    }
+}
+
+TEST_CASE("runtime_entities")
+{
+    using boost::hana::type_c;
+
+    auto world = matter::world{};
+    world.register_component<int>();
+    world.register_component<float>();
+    world.register_component<char>();
+
+    world.create_entity<int>(1);
+    world.create_entity<int, float>(2, 2.f);
+    world.create_entity<int, char>(3, 'a');
+    world.create_entity<float>(4.f);
+
+    using description =
+        matter::component_query_description<decltype(world)::id_type>;
+
+    auto int_id   = world.component_id<int>();
+    auto float_id = world.component_id<float>();
+    auto char_id  = world.component_id<char>();
+
+    SECTION("require")
+    {
+        auto rq = matter::runtime_entities{
+            description{
+                int_id, matter::access::read, matter::presence::require},
+            description{
+                float_id, matter::access::read, matter::presence::optional}};
+
+        int   ints   = 0;
+        float floats = 0.f;
+        for (auto& res : matter::process_query(rq, world))
+        {
+            REQUIRE(res[0]);
+            CHECK(res[0]->id() == int_id.base());
+
+            auto& int_store = res[0]->get<int>();
+            CHECK(int_store.size() == res.size());
+            for (auto i : int_store)
+            {
+                ints += i;
+            }
+
+            if (res[1])
+            {
+                for (auto f : res[1]->get<float>())
+                {
+                    floats += f;
+                }
+            }
+        }
+
+        CHECK(ints == 6);
+        CHECK(floats == 2.f);
+    }
+
+    SECTION("exclude")
+    {
+        auto rq = matter::runtime_entities{
+            description{
+                int_id, matter::access::read, matter::presence::require},
+            description{
+                char_id, matter::access::read, matter::presence::exclude}};
+
+        std::size_t groups = 0;
+        for (auto& res : matter::process_query(rq, world))
+        {
+            CHECK(res[1] == nullptr);
+            CHECK(res[0]->get<int>()[0] != 3);
+            ++groups;
+        }
+        CHECK(groups == 2);
+    }
+
+    SECTION("same groups as the static query")
+    {
+        auto rq = matter::runtime_entities{
+            description{
+                float_id, matter::access::write, matter::presence::require},
+            description{
+                int_id, matter::access::read, matter::presence::require}};
+        auto eq = matter::entities{type_c<matter::write<float>>,
+                                   type_c<matter::read<int>>};
+
+        std::vector<const void*> runtime_stores;
+        for (auto& res : matter::process_query(rq, world))
+        {
+            runtime_stores.push_back(std::addressof(res[0]->get<float>()));
+        }
+
+        std::vector<const void*> static_stores;
+        for (auto [floats, ints] : matter::process_query(eq, world))
+        {
+            (void) ints;
+            static_stores.push_back(std::addressof(floats));
+        }
+
+        CHECK(runtime_stores == static_stores);
+    }
+
+    SECTION("writes mark changes")
+    {
+        auto changed = matter::entities{type_c<matter::changed<float>>};
+        auto count   = [&]() {
+            std::size_t groups = 0;
+            for (auto&& res : matter::process_query(changed, world))
+            {
+                (void) res;
+                ++groups;
+            }
+            return groups;
+        };
+
+        CHECK(count() == 2);
+        CHECK(count() == 0);
+
+        auto reader = matter::runtime_entities{description{
+            float_id, matter::access::read, matter::presence::require}};
+        matter::process_query(reader, world);
+        CHECK(count() == 0);
+
+        auto writer = matter::runtime_entities{description{
+            float_id, matter::access::write, matter::presence::require}};
+        CHECK(writer.writes());
+        matter::process_query(writer, world);
+        CHECK(count() == 2);
     }
 }
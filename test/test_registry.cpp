@@ -56,4 +56,76 @@ TEST_CASE("registry")
         reg.create<float_comp, int_comp>(std::forward_as_tuple(5.0f),
                                          std::forward_as_tuple(5));
     }
+
+    SECTION("create_n")
+    {
+        reg.create<float_comp, int_comp>(1.0f, 1);
+
+        // every entity gets a copy of the arguments
+        auto filled = reg.create_n<float_comp, int_comp>(
+            100, float_comp{2.0f}, std::forward_as_tuple(3));
+        CHECK(filled.size() == 100);
+
+        auto grp = *reg.group_container().find_group(
+            reg.component_ids<float_comp, int_comp>());
+        CHECK(grp.size() == 101);
+
+        for (auto ent : filled)
+        {
+            CHECK(reg.contains(ent));
+            CHECK(reg.get<float_comp>(ent).f == 2.0f);
+            CHECK(reg.get<int_comp>(ent).i == 3);
+        }
+
+        // each entity is constructed from the generator
+        auto generated = reg.create_n<int_comp, float_comp>(
+            50, [](std::size_t i) {
+                return std::tuple{int_comp{static_cast<int>(i)},
+                                  std::tuple{0.5f}};
+            });
+        CHECK(generated.size() == 50);
+        CHECK(grp.size() == 151);
+
+        for (std::size_t i = 0; i < generated.size(); ++i)
+        {
+            CHECK(reg.get<int_comp>(generated[i]).i == static_cast<int>(i));
+            CHECK(reg.get<float_comp>(generated[i]).f == 0.5f);
+        }
+
+        // a single component may be generated without a tuple
+        auto single = reg.create_n<int_comp>(
+            10, [](std::size_t i) { return int_comp{static_cast<int>(i)}; });
+        CHECK(single.size() == 10);
+        CHECK(reg.get<int_comp>(single.back()).i == 9);
+        CHECK(!reg.try_get<float_comp>(single.front()));
+
+        CHECK(reg.create_n<int_comp>(0, 7).empty());
+    }
+
+    SECTION("create_n then migrate")
+    {
+        // migrating swaps rows within the group, the handles must not change
+        auto created = reg.create_n<int_comp>(
+            20, [](std::size_t i) { return int_comp{static_cast<int>(i)}; });
+
+        for (auto ent : created)
+        {
+            reg.add_component<float_comp>(ent, 1.0f);
+        }
+
+        for (std::size_t i = 0; i < created.size(); ++i)
+        {
+            CHECK(reg.get<int_comp>(created[i]).i == static_cast<int>(i));
+            CHECK(reg.get<float_comp>(created[i]).f == 1.0f);
+        }
+
+        // creating more can't invalidate the handles either
+        auto more = reg.create_n<int_comp, float_comp>(
+            1000, int_comp{0}, float_comp{2.0f});
+        for (auto ent : created)
+        {
+            CHECK(reg.get<float_comp>(ent).f == 1.0f);
+        }
+        CHECK(more.size() == 1000);
+    }
 }
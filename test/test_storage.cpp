@@ -1,5 +1,15 @@
 #include <catch2/catch.hpp>
 
+#include "matter/component/group_slice.hpp"
+#include "matter/component/registry.hpp"
+#include "matter/id/default_component_identifier.hpp"
+#include "matter/query/entities.hpp"
+#include "matter/query/processor.hpp"
+#include "matter/storage/aligned_vector.hpp"
+#include "matter/storage/chunked_storage.hpp"
+#include "matter/storage/chunks.hpp"
+#include "matter/storage/empty_storage.hpp"
+#include "matter/storage/shared_storage.hpp"
 #include "matter/storage/sparse_vector.hpp"
 #include "matter/storage/sparse_vector_storage.hpp"
 #include "matter/storage/traits.hpp"
@@ -156,3 +166,658 @@ TEST_CASE("sparse_vector")
         }
     }
 }
+
+struct chunked_component
+{
+    using storage_type = matter::chunked_storage<chunked_component, 8>;
+
+    int i;
+};
+
+TEST_CASE("chunked_storage")
+{
+    matter::chunked_storage<int, 4> storage;
+
+    SECTION("append")
+    {
+        for (int i = 0; i < 10; ++i)
+        {
+            storage.push_back(i);
+        }
+
+        CHECK(storage.size() == 10);
+        CHECK(storage.chunk_count() == 3);
+        CHECK(storage.capacity() == 12);
+        CHECK(storage.chunk_extent(0) == 4);
+        CHECK(storage.chunk_extent(2) == 2);
+        CHECK(storage.back() == 9);
+        CHECK(std::distance(storage.begin(), storage.end()) == 10);
+
+        int expected = 0;
+        for (auto i : storage)
+        {
+            CHECK(i == expected++);
+        }
+    }
+
+    SECTION("stable references")
+    {
+        storage.push_back(42);
+        auto* first = std::addressof(storage[0]);
+
+        for (int i = 0; i < 100; ++i)
+        {
+            storage.push_back(i);
+        }
+
+        CHECK(first == std::addressof(storage[0]));
+        CHECK(*first == 42);
+    }
+
+    SECTION("insert and erase")
+    {
+        std::vector<int> values{1, 2, 3, 4, 5, 6};
+        storage.insert(storage.end(), values.begin(), values.end());
+        CHECK(storage.size() == 6);
+
+        // insert in the middle
+        std::vector<int> middle{10, 11};
+        storage.insert(storage.begin() + 1, middle.begin(), middle.end());
+        CHECK(storage[1] == 10);
+        CHECK(storage[2] == 11);
+        CHECK(storage[3] == 2);
+        CHECK(storage.back() == 6);
+
+        storage.erase(storage.begin() + 1);
+        CHECK(storage[1] == 11);
+        CHECK(storage.size() == 7);
+
+        storage.erase(storage.end() - 1);
+        CHECK(storage.back() == 5);
+    }
+
+    SECTION("append copy")
+    {
+        storage.push_back(-1);
+
+        // spans the rest of the first chunk and two more
+        std::vector<int> values{0, 1, 2, 3, 4, 5, 6, 7, 8};
+        matter::append_copy(storage, values.data(), values.size());
+        CHECK(storage.size() == 10);
+        CHECK(storage.chunk_count() == 3);
+        CHECK(storage[0] == -1);
+        for (int i = 0; i < 9; ++i)
+        {
+            CHECK(storage[static_cast<std::size_t>(i) + 1] == i);
+        }
+
+        std::vector<int> contiguous{-1};
+        matter::append_copy(contiguous, values.data(), values.size());
+        CHECK(std::equal(storage.begin(),
+                         storage.end(),
+                         contiguous.begin(),
+                         contiguous.end()));
+    }
+
+    SECTION("copy and move")
+    {
+        storage.resize(9, 3);
+
+        auto copy = storage;
+        CHECK(copy.size() == 9);
+        CHECK(copy[8] == 3);
+
+        auto moved = std::move(copy);
+        CHECK(moved.size() == 9);
+        CHECK(copy.empty());
+    }
+}
+
+TEST_CASE("chunked_storage component")
+{
+    auto reg = matter::registry<matter::default_component_identifier<
+        matter::unsigned_id<std::size_t>,
+        chunked_component>>{};
+
+    std::vector<matter::entity> ents;
+    for (int i = 0; i < 20; ++i)
+    {
+        ents.push_back(reg.create<chunked_component>(chunked_component{i}));
+    }
+
+    // swap and pop goes through the erased vtable
+    reg.destroy(ents[0]);
+    CHECK(reg.get<chunked_component>(ents[19]).i == 19);
+
+    auto buffer = reg.create_buffer_for<chunked_component>();
+    buffer.resize(5, chunked_component{-1});
+    reg.insert(buffer);
+
+    auto grp = reg.group_container().find_group(
+        reg.component_ids<chunked_component>());
+    REQUIRE(grp);
+    CHECK(grp->size() == 24);
+
+    int sum = 0;
+    for (auto view : *grp)
+    {
+        sum += view.template get<chunked_component>().i;
+    }
+
+    // 1 + ... + 19 - 5
+    CHECK(sum == 185);
+}
+
+struct marker
+{};
+
+TEST_CASE("empty_storage")
+{
+    matter::empty_storage<marker> storage;
+
+    static_assert(std::is_same_v<matter::component_storage_t<marker>,
+                                 matter::empty_storage<marker>>);
+    static_assert(matter::is_storage_broadcast_v<decltype(storage)>);
+    static_assert(!matter::is_storage_chunked_v<decltype(storage)>);
+
+    SECTION("count")
+    {
+        for (int i = 0; i < 10; ++i)
+        {
+            storage.push_back(marker{});
+        }
+        storage.emplace_back();
+
+        CHECK(storage.size() == 11);
+        CHECK(storage.capacity() >= 11);
+        CHECK(std::distance(storage.begin(), storage.end()) == 11);
+
+        // every element is the same instance
+        CHECK(std::addressof(storage[0]) == std::addressof(storage[10]));
+        CHECK(std::addressof(storage.back()) ==
+              std::addressof(*storage.begin()));
+
+        storage.erase(storage.begin() + 3);
+        storage.pop_back();
+        CHECK(storage.size() == 9);
+
+        storage.erase(storage.begin() + 4, storage.end());
+        CHECK(storage.size() == 4);
+
+        std::vector<marker> values(5);
+        matter::append_copy(storage, values.data(), values.size());
+        storage.insert(storage.begin(), values.begin(), values.end());
+        CHECK(storage.size() == 14);
+
+        storage.resize(2);
+        CHECK(storage.size() == 2);
+
+        storage.clear();
+        CHECK(storage.empty());
+    }
+
+    SECTION("chunks")
+    {
+        storage.resize(100000);
+
+        // the tag is broadcast, the blocks follow the other columns
+        std::vector<int>                contiguous(storage.size(), 1);
+        matter::chunked_storage<int, 8> chunked;
+        chunked.resize(storage.size(), 1);
+
+        std::vector<std::size_t> counts;
+        matter::for_each_chunk(
+            [&](std::size_t                   count,
+                matter::broadcast_ptr<marker> tags,
+                int*                          c) {
+                counts.push_back(count);
+                CHECK(tags.get() == storage.broadcast_data());
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    ++c[i];
+                }
+            },
+            storage,
+            contiguous);
+
+        CHECK(counts == std::vector<std::size_t>{storage.size()});
+        CHECK(std::count(contiguous.begin(), contiguous.end(), 2) ==
+              static_cast<std::ptrdiff_t>(storage.size()));
+
+        counts.clear();
+        matter::for_each_chunk(
+            [&](std::size_t count, matter::broadcast_ptr<const marker>, int*) {
+                counts.push_back(count);
+            },
+            std::as_const(storage),
+            chunked);
+
+        CHECK(counts.size() == storage.size() / 8);
+        CHECK(counts.front() == 8);
+    }
+}
+
+struct valued_tag
+{
+    valued_tag(int)
+    {}
+};
+
+TEST_CASE("empty_storage without default constructor")
+{
+    // the instance is copied from the first row
+    matter::empty_storage<valued_tag> storage;
+    storage.emplace_back(1);
+    storage.push_back(valued_tag{2});
+
+    CHECK(storage.size() == 2);
+    CHECK(std::addressof(storage[0]) == storage.broadcast_data());
+}
+
+TEST_CASE("empty_storage component")
+{
+    auto reg = matter::registry<matter::default_component_identifier<
+        matter::unsigned_id<std::size_t>,
+        my_component,
+        marker>>{};
+
+    std::vector<matter::entity> ents;
+    for (int i = 0; i < 20; ++i)
+    {
+        ents.push_back(
+            reg.create<my_component, marker>(my_component{i}, marker{}));
+    }
+    reg.create_n<marker>(5, marker{});
+
+    // migrating away from and back into the tagged group
+    reg.remove_component<marker>(ents[3]);
+    reg.add_component<marker>(ents[3]);
+    reg.destroy(ents[0]);
+    CHECK(reg.try_get<marker>(ents[3]));
+    CHECK(reg.get<my_component>(ents[19]).i == 19);
+
+    auto grp = reg.group_container().find_group(
+        reg.component_ids<my_component, marker>());
+    REQUIRE(grp);
+    CHECK(grp->size() == 19);
+
+    auto  any_grp = reg.group_container().locate(ents[1])->first;
+    auto& markers = *any_grp.maybe_storage(reg.component_id<marker>());
+    static_assert(
+        std::is_same_v<std::decay_t<decltype(markers)>,
+                       matter::empty_storage<marker>>);
+    CHECK(markers.size() == 19);
+
+    // queries still match on the tag
+    using boost::hana::type_c;
+    auto eq      = matter::entities{type_c<matter::read<my_component>>,
+                                    type_c<matter::has<marker>>};
+    auto matched = std::size_t{0};
+    for (auto [comps, tags] : matter::process_entity_query(
+             eq, reg.group_container().range(), reg))
+    {
+        (void) tags;
+        matched += comps.size();
+    }
+    CHECK(matched == 19);
+
+    auto sum = 0;
+    matter::for_each(matter::execution::unseq,
+                     *grp,
+                     [&](my_component& c, marker&) { sum += c.i; });
+    // 1 + ... + 19
+    CHECK(sum == 190);
+}
+
+struct material
+{
+    using storage_type = matter::shared_storage<material>;
+
+    int id;
+};
+
+TEST_CASE("shared_storage component")
+{
+    auto reg = matter::registry<matter::default_component_identifier<
+        matter::unsigned_id<std::size_t>,
+        my_component,
+        material>>{};
+
+    auto group_of = [&](matter::entity ent) {
+        return reg.group_container().locate(ent)->first.metadata();
+    };
+
+    std::vector<matter::entity> ents;
+    for (int i = 0; i < 20; ++i)
+    {
+        ents.push_back(reg.create<my_component, material>(my_component{i},
+                                                          material{i % 2}));
+    }
+
+    // every value gets its own group, the ids alone find neither
+    CHECK(group_of(ents[0]) == group_of(ents[2]));
+    CHECK(group_of(ents[0]) != group_of(ents[1]));
+    CHECK(!reg.group_container().find_group(group_of(ents[0])->ids()));
+    CHECK(reg.get<material>(ents[1]).id == 1);
+    CHECK(reg.get<my_component>(ents[19]).i == 19);
+
+    // the value picks the group, so it can only be changed by set_shared
+    static_assert(std::is_same_v<decltype(reg.get<material>(ents[1])),
+                                 const material&>);
+    static_assert(std::is_same_v<decltype(reg.try_get<material>(ents[1])),
+                                 const material*>);
+    static_assert(std::is_same_v<decltype(reg.get<my_component>(ents[1])),
+                                 my_component&>);
+
+    auto even = reg.group_container().find_shared_group(
+        reg.component_ids<my_component, material>(),
+        my_component{0},
+        material{0});
+    REQUIRE(even);
+    CHECK(even->size() == 10);
+
+    auto  any_grp   = reg.group_container().locate(ents[0])->first;
+    auto& materials = *any_grp.maybe_storage(reg.component_id<material>());
+    static_assert(
+        std::is_same_v<std::decay_t<decltype(materials)>,
+                       matter::shared_storage<material>>);
+    CHECK(materials.value().id == 0);
+    CHECK(materials.size() == 10);
+
+    SECTION("set")
+    {
+        auto before = group_of(ents[0]);
+        reg.set_shared(ents[0], material{0});
+        CHECK(group_of(ents[0]) == before);
+
+        reg.set_shared(ents[0], material{1});
+        CHECK(group_of(ents[0]) == group_of(ents[1]));
+        CHECK(reg.get<material>(ents[0]).id == 1);
+        CHECK(reg.get<my_component>(ents[0]).i == 0);
+
+        CHECK(reg.set_shared(ents[0], material{7}));
+        CHECK(reg.get<material>(ents[0]).id == 7);
+
+        // dead entities and those without it are left alone
+        auto plain = reg.create<my_component>(my_component{0});
+        CHECK(!reg.set_shared(plain, material{7}));
+        reg.destroy(ents[4]);
+        CHECK(!reg.set_shared(ents[4], material{7}));
+        CHECK(reg.get<material>(ents[2]).id == 0);
+        CHECK(even->size() == 8);
+    }
+
+    SECTION("add and remove")
+    {
+        auto plain = reg.create<my_component>(my_component{42});
+
+        reg.add_component<material>(plain, 1);
+        CHECK(group_of(plain) == group_of(ents[1]));
+        CHECK(reg.get<my_component>(plain).i == 42);
+
+        // removing and adding it back with another value
+        reg.remove_component<material>(plain);
+        CHECK(!reg.try_get<material>(plain));
+        reg.add_component<material>(plain, 0);
+        CHECK(group_of(plain) == group_of(ents[0]));
+
+        reg.remove_component<material>(plain);
+        reg.add_component<material>(plain, 3);
+        CHECK(reg.get<material>(plain).id == 3);
+
+        // bulk add picks the group of the value
+        auto more = reg.create_n<my_component>(5, my_component{1});
+        reg.add_component(more.begin(), more.end(), material{1});
+        CHECK(reg.get<material>(ents[1]).id == 1);
+        CHECK(group_of(ents[1])->size() == 15);
+    }
+
+    SECTION("bulk create")
+    {
+        auto filled = reg.create_n<my_component, material>(
+                              5, my_component{0}, material{4})
+                          .front();
+        CHECK(reg.get<material>(filled).id == 4);
+        CHECK(group_of(filled)->size() == 5);
+
+        auto buffer = reg.create_buffer_for<my_component, material>();
+        for (int i = 0; i < 10; ++i)
+        {
+            buffer.emplace_back(my_component{i}, material{i < 5 ? 4 : 0});
+        }
+        reg.insert(buffer);
+
+        CHECK(group_of(filled)->size() == 10);
+        CHECK(even->size() == 15);
+    }
+
+    SECTION("query")
+    {
+        using boost::hana::type_c;
+        auto eq = matter::entities{type_c<matter::read<my_component>>,
+                                   type_c<matter::read<material>>};
+
+        auto sum = 0;
+        for (auto [comps, mats] : matter::process_entity_query(
+                 eq, reg.group_container().range(), reg))
+        {
+            // read the shared value once per group
+            auto value = mats.value().id;
+            for (auto& c : comps)
+            {
+                sum += c.i * value;
+            }
+        }
+        // 1 + 3 + ... + 19
+        CHECK(sum == 100);
+
+        // or have it broadcast, which spans every row of the other columns
+        auto  odd   = reg.group_container().locate(ents[1])->first;
+        auto& comps = *odd.maybe_storage(reg.component_id<my_component>());
+        auto& mats  = *odd.maybe_storage(reg.component_id<material>());
+        static_assert(matter::is_storage_broadcast_v<std::decay_t<decltype(
+                          mats)>>);
+        static_assert(std::is_same_v<decltype(mats[0]), const material&>);
+
+        auto calls = 0;
+        sum        = 0;
+        matter::for_each_chunk(
+            [&](std::size_t                           count,
+                const my_component*                   c,
+                matter::broadcast_ptr<const material> m) {
+                ++calls;
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    sum += c[i].i * m[i].id;
+                }
+            },
+            std::as_const(comps),
+            mats);
+        CHECK(calls == 1);
+        CHECK(sum == 100);
+
+        auto odd_grp = reg.group_container().find_shared_group(
+            reg.component_ids<my_component, material>(),
+            my_component{0},
+            material{1});
+        REQUIRE(odd_grp);
+
+        sum = 0;
+        matter::for_each(matter::execution::unseq,
+                         *odd_grp,
+                         [&](my_component& c, const material& m) {
+                             sum += c.i * m.id;
+                         });
+        CHECK(sum == 100);
+    }
+}
+
+struct aligned_component
+{
+    using storage_type = matter::aligned_vector<aligned_component>;
+
+    float x;
+    float y;
+    float z;
+};
+
+struct aligned_velocity
+{
+    using storage_type = matter::aligned_vector<aligned_velocity>;
+
+    float x;
+    float y;
+};
+
+TEST_CASE("aligned_vector")
+{
+    SECTION("alignment and padding")
+    {
+        using allocator_type = matter::aligned_allocator<float>;
+        CHECK(allocator_type::lanes == 16);
+        CHECK(allocator_type::padded_size(1) == 16);
+        CHECK(allocator_type::padded_size(16) == 16);
+        CHECK(allocator_type::padded_size(17) == 32);
+
+        matter::aligned_vector<float> vec;
+
+        for (int i = 0; i < 100; ++i)
+        {
+            vec.push_back(static_cast<float>(i));
+            CHECK(reinterpret_cast<std::uintptr_t>(vec.data()) % 64 == 0);
+        }
+
+        CHECK(matter::padded_size(vec) == 112);
+
+        // the padding may be written to by kernels
+        for (std::size_t i = vec.size(); i < matter::padded_size(vec); ++i)
+        {
+            vec.data()[i] = 0.f;
+        }
+        CHECK(vec[99] == 99.f);
+    }
+
+    SECTION("group")
+    {
+        auto reg = matter::registry<matter::default_component_identifier<
+            matter::unsigned_id<std::size_t>,
+            aligned_component,
+            aligned_velocity>>{};
+
+        auto buffer =
+            reg.create_buffer_for<aligned_component, aligned_velocity>();
+        buffer.resize(37,
+                      aligned_component{1.f, 2.f, 3.f},
+                      aligned_velocity{4.f, 5.f});
+        reg.insert(buffer);
+
+        auto grp = reg.group_container().find_group(
+            reg.component_ids<aligned_component, aligned_velocity>());
+        REQUIRE(grp);
+
+        // 64 / 12 = 5 and 64 / 8 = 8 lanes
+        CHECK(grp->lanes == 40);
+        CHECK(grp->capacity<aligned_component>() % 40 == 0);
+        CHECK(grp->capacity<aligned_velocity>() % 40 == 0);
+
+        grp->reserve(81);
+        CHECK(grp->capacity<aligned_component>() == 120);
+        CHECK(grp->capacity<aligned_velocity>() == 120);
+
+        auto  any_grp   = reg.group_container().locate(grp->entity_at(0))->first;
+        auto& positions =
+            *any_grp.maybe_storage(reg.component_id<aligned_component>());
+        CHECK(reinterpret_cast<std::uintptr_t>(positions.data()) % 64 == 0);
+        CHECK(positions.get_allocator().resource() == reg.resource());
+        CHECK(positions[36].z == 3.f);
+    }
+}
+
+TEST_CASE("for_each_chunk")
+{
+    SECTION("lockstep")
+    {
+        matter::chunked_storage<int, 4> small;
+        matter::chunked_storage<int, 8> large;
+        std::vector<int>                contiguous;
+
+        for (int i = 0; i < 19; ++i)
+        {
+            small.push_back(i);
+            large.push_back(2 * i);
+            contiguous.push_back(3 * i);
+        }
+
+        std::vector<std::size_t> counts;
+        int                      row = 0;
+
+        matter::for_each_chunk(
+            [&](std::size_t count, int* s, int* l, const int* c) {
+                counts.push_back(count);
+
+                for (std::size_t i = 0; i < count; ++i, ++row)
+                {
+                    CHECK(s[i] == row);
+                    CHECK(l[i] == 2 * row);
+                    CHECK(c[i] == 3 * row);
+                }
+            },
+            small,
+            large,
+            std::as_const(contiguous));
+
+        // blocks end on the boundaries of the smallest chunks
+        CHECK(counts == std::vector<std::size_t>{4, 4, 4, 4, 3});
+        CHECK(row == 19);
+
+        // contiguous storages are handed over at once
+        counts.clear();
+        matter::for_each_chunk(
+            [&](std::size_t count, int*) { counts.push_back(count); },
+            contiguous);
+        CHECK(counts == std::vector<std::size_t>{19});
+    }
+
+    SECTION("group")
+    {
+        auto reg = matter::registry<matter::default_component_identifier<
+            matter::unsigned_id<std::size_t>,
+            chunked_component,
+            aligned_velocity>>{};
+
+        auto buffer =
+            reg.create_buffer_for<chunked_component, aligned_velocity>();
+        buffer.resize(3000, chunked_component{1}, aligned_velocity{1.f, 2.f});
+        reg.insert(buffer);
+
+        auto grp = reg.group_container().find_group(
+            reg.component_ids<chunked_component, aligned_velocity>());
+        REQUIRE(grp);
+
+        auto chunks = 0;
+        grp->for_each_chunk(
+            [&](std::size_t count, chunked_component* c, aligned_velocity* v) {
+                ++chunks;
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    v[i].x += static_cast<float>(c[i].i);
+                }
+            });
+        // chunked_component is stored 8 per chunk
+        CHECK(chunks == 375);
+
+        matter::for_each(matter::execution::unseq,
+                         *grp,
+                         [](chunked_component& c, aligned_velocity& v) {
+                             v.y += static_cast<float>(c.i);
+                         });
+
+        auto sum = 0.f;
+        matter::for_each(matter::execution::seq,
+                         *grp,
+                         [&](chunked_component&, aligned_velocity& v) {
+                             sum += v.x + v.y;
+                         });
+        CHECK(sum == 3000 * 5.f);
+    }
+}
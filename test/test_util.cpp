@@ -1,6 +1,16 @@
 #include <catch2/catch.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
 #include "matter/util/meta.hpp"
+#include "matter/util/task_graph.hpp"
+#include "matter/util/thread_pool.hpp"
 
 struct foo
 {
@@ -147,3 +157,146 @@ TEST_CASE("util")
         CHECK(l == 0);
     }
 }
+
+TEST_CASE("thread_pool")
+{
+    matter::thread_pool pool{3};
+    CHECK(pool.concurrency() == 4);
+
+    SECTION("parallel_for")
+    {
+        std::vector<int> visits(1000);
+        pool.parallel_for(visits.size(), [&](std::size_t i) { ++visits[i]; });
+
+        for (auto v : visits)
+        {
+            CHECK(v == 1);
+        }
+    }
+
+    SECTION("nested")
+    {
+        std::atomic<int> sum{0};
+        pool.parallel_for(8, [&](std::size_t) {
+            pool.parallel_for(8, [&](std::size_t j) {
+                sum += static_cast<int>(j);
+            });
+        });
+
+        CHECK(sum == 8 * 28);
+    }
+
+    SECTION("exception")
+    {
+        std::atomic<int> runs{0};
+        CHECK_THROWS_AS(pool.parallel_for(100,
+                                          [&](std::size_t i) {
+                                              ++runs;
+                                              if (i == 42)
+                                              {
+                                                  throw std::runtime_error{
+                                                      "task failed"};
+                                              }
+                                          }),
+                        std::runtime_error);
+        CHECK(runs == 100);
+    }
+
+    SECTION("ranges")
+    {
+        std::vector<int> visits(10000);
+        auto             policy = matter::execution::par.on(pool).grain(300);
+
+        std::atomic<int> ranges{0};
+        matter::parallel_for(
+            policy, visits.size(), [&](std::size_t first, std::size_t last) {
+                ++ranges;
+                for (; first < last; ++first)
+                {
+                    ++visits[first];
+                }
+            });
+
+        CHECK(ranges == 34);
+        for (auto v : visits)
+        {
+            CHECK(v == 1);
+        }
+    }
+}
+
+TEST_CASE("task_graph")
+{
+    matter::thread_pool pool{3};
+
+    // 0 -> 1 -> 3, 0 -> 2 -> 3 and 4 on its own
+    matter::task_graph graph{5};
+    graph.add_dependency(0, 1);
+    graph.add_dependency(0, 2);
+    graph.add_dependency(1, 3);
+    graph.add_dependency(2, 3);
+
+    CHECK(graph.size() == 5);
+    CHECK(graph.predecessors(3) == 2);
+    CHECK(graph.successors(0) == std::vector<std::size_t>{1, 2});
+
+    // run it like every frame, the order must hold each time
+    for (int frame = 0; frame < 100; ++frame)
+    {
+        std::atomic<int> clock{0};
+        std::vector<int> finished(5, -1);
+
+        graph.run(pool, [&](std::size_t task) { finished[task] = clock++; });
+
+        CHECK(finished[0] < finished[1]);
+        CHECK(finished[0] < finished[2]);
+        CHECK(finished[1] < finished[3]);
+        CHECK(finished[2] < finished[3]);
+        CHECK(finished[4] >= 0);
+    }
+
+    SECTION("nested parallel_for")
+    {
+        // only one task can run at a time, the idle workers help it instead
+        matter::task_graph chain{3};
+        chain.add_dependency(0, 1);
+        chain.add_dependency(1, 2);
+
+        std::mutex                             ids_mutex;
+        std::vector<std::set<std::thread::id>> ids(chain.size());
+        std::atomic<int>                       sum{0};
+
+        chain.run(pool, [&](std::size_t task) {
+            pool.parallel_for(32, [&](std::size_t i) {
+                {
+                    std::lock_guard<std::mutex> lock{ids_mutex};
+                    ids[task].insert(std::this_thread::get_id());
+                }
+
+                sum += static_cast<int>(i);
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            });
+        });
+
+        CHECK(sum == 3 * 496);
+        for (const auto& task_ids : ids)
+        {
+            CHECK(task_ids.size() > 1);
+        }
+    }
+
+    SECTION("exception")
+    {
+        std::atomic<int> runs{0};
+        CHECK_THROWS_AS(graph.run(pool,
+                                  [&](std::size_t task) {
+                                      ++runs;
+                                      if (task == 1)
+                                      {
+                                          throw std::runtime_error{"failed"};
+                                      }
+                                  }),
+                        std::runtime_error);
+        CHECK(runs == 5);
+    }
+}